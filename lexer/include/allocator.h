@@ -1,9 +1,10 @@
 #ifndef _H_ALLOCATE_
 #define _H_ALLOCATE_
   /*
-  .. A general pool that allocates memory with size in (0, 4088 Bytes].
-  .. Warning. There is no memory freeing (except at the end of pgm).
-  .. So repeated allocations may exhaust RAM.
+  .. A general pool that allocates memory with size in (0, PAGE_SIZE].
+  .. Larger objects are malloc'ed individually.
+  .. Warning. There is no memory freeing of the pool (except at the end
+  .. of pgm). So repeated allocations may exhaust RAM.
   */
 
   #include <stdlib.h>
@@ -17,14 +18,32 @@
 
   /* APIs
   .. (a) "destroy" all mem blocks. Call @ the end of pgm
-  .. (b) "allocate" memory. max 4088 Bytes. (Rounded to 8 bytes. Maybe unnecessary)
+  .. (b) "allocate" memory. (Rounded to 8 bytes. Maybe unnecessary)
+  ..     Size > PAGE_SIZE is a "large" object, not taken from the pool.
   .. (c) "allocate_str" : equivalent to strdup ()
   .. (d) "deallocate" a memory for reuse. size also should be passed correctly.
+  ..     (As of now, only the large objects are freed)
   .. (e) "reallocate" from an older size to a newer size. Copy old content also.
+  .. (f) "allocated" : bytes used from the pool so far, and by the large
+  ..     objects in use.
+  .. (g) "allocator_mark" : the current state of the pool, and
+  ..     "allocator_release" frees everything allocated after the mark
+  ..     (blocks of the pool and large objects). Objects allocated
+  ..     before the mark are kept. No other thread should allocate in
+  ..     between, and the mark is invalid after destroy ().
   */
+  typedef struct AllocMark {
+    void * block;
+    char * head;
+    size_t size, large;
+  } AllocMark;
+
   void   destroy ();
   void * allocate ( size_t size );
   char * allocate_str ( const char * s );
   void   deallocate ( void *, size_t );
   void * reallocate ( void *, size_t, size_t );
+  size_t allocated  ( );
+  AllocMark allocator_mark ( );
+  void   allocator_release ( AllocMark m );
 #endif
@@ -6,6 +6,17 @@
   void class_refine ( int * list, int n );
   void class_char   ( int c );
 
+  /*
+  .. The partition is saved and restored around the classes of an
+  .. other set of regex (ex : a regex compiled by rgx_match ()).
+  */
+  typedef struct ClassSave {
+    int class [256], next [256], head [256], nclass;
+  } ClassSave;
+
+  void class_save    ( ClassSave * s );
+  void class_restore ( const ClassSave * s );
+
   /*
   .. 4 equivalence classes are reserved for BOL (beginning of line) ,
   .. EOF (end of file), EOL (end of line) and EOB (end of buffer).
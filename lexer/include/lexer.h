@@ -8,8 +8,63 @@
   #define LXR_BUFFSIZE 256
   #endif
  
+  /*
+  .. Version of lxr. Part of the key for the cached tables
+  */
+  #define LXR_VERSION "1.0"
+
+  /*
+  .. Version of the layout of the binary table file
+  */
+  #define LXR_TABLES_VERSION 2
+
   int read_lex_input (const char *in, const char *out);
 
   void lxr_debug ();
 
+  /*
+  .. Cache the compressed tables in the directory. Tables are
+  .. reused if neither the patterns nor the macros are changed.
+  */
+  void lxr_cache (const char * dir);
+
+  /*
+  .. Maximum depth of the def[] (fallback) chain of the tables. Trades
+  .. the table size for the lookup speed. Refer rgx_table_depth ()
+  */
+  void lxr_depth (int depth);
+
+  /*
+  .. Search the heuristics of the table compression for the smallest
+  .. tables, using "nthreads" threads. Refer rgx_table_optimize ()
+  */
+  void lxr_optimize (int nthreads);
+
+  /*
+  .. Encoding of the transitions in the generated lexer.
+  .. LXRCOMB   : check[], next[], base[] and def[] tables.
+  .. LXRBITMAP : bitmap of the live classes of each state, and a
+  ..             dense array of the targets (nclass <= 64 only).
+  .. LXRAUTO   : (default) the encoding with the lowest estimated cost
+  ..             per transition, or the fastest on the sample input
+  ..             set by lxr_sample () if any. A report is printed.
+  */
+  enum LXRBACKEND { LXRCOMB, LXRBITMAP, LXRAUTO };
+  void lxr_backend (int backend);
+  void lxr_sample (const char * file);
+
+  /*
+  .. 2 : the states of long tokens consume two bytes per lookup, from
+  .. tables keyed on pairs of classes. Refer dfa_pairs (). 1 : default
+  */
+  void lxr_stride (int n);
+
+  /*
+  .. Write the tables to a binary "file" (aligned, mmap-able), instead
+  .. of the lexer source. The generated lexer maps it at run time, so
+  .. the tables can be changed without recompiling the lexer, as long
+  .. as the tokens and the layout are the same. Refer src/lxr/tables.c
+  */
+  void lxr_table_file (const char * file);
+
 #endif
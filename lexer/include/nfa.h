@@ -9,19 +9,55 @@
   #include "regex.h"
   #include "allocator.h"
   #include "stack.h"
+  #include "bits.h"
 
   enum {
     NFAEPS  = 256,  /* Epsilon/Empty transition */
     NFAACC  = 257,  /* Accepting state */
+    NFASET  = 258,  /* Transition by any class of a class-set label */
+    NFATAG  = 259,  /* ε-transition, that records a tag of a group */
     NFAERR  = -2,   /* Unknown alphabet outside [0, 256) */
   };
 
+  /*
+  .. A character class like [a-zA-Z_] is a single state labelled by
+  .. the set of equivalence classes (a bitset) it accepts, instead of
+  .. an ε-state with one state per class.
+  .. (a) LABELLED (s, c) : state "s" has a transition by class "c".
+  .. (b) label_set () : label of the classes i with classes[i] == cmp
+  ..      Returns the class if it's the only one, else NFASET with the
+  ..      bitset in *set. NFAERR for an empty class [].
+  .. (c) labels_next () : iterate the labels of a list of states, from
+  ..      the last state to the first, and the classes of a class-set
+  ..      in the decreasing order. Returns -1 at the end of the list.
+  */
+  typedef struct SetState {
+    State s;
+    uint64_t * set;
+  } SetState;
+
+  typedef struct Labels {
+    State ** s;
+    int n, c;
+  } Labels;
+
+  #define STATE_SET(_s_)   ( ((SetState *) (_s_))->set )
+  #define LABELLED(_s_,_c_)  ( (_s_)->id == (_c_) ||                 \
+    ( (_s_)->id == NFASET && BITLOOKUP (STATE_SET (_s_), _c_) ) )
+
+  int  label_set         ( int * classes, int cmp, uint64_t ** set );
+  int  labels_next       ( Labels * t );
+
   int  states_add        ( State * start, Stack * list, State *** buff );
   int  states_at_start   ( State * nfa,   Stack * list, State *** buff );
   int  states_transition ( Stack * from,  Stack * to,   State *** buff, int c );
+  int  states_transition_r ( Stack * from, Stack * to, State *** buff, int c,
+                             Stack * seen );
   int  states_bstack     ( Stack * list,  Stack * bits );
   int  state_token       ( State * f );
+  int  state_tag         ( State * t );
   void nfa_reset         ( char ** rgx, int nrgx );
+  void nfa_classes       ( );
 
   #define RGXMATCH(_s_) (_s_)->flag
 
@@ -0,0 +1,41 @@
+#ifndef _RGX_POSITION_H_
+#define _RGX_POSITION_H_
+
+  #include "regex.h"
+  #include "stack.h"
+
+  /*
+  .. Position automaton (Glushkov/followpos) of a regex, which is an
+  .. alternative to the Thompson NFA of nfa.c. Each position is a
+  .. State with
+  ..   id  : the equivalence class consumed (or NFAACC),
+  ..   out : NULL terminated list of followpos.
+  .. There are no ε-states, except a root for each regex, which holds
+  .. the firstpos in it's "out" list.
+  .. (a) positions_reset () : reset the counter of positions.
+  .. (b) rgx_positions () : same as rgx_nfa (), but creates positions.
+  .. (c) positions_at_start (), positions_transition_r () : the
+  ..      equivalent of states_at_start (), states_transition_r ()
+  .. (d) positions_bits () : the bit-parallel program of the positions
+  ..      of "rgx" (refer position.c). Returns 1 if there are more
+  ..      than RGXBITS positions, < 0 on error.
+  .. (e) positions_bits_match () : same as rgx_nfa_match ().
+  */
+  #define RGXBITS 64                 /* bits of a set (uint64_t) */
+
+  typedef struct RgxBits {
+    uint32_t size, nchunks;          /* tables follow [0, nchunks) */
+    uint64_t start, final;
+    uint64_t mask [256];           /* positions labelled by a byte */
+    uint64_t follow [][256];
+  } RgxBits;
+
+  void positions_reset        ( );
+  int  rgx_positions          ( char * rgx, State ** root, int itoken );
+  int  positions_at_start     ( State * root, Stack * list, State *** buff );
+  int  positions_transition_r ( Stack * from, Stack * to, State *** buff,
+                                int c, Stack * seen );
+  int  positions_bits         ( char * rgx, RgxBits ** prog );
+  int  positions_bits_match   ( const RgxBits * p, const char * txt );
+
+#endif
@@ -1,5 +1,6 @@
 #ifndef _RGX_H_
 #define _RGX_H_
+  #include <stddef.h>
   #include "stack.h"
   /*
   .. Warning !!!
@@ -23,6 +24,101 @@
   } State ;  
   typedef struct DState DState;
 
+  /*
+  .. A compiled regex (refer rgx_compile ()) is a single contiguous
+  .. block of "size" bytes, without pointers. So it can be copied,
+  .. written to a file or mapped, and freed with free (). The header
+  .. is followed (at the offset "next") by the transitions
+  ..   next [nstates x nclass]  : uint16_t, or uint32_t if "wide"
+  .. A state is identified by its row, state x nclass. Row 0 is the
+  .. dead state, and rows from "accept" are the accepting states.
+  .. A match from buf [0] (after a BOL) starts at the row "start", and
+  .. a match from a later byte at "inner" (refer rgx_search ()).
+  .. "search" and "reverse" are the offsets of the programs used by
+  .. rgx_search () in the same block (0 if none). Every match starts
+  .. with the byte "lead" (if >= 0), and has the bytes req [0, nreq).
+  .. If "token" > 0, it is the offset of the token (uint32_t) of each
+  .. state.
+  */
+  #ifndef RGXREQ
+    #define RGXREQ 4
+  #endif
+  typedef struct RgxProg {
+    uint32_t size, nstates, nclass, wide, next, accept, start, inner,
+      search, reverse, nreq, token;
+    int32_t  lead;
+    uint8_t  req [RGXREQ], class [256];
+  } RgxProg;
+
+  /*
+  .. A compiled set of patterns (refer rgx_set_compile ()), also a
+  .. single block. The "nsets" distinct accept sets, bitmasks of
+  .. "nwords" words (bit i for the pattern i), are at the offset
+  .. "sets", and the program of the dfa at "prog". The token of an
+  .. accepting state is 1 + the index of its accept set.
+  */
+  typedef struct RgxSet {
+    uint32_t size, npatterns, nwords, nsets, sets, prog;
+  } RgxSet;
+
+  /*
+  .. A lazy dfa (refer rgx_lazy_compile ()) holds the nfa of a regex,
+  .. and the dfa states created so far, in a fixed memory budget.
+  */
+  typedef struct RgxLazy RgxLazy;
+
+  /*
+  .. A compiled regex with groups (refer rgx_capture_compile ()), also
+  .. a single block : a tagged dfa. At the offset "next" are the
+  .. transitions next [nstates x nclass] (uint32_t, the row of the
+  .. target, 0 : the dead state), and at "ops", for each transition,
+  .. the offset in code [] of its operations (0 : none). code [] is
+  .. int32_t (at "code"), a list of operations is n, dst, src, dst,
+  .. src .. : reg [dst] = reg [src], or the position if src < 0. Rows
+  .. from "accept" are the accepting states, and final [state] (int32_t,
+  .. at "final") is the offset in code [] of the registers of the groups
+  .. of the match (ngroups, then the start and the end of each group).
+  .. The lists begin [] run before the first byte. There are "nregs"
+  .. registers.
+  */
+  typedef struct RgxCapture {
+    uint32_t size, ngroups, nregs, nstates, nclass, start, accept,
+      next, ops, final, code, begin [2];
+    uint8_t  class [256];
+  } RgxCapture;
+
+  /*
+  .. A match of a RgxProg over input fed in chunks (refer
+  .. rgx_stream_init ()) : the row of the current state (0 : dead),
+  .. the number of bytes fed, and the length of the longest match so
+  .. far (-1 : none).
+  */
+  typedef struct RgxStream {
+    const RgxProg * prog;
+    uint32_t state;
+    size_t   pos;
+    long     end;
+  } RgxStream;
+
+  /*
+  .. Threads
+  .. RgxProg, RgxSet, RgxCapture and RgxLazy own their classes and
+  .. tables, and any number of them can coexist. A RgxProg, a RgxSet or
+  .. a RgxCapture isn't modified by a match, so rgx_exec (),
+  .. rgx_search (), rgx_set_match () and rgx_capture_match () can run
+  .. on it from many threads at once (as can many RgxStream of it,
+  .. each fed by one thread at a time). A RgxLazy creates states while
+  .. matching, so it's used by one thread at a time (one per thread).
+  .. rgx_match () keeps a cache per thread. The compilers
+  .. (rgx_compile (), rgx_set_compile (), rgx_capture_compile (),
+  .. rgx_lazy_compile () and rgx_match () of a new regex) may be
+  .. called from many threads, but run one at a time, as the dfa,
+  .. nfa and classes being built are shared. The other functions
+  .. (rgx_dfa (), rgx_lexer_dfa (), dfa_tables () ..) use the latest
+  .. dfa, and aren't thread safe. rgx_free () frees the memory pool
+  .. (and the nfa of the lazy dfa) of all threads.
+  */
+
   /*
   .. API
   .. (a) int rgx_match ( const char * rgx, const char * txt ) :
@@ -31,6 +127,11 @@
   ..      The number of characters matched = val - 1.
   ..      If val = 0, then "txt" doesn't follow "rgx" pattern,
   ..      and val < 0 refers to some error.
+  ..      The program of "rgx" is cached (for the RGXCACHE latest
+  ..      regex of the thread), so repeated calls only run the match.
+  ..      A regex of at most 64 positions (characters and groups) is
+  ..      simulated bit parallel, and the others by the program of
+  ..      the dfa.
   .. (b) int rgx_dfa ( const char * rgx, DState ** dfa );
   ..      For repeated match lookup of a regex "rgx", this function will
   ..      evaluate minimised DFA in dfa[0].
@@ -38,8 +139,115 @@
   .. (c) int rgx_dfa_match ( DState * dfa, const char * txt);
   ..      Similar to "rgx_match", but uses minimal "dfa" for "rxg"
   .. (d) int rgx_free ();
-  ..      Free allocated memory blocks.
+  ..      Free allocated memory blocks (and the cache of rgx_match).
   .. (e) flush all reported error (if any) to stderr.
+  .. (f) void rgx_dfa_threads ( int n );
+  ..      Use "n" threads for the subset construction (NFA to DFA).
+  ..      Default is 1. The tables are the same for any "n".
+  .. (g) void rgx_dfa_positions ( int on );
+  ..      If "on", dfa is created directly from the positions (i.e
+  ..      followpos) of the regex instead of the Thompson NFA.
+  ..      The minimised DFA is the same either way.
+  .. (h) void rgx_table_depth ( int depth );
+  ..      Maximum length of the def[] (fallback) chain in the tables
+  ..      created by dfa_tables (). 0 : no fallback (fastest lookup),
+  ..      1 : default, >1 : longer chains and template rows indexed by
+  ..      meta classes (smallest tables).
+  .. (i) int dfa_bitmap ( int ** tables, int * len, int depth,
+  ..        uint64_t ** bmap, int ** offset, int ** target );
+  ..      Bitmap (popcount) encoding of the transitions of the tables
+  ..      created by dfa_tables () with def[] chain length "depth".
+  ..      Only for <= 64 classes. Returns the size of target[].
+  .. (j) int table_delta ( int ** tables, int * len, int depth,
+  ..        int s, int c, int * hops );
+  ..      Transition from state "s" by class "c" using the tables of
+  ..      dfa_tables (), and the number of def[] fallbacks taken.
+  .. (k) void rgx_table_optimize ( int nthreads );
+  ..      If nthreads > 0, dfa_tables () tries many heuristics of the
+  ..      table compression on "nthreads" threads and keeps the
+  ..      smallest check[]/next[]. 0 (default) : default heuristics.
+  .. (l) int dfa_pairs ( int ** tables, int * len, int depth,
+  ..        int ** pclass, int ** pidx, int ** pair, int * npclass );
+  ..      Two byte stride tables for the states of long tokens, keyed
+  ..      on pairs of classes. Returns the number of such states.
+  .. (m) void rgx_dfa_prune ( int on );
+  ..      If "on" (default), the states that can never lead to an
+  ..      accepting state, or that are never reached by the scanner,
+  ..      are removed before the minimisation.
+  .. (n) int dfa_eol_accept ( int ** tables, int * len, int depth,
+  ..        int ** eolaccept );
+  ..      Token accepted by each state of the tables, if followed by
+  ..      an end of line. Returns the size of eolaccept[].
+  .. (o) int rgx_compile ( char * rgx, RgxProg ** prog );
+  ..      Compile the minimal dfa of "rgx" into a flat program (see
+  ..      RgxProg). The program starts after a BOL, i.e a '^' matches
+  ..      at buf [0]. '$' isn't supported, and is an error (as is a
+  ..      "rgx" whose dfa can't be created). Return value < 0 means an
+  ..      error.
+  .. (p) int rgx_exec ( const RgxProg * prog, const char * buf,
+  ..        size_t len );
+  ..      Similar to "rgx_dfa_match", but runs "prog" on the "len" bytes
+  ..      of "buf", which may contain NUL (binary data).
+  .. (q) int rgx_search ( const RgxProg * prog, const char * buf,
+  ..        size_t len, size_t * start, size_t * end );
+  ..      Leftmost longest match of "prog" anywhere in buf [0, len),
+  ..      i.e buf [*start, *end). Returns 1 if found, 0 if not. A '^'
+  ..      matches only at buf [0].
+  .. (r) int rgx_set_compile ( char ** rgx, int n, RgxSet ** set );
+  ..      Compile the "n" patterns rgx [0, n) into a single dfa, whose
+  ..      states know the set of patterns they accept. As in
+  ..      rgx_compile (), a '^' matches at buf [0], and '$' is an error.
+  .. (s) int rgx_set_match ( const RgxSet * set, const char * buf,
+  ..        size_t len, uint64_t * ids );
+  ..      Sets the bit i of "ids" (set->nwords words) for each pattern
+  ..      i that matches buf [0, len) or a starting part of it (as in
+  ..      rgx_match ()), in one pass. Returns the number of patterns.
+  .. (t) void rgx_match_bits ( int on );
+  ..      If "on" (default), rgx_match () uses the bit-parallel
+  ..      simulation for the small regex. Else always the dfa. Applies
+  ..      to the regex not yet in the cache.
+  .. (u) int rgx_lazy_compile ( char * rgx, size_t budget,
+  ..        RgxLazy ** lazy );
+  ..      Create the nfa of "rgx". The dfa states are created by
+  ..      rgx_lazy_match (), when the input reaches them, in "budget"
+  ..      bytes (RGXLAZY if 0). Once full, all the states are dropped.
+  ..      The nfa is in the memory pool, so "lazy" can't be used after
+  ..      rgx_free (). Return value < 0 means an error.
+  .. (v) int rgx_lazy_match ( RgxLazy * lazy, const char * buf,
+  ..        size_t len );
+  ..      Same as rgx_exec () (matches a starting part of buf [0, len),
+  ..      after a BOL, as rgx_match ()).
+  .. (w) void rgx_lazy_stats ( const RgxLazy * lazy, int * nstates,
+  ..        int * nflush );
+  ..      Number of dfa states in the budget, and of flushes so far.
+  .. (x) void rgx_lazy_free ( RgxLazy * lazy );
+  .. (y) int rgx_capture_compile ( char * rgx, RgxCapture ** cap );
+  ..      Compile "rgx" and its groups (x), numbered 1, 2 .. in the
+  ..      order of their '(' (at most RGXGROUPS), into a tagged dfa
+  ..      (see RgxCapture). Return value < 0 means an error.
+  .. (z) int rgx_capture_match ( const RgxCapture * cap,
+  ..        const char * buf, size_t len, long * sub );
+  ..      Same as rgx_exec () (a '^' matches at buf [0]). The group
+  ..      k of the match is buf [sub [2k], sub [2k+1]) (both -1, if
+  ..      the group isn't a part of the match), where the group 0 is
+  ..      the match. sub [] has 2 x (cap->ngroups + 1) entries. Of the
+  ..      ways to match, the groups are those of the first in the
+  ..      order of a backtracking matcher (alternatives from the left,
+  ..      greedy quantifiers), and a group in a loop is its last
+  ..      iteration. A single pass over buf [].
+  .. (aa) void rgx_stream_init ( RgxStream * st, const RgxProg * prog );
+  ..      Start a match of "prog" (as rgx_exec ()) over the input fed
+  ..      by rgx_stream_feed (). A '^' matches at the first byte fed.
+  ..      "st" is owned by the caller, and holds no memory.
+  .. (ab) int rgx_stream_feed ( RgxStream * st, const char * buf,
+  ..        size_t len );
+  ..      Continue the match with the next "len" bytes of the input,
+  ..      e.g the data of each read () of a pipe or a socket. Returns
+  ..      1 if more input may extend the match, and 0 if the match is
+  ..      over (the bytes fed after are ignored).
+  .. (ac) long rgx_stream_match ( const RgxStream * st );
+  ..      Same as the value of rgx_exec () over all the input fed so
+  ..      far : the length of the longest match + 1, or 0 if none.
   */
   int  rgx_match     ( /*const*/ char * rgx, const char * txt );
   int  rgx_dfa       ( /*const*/ char * rgx, DState ** dfa );
@@ -47,6 +255,36 @@
   void rgx_free      ( );
   void errors        ( );
   int  dfa_tables    ( int ***, int ** );
+  void rgx_dfa_threads ( int n );
+  void rgx_dfa_positions ( int on );
+  void rgx_table_depth ( int depth );
+  int  dfa_bitmap    ( int **, int *, int, uint64_t **, int **, int ** );
+  int  table_delta   ( int **, int *, int, int, int, int * );
+  void rgx_table_optimize ( int nthreads );
+  int  dfa_pairs     ( int **, int *, int, int **, int **, int **,
+    int * );
+  void rgx_dfa_prune ( int on );
+  int  dfa_eol_accept ( int **, int *, int, int ** );
+  int  rgx_compile   ( char * rgx, RgxProg ** prog );
+  int  rgx_exec      ( const RgxProg * prog, const char * buf,
+    size_t len );
+  int  rgx_search    ( const RgxProg * prog, const char * buf,
+    size_t len, size_t * start, size_t * end );
+  int  rgx_set_compile ( char ** rgx, int n, RgxSet ** set );
+  int  rgx_set_match ( const RgxSet * set, const char * buf,
+    size_t len, uint64_t * ids );
+  void rgx_match_bits ( int on );
+  int  rgx_lazy_compile ( char * rgx, size_t budget, RgxLazy ** lazy );
+  int  rgx_lazy_match ( RgxLazy * lazy, const char * buf, size_t len );
+  void rgx_lazy_stats ( const RgxLazy * lazy, int * nstates,
+    int * nflush );
+  void rgx_lazy_free ( RgxLazy * lazy );
+  int  rgx_capture_compile ( char * rgx, RgxCapture ** cap );
+  int  rgx_capture_match ( const RgxCapture * cap, const char * buf,
+    size_t len, long * sub );
+  void rgx_stream_init ( RgxStream * st, const RgxProg * prog );
+  int  rgx_stream_feed ( RgxStream * st, const char * buf, size_t len );
+  long rgx_stream_match ( const RgxStream * st );
 
   /*
   .. Lower level or internal api. Maybe used for debug
@@ -81,11 +319,53 @@
     #define RGXSIZE 256
   #endif
 
+  /*
+  .. Cap on the bounds m, n of the counted repetition x{m,n}. Each
+  .. count needs a copy of x in the NFA and (mostly) a dfa state.
+  */
+  #ifndef RGXREPMAX
+    #define RGXREPMAX 10000
+  #endif
+
+  /*
+  .. Number of regex, whose programs are cached by rgx_match ()
+  */
+  #ifndef RGXCACHE
+    #define RGXCACHE 64
+  #endif
+
+  /*
+  .. Default memory budget (bytes) of the states of a lazy dfa
+  */
+  #ifndef RGXLAZY
+    #define RGXLAZY (1 << 20)
+  #endif
+
+  /*
+  .. Maximum number of groups of rgx_capture_compile (), as the tags
+  .. (2 per group) passed by a closure are a bitmask of 64 bits.
+  */
+  #define RGXGROUPS 32
+
   #define   RGXOP(_c_)     ((_c_) | 256)
   #define ISRGXOP(_c_)     ((_c_) & 256)
 
-  /* Lower level/Internal funtions. Maybe used for debug */
-  int rgx_rpn       ( char * rgx, int * rpn );
-  int rgx_rpn_print ( int * rpn );
+  /*
+  .. Lower level/Internal funtions. Maybe used for debug.
+  .. rgx_rpn_reverse (1) : rgx_rpn () creates the rpn of the reversed
+  .. strings (used for the reverse dfa of rgx_search ()).
+  .. rgx_rpn_groups (1) : rgx_rpn () keeps the groups (x), numbered
+  .. 1, 2 .. in the order of their '(', as the unary operation
+  .. x ( k ) (used by rgx_capture_compile ()). The nfa of the group
+  .. k is enclosed by ε-states of the tags 2k-2 and 2k-1 (NFATAG).
+  .. rgx_cache_free () : free the programs cached by rgx_match () in
+  .. the calling thread (those of the other threads are freed, when
+  .. the thread exits).
+  */
+  int  rgx_rpn       ( char * rgx, int * rpn );
+  int  rgx_rpn_print ( int * rpn );
+  void rgx_rpn_reverse ( int on );
+  void rgx_rpn_groups  ( int on );
+  void rgx_cache_free  ( );
 
 #endif
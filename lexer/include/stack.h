@@ -6,18 +6,10 @@
   .. Can use stack to store pointers
   .. (or other dtypes with size <= sizeof (void *), if typecasted)
   .. Ex : stack of States for NFA Cache. Use stack_push()
-  .. Can use stack as an array of bits. ibit in [0, 8*8*16 = 1024)
-  .. Ex : set of DFA states. Use stack_bit() to set a bit as 1
+  .. Can use stack as an array of bits. ibit in [0, 8*max)
+  .. Ex : set of NFA states. Use stack_bit() to set a bit as 1
   */
 
-  /*
-  .. Let's define a hard limit for DFA size
-  .. But expect ~100.
-  .. Need stronger / optimised  algorithm to
-  .. handle large bit stacks
-  */
-  #define RGXLIM 1024
-
   typedef struct Stack {
     char * stack;
     int len, max,      /* used array byte size, max array byte size. */
@@ -0,0 +1,1245 @@
+
+# line 23 "languages/c99/c99.lex"
+
+#include "tokens.h"
+static int column = 1, line = 1;
+char * file;
+
+//  #define  LXR_BUFF_SIZE 128
+ 
+
+# line 12 "languages/c99/c99.c"
+
+/*
+.. Equivalence classes for alphabets in [0x00, 0xFF] are
+.. stored in the table lxr_class []. The number of equivalence
+.. classes also counts the special equivalence classes like
+.. that of EOB/EOL/EOF/BOL. However BOL transition is never
+.. used, as the state 2 is reserved for the starting DFA in
+.. case of BOL status. lxr_eol_class will be set to 0 in case
+.. no patterns are found with EOL requirement.
+*/
+#define lxr_nclass        60          /* num of eq classes */
+#define lxr_nel_class      4          /* new line  '\n'    */
+#define lxr_eob_class     56          /* end of buffer     */
+#define lxr_eol_class      0          /* end of line       */
+#define lxr_eof_class     58          /* end of file       */
+#define lxr_eol_used       0          /* EOL anchor used   */
+
+/*
+.. States [1, 46] are reserved for tokens listed in the lex 
+.. source file. In addition, the following two accept states
+.. are used internally for EOF/EOB
+*/
+#define lxr_eof_accept    47          /* end of file       */
+#define lxr_eob_accept    48          /* end of buffer     */
+
+/*
+.. A transition not found in the row of a state falls back to
+.. lxr_def [state], atmost lxr_max_depth times. States starting
+.. from lxr_template are template rows, which are indexed by the
+.. meta class lxr_meta [class] instead of the class.
+*/
+#define lxr_max_depth      1          /* def[] chain depth */
+#define lxr_template     148          /* first template    */
+#define lxr_ntemplates     0          /* num of templates  */
+
+/*
+.. If lxr_bitmap, transitions are encoded as a bitmap of the live
+.. classes, lxr_bmap [state], and the targets of the live classes
+.. starting from lxr_target [lxr_boff [state]].
+*/
+#define lxr_bitmap         0          /* bitmap backend    */
+
+/*
+.. If lxr_npair, the states of long tokens (lxr_pidx [state] != 0)
+.. read two bytes per lookup from the lxr_pair [] table, keyed on
+.. the pair classes lxr_pclass [] of the two bytes.
+*/
+#define lxr_npair          0          /* two byte stride   */
+#define lxr_npclass        0          /* num of pair class */
+
+static short lxr_check [853] = {
+    2,
+
+    2,    2,    2,    2,    2,    2,    2,    2,    2,    2,
+    2,    2,    2,    2,    2,    2,    2,    2,    2,    2,
+    2,    2,    2,    2,    2,    2,    2,    2,    2,    2,
+    2,    2,    2,    2,    2,    2,    2,    2,    2,    2,
+    2,    2,    2,    2,    2,    2,    2,    2,    2,    2,
+    2,    2,    2,    2,    2,    2,    1,    2,  143,   46,
+   11,  125,   82,  135,  124,   40,   52,  101,   88,  103,
+   73,   54,  136,   74,   49,   70,    1,   91,   12,   47,
+   47,  132,  126,    8,   98,   75,  137,   70,  121,   91,
+   93,   93,  126,  132,   12,   75,  137,   86,   98,   72,
+
+  121,  122,    8,  134,   71,   86,  145,  144,   72,   80,
+  145,  133,  134,   80,  145,  123,  112,   57,   80,   28,
+  122,  112,   57,   71,  123,   53,   99,  113,  112,   57,
+  133,  144,  144,   37,   37,   53,  118,   53,   53,   61,
+  146,  118,   67,  113,   61,  112,   57,   67,  118,   25,
+  108,   61,   36,   25,   67,  108,  115,   25,   83,   36,
+  146,   58,  108,   83,  119,  118,   29,   62,   61,   29,
+   83,   67,   25,  113,   68,  100,  100,   58,  109,  108,
+  119,  100,   99,   62,  111,   83,  114,   83,  100,   13,
+   68,   35,   27,   13,  109,   33,  146,   13,   35,   33,
+
+  115,   56,   10,   13,  130,  100,   34,   58,  130,  130,
+  119,   19,   34,   62,    0,    0,  130,  111,  111,  117,
+   68,   32,   60,   32,  109,   66,   13,   13,  111,    0,
+  114,  130,   17,  130,   56,   56,   31,  111,   64,   13,
+  107,    0,   64,   64,   31,   56,    0,    0,  130,  138,
+   64,    0,  117,  117,   56,   60,   60,   30,   66,   66,
+   17,  138,    0,  117,   30,   43,   60,   64,   43,   66,
+    0,    0,  117,  107,  107,   60,   63,    0,   66,    0,
+   63,   63,   64,    0,  107,  138,  138,   20,   63,   20,
+    0,   20,   20,  107,   23,  138,   43,   23,  138,   20,
+
+    0,    0,   20,    0,  138,   63,   15,   76,   15,    0,
+   15,   15,   76,   23,    0,    0,   20,    0,   15,   76,
+   63,   15,   20,    0,   26,   23,    0,    0,   26,   20,
+   20,   20,   26,    0,    0,   15,   76,    0,    0,    0,
+    0,   15,    0,   76,   76,    0,    0,   26,   15,   15,
+   15,    0,    0,   76,    0,  128,   76,  128,    0,  128,
+  128,    0,   76,    0,    0,    0,   26,  128,    0,    0,
+  128,   96,    0,   96,    0,   96,   96,    0,    0,    0,
+    0,    0,    0,   96,  128,    0,   96,    0,    0,  129,
+  128,  129,    0,  129,  129,    0,    0,  128,  128,  128,
+
+   96,  129,    0,    0,  129,    0,   96,    0,    0,    0,
+    0,    0,    0,   96,   96,   96,  129,    0,  129,    0,
+    0,    0,    0,    0,  129,    0,    0,    0,   21,   21,
+   21,  129,  129,  129,   21,    0,    0,    0,   21,    0,
+   21,   21,   21,   16,   16,   16,    0,    0,    0,   16,
+    0,    0,    0,   16,    0,   16,   16,   16,  139,  139,
+    0,    0,  139,    0,    0,    0,    0,    0,    0,    0,
+   21,   21,    0,    0,    0,   21,   21,    0,   21,    0,
+    0,  139,    0,  139,    0,   16,   16,  127,    0,    0,
+   16,   16,    0,   16,    0,   97,   97,   97,  139,    0,
+
+    0,   97,    0,  127,  139,   97,    0,   97,   97,   97,
+    0,    0,  127,  127,    0,   38,    0,   38,    0,   38,
+   38,   38,  127,   38,    0,  127,   38,   38,    0,    0,
+   38,  127,   38,    0,    0,    0,    0,   97,   97,    0,
+    0,    0,   97,   97,   38,   97,    0,    0,    0,    0,
+   38,   38,   38,    0,    0,    0,   38,   38,   38,   38,
+   38,   38,   38,   38,   38,   38,  140,  140,  140,  140,
+   38,  140,  140,  140,  140,  140,  140,    0,  140,  140,
+  140,  140,  140,  140,  140,  140,  140,  140,  140,  140,
+  140,  140,  140,  140,  140,  140,  140,  140,  140,  140,
+
+  140,  140,  140,  140,  140,  140,  140,  140,  140,  140,
+  140,  140,  140,  140,  140,  140,  140,  140,  140,  140,
+  140,  140,  140,  105,  105,  105,  105,    0,  105,  105,
+  105,  105,  105,  105,  105,  105,  105,  105,  105,  105,
+  105,  105,  105,  105,  105,  105,  105,  105,  105,  105,
+  105,  105,  105,  105,  105,  105,  105,  105,  105,  105,
+  105,  105,  105,  105,  105,  105,  105,  105,  105,  105,
+  105,  105,  105,  105,  105,  105,  105,  105,  105,  105,
+   78,   78,   78,   78,    0,   78,   78,   78,   78,   78,
+   78,   78,   78,   78,   78,   78,   78,   78,   78,   78,
+
+   78,   78,   78,   78,   78,   78,   78,   78,   78,   78,
+   78,   78,   78,   78,   78,   78,   78,   78,   78,   78,
+   78,   78,   78,   78,   78,   78,   78,   78,   78,   78,
+   78,   78,   78,   78,   78,   78,   95,   95,   95,   95,
+    0,   95,   95,   95,   95,   95,   95,   95,   95,   95,
+   95,   95,   95,   95,   95,   95,   95,   95,   95,   95,
+   95,   95,   95,   95,   95,   95,   95,   95,   95,   95,
+   95,   95,   95,   95,   95,   95,   95,   95,   95,   95,
+   95,   95,   95,   95,   95,   95,   95,   95,   95,   95,
+   95,   95,   94,   94,   94,   94,    0,   94,   94,   94,
+
+   94,   94,   94,   94,   94,   94,    0,   94,   94,   94,
+   94,   94,   94,   94,   94,   94,   94,   94,   94,   94,
+   94,   94,   94,   94,   94,   94,   94,   94,   94,   94,
+   94,   94,   94,   94,   94,   94,   94,   94,   94,   94,
+   94,   94,   94,   94,   94,   94,   94,   94,   94,    0,
+    0,    0
+};
+
+static short lxr_next [853] = {
+  146,
+
+   76,  104,   10,  145,   10,   76,   10,  145,   10,  144,
+  140,   10,  139,  105,    4,   10,  104,   10,  103,  101,
+   93,   91,    4,    4,   88,   86,    4,   83,   80,   76,
+   54,    4,   53,   49,   47,   10,   43,   43,   42,   41,
+   40,   38,   10,   10,   10,   10,   10,   10,   10,   23,
+   10,    9,    8,    5,    4,  147,  145,    3,  147,   45,
+   14,  120,   81,  131,  120,   39,   51,  100,   87,  102,
+   69,   41,  131,   69,   48,   69,  104,   89,   14,   44,
+   46,  131,  124,    7,   98,   73,  135,   69,  120,   90,
+   92,    5,  125,  131,   11,   74,  136,   84,   95,   70,
+
+  120,  121,    6,  132,   70,   85,  145,  142,  147,   79,
+  145,  132,  147,   78,  145,  121,  111,   56,   77,   27,
+  147,  111,   56,  147,  147,    9,   98,  112,  111,   56,
+  147,  143,  141,   10,   36,   42,  117,   52,   50,   60,
+  146,  117,   66,  112,   60,  111,   56,   66,  117,   25,
+  107,   60,   10,   25,   66,  107,  109,   25,   63,   35,
+  101,   57,  107,   63,  118,  117,   10,   61,   60,   28,
+   63,   66,   24,  147,   67,  100,   99,   57,  108,  107,
+  118,   99,  147,   61,  110,   82,  113,   63,   99,   13,
+   67,   10,   26,   13,  108,   10,  147,   13,   34,   32,
+
+  147,   55,   10,   14,  130,   99,   10,  147,   68,  130,
+  147,   18,   33,  147,    0,    0,  130,  110,  110,  116,
+  147,   10,   59,   31,  147,   65,   11,   11,  110,    0,
+  147,   64,   14,  130,   55,   55,   10,  147,   63,   12,
+  106,    0,   58,   63,   30,   55,    0,    0,   68,  138,
+   63,    0,  116,  116,  147,   59,   59,   10,   65,   65,
+   10,  138,    0,  116,   29,   22,   59,   63,   14,   65,
+    0,    0,  147,  106,  106,  147,   63,    0,  147,    0,
+   62,   63,   58,    0,  106,  133,  137,   19,   63,   19,
+    0,   19,   19,  147,   22,  134,   10,   14,  137,   19,
+
+    0,    0,   19,    0,  147,   63,   14,   76,   14,    0,
+   14,   14,   76,   17,    0,    0,   19,    0,   14,   76,
+   62,   14,   19,    0,   25,   10,    0,    0,   25,   19,
+   19,   19,   25,    0,    0,   14,   76,    0,    0,    0,
+    0,   14,    0,   71,   75,    0,    0,   24,   14,   14,
+   14,    0,    0,   72,    0,  114,   75,  114,    0,  114,
+  114,    0,  147,    0,    0,    0,   10,  114,    0,    0,
+  114,   95,    0,   95,    0,   95,   95,    0,    0,    0,
+    0,    0,    0,   95,  114,    0,   95,    0,    0,  127,
+  114,  127,    0,  127,  127,    0,    0,  114,  114,  114,
+
+   95,  127,    0,    0,  127,    0,   95,    0,    0,    0,
+    0,    0,    0,   95,   95,   95,  128,    0,  127,    0,
+    0,    0,    0,    0,  127,    0,    0,    0,   19,   19,
+   19,  127,  127,  127,   19,    0,    0,    0,   19,    0,
+   19,   19,   19,   14,   14,   14,    0,    0,    0,   14,
+    0,    0,    0,   14,    0,   14,   14,   14,   68,  130,
+    0,    0,  129,    0,    0,    0,    0,    0,    0,    0,
+   19,   19,    0,    0,    0,   19,   19,    0,   20,    0,
+    0,   64,    0,  130,    0,   14,   14,  119,    0,    0,
+   14,   14,    0,   15,    0,   95,   95,   95,   68,    0,
+
+    0,   95,    0,  115,  129,   95,    0,   95,   95,   95,
+    0,    0,  122,  126,    0,   10,    0,   10,    0,   10,
+   10,   10,  123,   10,    0,  126,   10,   10,    0,    0,
+   10,  147,   10,    0,    0,    0,    0,   95,   95,    0,
+    0,    0,   95,   95,   10,   96,    0,    0,    0,    0,
+   10,   10,   10,    0,    0,    0,   37,   10,   10,   10,
+   10,   10,   10,   10,   10,   10,   19,   19,   21,   19,
+  147,   19,   19,   19,   19,   19,   19,    0,   19,   19,
+   19,   19,   19,   19,   19,   19,   19,   19,   19,   19,
+   19,   19,   19,   19,   19,   19,   19,   19,   19,   19,
+
+   19,   19,   19,   19,   19,   19,   19,   19,   19,   19,
+   19,   19,   19,   19,   19,   19,   19,   19,   19,   19,
+   19,   19,  147,   14,   14,   16,   14,    0,   14,   14,
+   14,   14,   14,   14,   14,   14,   14,   13,   14,   14,
+   14,   14,   14,   14,   14,   14,   14,   14,   14,   14,
+   14,   14,   14,   14,   14,   14,   14,   14,   14,   14,
+   14,   14,   14,   14,   14,   14,   14,   14,   14,   14,
+   14,   14,   14,   14,   14,   14,   14,   14,   14,  147,
+   78,   78,   78,   78,    0,   78,   78,   78,   78,   78,
+   78,   78,   78,   78,   78,   78,   78,   78,   78,   78,
+
+   78,   78,   78,   78,   78,   78,   78,   78,   78,   78,
+   78,   78,   78,   78,   78,   78,   78,   78,   78,   78,
+   78,   78,   78,   78,   78,   78,   78,   78,   78,   78,
+   78,   78,   78,   78,   78,   78,   95,   95,   97,   95,
+    0,   95,   95,   95,   95,   95,   95,   95,   95,   95,
+   94,   95,   95,   95,   95,   95,   95,   95,   95,   95,
+   95,   95,   95,   95,   95,   95,   95,   95,   95,   95,
+   95,   95,   95,   95,   95,   95,   95,   95,   95,   95,
+   95,   95,   95,   95,   95,   95,   95,   95,   95,   95,
+   95,   95,   94,   94,   94,   94,    0,   94,   94,   94,
+
+   94,   94,   94,   94,   94,   94,    0,   94,   94,   94,
+   94,   94,   94,   94,   94,   94,   94,   94,   94,   94,
+   94,   94,   94,   94,   94,   94,   94,   94,   94,   94,
+   94,   94,   94,   94,   94,   94,   94,   94,   94,   94,
+   94,   94,   94,   94,   94,   94,   94,   94,  147,    0,
+    0,    0
+};
+
+static short lxr_base [148] = {
+    0,
+
+   57,    0,    0,    0,    0,    0,    0,   50,    0,  161,
+   47,   65,  190,    0,  306,  443,  219,    0,  201,  287,
+  428,    0,  284,    0,  150,  325,  151,   78,  125,  216,
+  195,  180,  154,  165,  150,  111,   92,  515,    0,   32,
+    0,    0,  255,    0,    0,   26,   46,    0,   41,    0,
+    0,   33,  105,   37,    0,  199,  117,  152,    0,  220,
+  139,  158,  276,  238,    0,  223,  142,  165,    0,   38,
+   68,   53,   34,   27,   49,  307,    0,  681,    0,   85,
+    0,   35,  158,    0,    0,   72,    0,   35,    0,    0,
+   56,    0,   57,  793,  737,  371,  495,   85,  127,  176,
+
+   68,    0,   36,    0,  624,    0,  238,  150,  169,    0,
+  182,  116,  118,  175,  145,    0,  217,  136,  155,    0,
+   51,   65,   69,   28,   15,   46,  476,  355,  389,  204,
+    0,   44,   75,   57,   27,   26,   50,  249,  454,  567,
+    0,    0,    3,   98,  107,  141,    0
+};
+
+static short lxr_accept [148] = {
+    0,
+
+    0,    0,   47,   44,   41,   35,   28,   44,   40,    6,
+    0,    0,   17,    0,    0,    0,    6,   10,    0,    0,
+    0,    0,    6,    5,    0,    6,    6,    6,    6,    6,
+    6,    6,    6,    6,    6,    6,    6,    6,   27,   44,
+   43,   42,    6,   37,   19,   29,   44,   38,   44,   36,
+   20,   30,   44,   44,   13,   13,    0,    0,   12,   12,
+    0,    0,   12,   13,   11,   11,    0,    0,    8,    8,
+    8,    8,    8,    8,    8,    8,   24,    2,    1,   44,
+   18,    0,   44,   31,   21,   44,   23,   44,   34,   26,
+   44,   25,   44,    3,    0,    0,    0,    0,    0,    0,
+
+    4,   39,   44,   46,   46,   16,   16,    0,    0,   15,
+   15,    0,    0,    0,    0,   14,   14,    0,    0,    7,
+    7,    7,    7,    7,    7,    7,    7,    0,    0,    0,
+    9,    9,    9,    9,    9,    9,    9,    9,    9,   46,
+   33,   32,   22,   44,   45,   45,   48
+};
+
+static short lxr_def [148] = {
+    0,
+
+    2,    0,  147,  143,  143,  143,  143,  143,  143,   38,
+  143,  143,   99,  105,  143,  143,   38,  143,  140,  143,
+  143,  140,   38,  143,  143,   38,   38,   38,   38,   38,
+   38,   38,   38,   38,   38,   38,   38,    0,  143,  143,
+  143,  143,   38,  143,  143,  143,  143,  143,  143,  143,
+  143,  143,  143,  143,  143,   57,  143,   57,  143,   61,
+  143,   61,   60,   56,  143,   67,  143,   67,  143,  143,
+   70,   70,  143,  143,  143,  130,  143,  140,  143,  143,
+  143,  143,  143,  143,  143,  143,  143,  143,  143,  143,
+  143,  143,  143,   95,  140,  143,  143,  143,  100,  143,
+
+  143,  143,  143,  143,    0,  143,  108,  143,  108,  143,
+  112,  143,  112,  128,  128,  143,  118,  143,  118,  143,
+  143,  121,  121,  143,  143,  143,  129,  143,  143,  143,
+  143,  143,  132,  132,  143,  143,  143,  130,  138,    0,
+  143,  143,    3,  143,  143,  145,    0
+};
+
+static unsigned char lxr_meta [60] = {
+    0,
+
+    0,    0,    0,    0,    0,    0,    0,    0,    0,    0,
+    0,    0,    0,    0,    0,    0,    0,    0,    0,    0,
+    0,    0,    0,    0,    0,    0,    0,    0,    0,    0,
+    0,    0,    0,    0,    0,    0,    0,    0,    0,    0,
+    0,    0,    0,    0,    0,    0,    0,    0,    0,    0,
+    0,    0,    0,    0,    0,    0,    0,    0,    0
+};
+
+static unsigned char lxr_class [256] = {
+   17,
+
+   17,   17,   17,   17,   17,   17,   17,   17,    0,    4,
+    8,    8,   17,   17,   17,   17,   17,   17,   17,   17,
+   17,   17,   17,   17,   17,   17,   17,   17,   17,   17,
+   17,    0,   19,   14,   20,   17,   21,   22,   11,   23,
+   24,   25,   26,   27,   10,   28,   29,   13,    1,    1,
+    1,    1,    1,    1,    1,   30,    6,   31,   32,   33,
+   34,   35,   15,   17,   16,   16,   16,   16,    5,   36,
+   18,   18,   18,   18,   18,   37,   18,   18,   18,   12,
+   18,   18,   18,   18,   38,   18,   18,    9,   18,   18,
+   39,    2,   40,   41,   42,   17,   43,   44,   16,   16,
+
+   45,    3,   18,   18,   46,   18,   18,   47,   18,    7,
+   18,   12,   18,   48,   18,   49,   50,    7,   18,   51,
+   18,   18,   52,   53,   54,   55,   17,   17,   17,   17,
+   17,   17,   17,   17,   17,   17,   17,   17,   17,   17,
+   17,   17,   17,   17,   17,   17,   17,   17,   17,   17,
+   17,   17,   17,   17,   17,   17,   17,   17,   17,   17,
+   17,   17,   17,   17,   17,   17,   17,   17,   17,   17,
+   17,   17,   17,   17,   17,   17,   17,   17,   17,   17,
+   17,   17,   17,   17,   17,   17,   17,   17,   17,   17,
+   17,   17,   17,   17,   17,   17,   17,   17,   17,   17,
+
+   17,   17,   17,   17,   17,   17,   17,   17,   17,   17,
+   17,   17,   17,   17,   17,   17,   17,   17,   17,   17,
+   17,   17,   17,   17,   17,   17,   17,   17,   17,   17,
+   17,   17,   17,   17,   17,   17,   17,   17,   17,   17,
+   17,   17,   17,   17,   17,   17,   17,   17,   17,   17,
+   17,   17,   17,   17,   17
+};
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*
+.. User can define the signature for lexer function as a macro
+.. The default type is `int lxr_lex (void)`
+*/
+#ifndef YYSTYPE
+  #define YYSTYPE  int lxr_lex ()
+#endif
+
+/*
+.. The list of api defined in lxr
+.. - lxr_source ( const char * source ) : sets "source" as the input
+..     source for the lexer.
+.. - lxr_read_bytes ( const char * bytes, size_t len, int bol ) : 
+       sets "bytes []" as the input source.
+..     "len" is the size of bytes[]. Input non-zero value for "bol" if
+..     the first character from bytes[] satisfy BOL status. Assumes
+..     the last character of bytes[] is followed by EOF.
+..     Warning : expects "bytes []" is not modified in the middle of
+..     parsing.
+.. - lxr_input () : return the next byte from the input source and
+..     move the reading pointer forwards. Return value in [0x00, 0xFF]
+..     or EOF (-1)
+.. - lxr_unput () : return previous byte from the input source and
+..     move the reading pointer backwards, in [0x00, 0xFF].
+..     Return value in [0x00, 0xff] or error (-1) if "limit" reached.
+..     "limit" : You can unput a maximum of yyleng characters (and the
+..     recently emulated lxr_input () characters).
+.. - lxr_token () : in case input()/unput() moved the pointer, you can
+..     call lxr_token() to accept a new token wherever the pointer is.
+.. - lxr_clean () : clean the stack of buffers.
+..     Call at the end of the program
+*/
+
+void lxr_source     ( const char * source );
+void lxr_read_bytes ( const char * bytes, size_t len, int bol );
+int  lxr_input      ( );
+int  lxr_unput      ( );
+void lxr_token      ( );
+void lxr_clean      ( );
+
+/*
+.. If user hasn't defined alternative to malloc, realloc & free.
+.. Note : In case user, defines alternative macros, please make sure
+.. to use the signature of the malloc/realloc/free functions in stdlib
+*/
+#ifndef LXR_ALLOC
+  #define lxr_alloc(_s_)        malloc  (_s_)
+  #define lxr_realloc(_a_,_s_)  realloc (_a_, _s_)
+  #define lxr_free(_a_)         free (_a_)
+#endif
+  
+#ifndef LXR_BUFF_SIZE
+  #define LXR_BUFF_SIZE  1<<14       /* default buffer size : 16 kB */
+#endif
+static size_t lxr_size = LXR_BUFF_SIZE;
+
+/*
+.. Input stream of bytes on which tokenization happens. If no file or
+.. bytes are specified, stdin is assumed as the source of bytes.
+.. You can specify a file as input source using "lxr_source ()" or
+.. a bytes array as the input source using "lxr_read_bytes ()"
+*/
+#define lxr_source_is_stdin   0
+#define lxr_source_is_file    1
+#define lxr_source_is_bytes   2
+static int lxr_source_type    = lxr_source_is_stdin;
+static char * lxr_infile      = NULL;
+static FILE * lxr_in          = NULL;
+static const char * lxr_bytes_start = NULL;
+static const char * lxr_bytes_end   = NULL;
+
+static void lxr_buffer_update ();
+static char lxr_yytext_dummy[] = "\n";
+
+/*
+.. yytext and yyleng are respectively the token text and token length
+.. of the last accepted token
+*/
+char * yytext = & lxr_yytext_dummy [1];
+int    yyleng = 0;
+
+/*
+.. Current line number and columen number.
+*/
+int lxr_line_no = 1;
+int lxr_col_no = 1;
+
+
+/*
+.. ---------------------------- Lexer --------------------------------
+.. This is a generated file for table based lexical analysis. The file
+.. contains (a) functions and macros related to reading source code
+.. and running action when a lexicon detected (b) compressed table for
+.. table based lexical analysis.
+*/
+
+typedef struct lxr_buff_stack {
+  char * bytes;
+  size_t size;
+  struct lxr_buff_stack * next; 
+} lxr_buff_stack ;
+
+/*
+.. With a table file, the tables (and the classes) are known only
+.. after it's mapped by lxr_tables_init ().
+*/
+#ifdef lxr_tables_file
+static unsigned char lxr_dummy[3];
+#else
+#define lxr_tables_init()
+static unsigned char
+  lxr_dummy[3] = {lxr_eob_class, lxr_eob_class, lxr_eob_class};
+#endif
+static unsigned char * lxr_start = lxr_dummy;
+static unsigned char * lxr_bptr  = lxr_dummy;
+static unsigned char * lxr_class_buff = NULL;
+static int lxr_class_buff_size = 0;
+
+static char lxr_hold_char = '\0';
+
+#define lxr_reset() do {                                             \
+    lxr_start = lxr_bptr = lxr_dummy;                                \
+    lxr_hold_char = '\0';                                            \
+    yytext = & lxr_yytext_dummy [1];                                 \
+    yyleng = 0;                                                      \
+  } while (0)
+
+static lxr_buff_stack * lxr_buff_stack_current = NULL;
+
+void lxr_source (const char * in) {
+  /* fixme : warn in case "bytes[]" is being used */
+  if (lxr_in) {
+    fprintf (stderr, "cannot change source file in the middle."
+      "\nuse lxr_stack_push (source) to change source file."
+      "\nalternatively use lxr_clear() + lxr_source()");
+    exit (-1);
+  }
+  if (in == NULL || (lxr_in = fopen (in, "r")) == NULL) {
+    fprintf (stderr, "cannot find lxr_infile %s", in ? in : "");
+    fflush (stderr);
+    exit (-1);
+  }
+  lxr_infile = strdup (in);
+  lxr_source_type = lxr_source_is_file;
+}
+
+void lxr_read_bytes (const char * bytes, size_t len, int eob) {
+  /* fixme : in case another byte source available */
+  size_t size = len < lxr_size ? len : lxr_size;
+  lxr_tables_init ();
+  lxr_buff_stack * bf = malloc (sizeof (lxr_buff_stack));
+  char * b = malloc (size + 2);
+  if (lxr_class_buff_size < size)
+    lxr_class_buff_size = size;
+  lxr_class_buff =
+    lxr_realloc (lxr_class_buff, lxr_class_buff_size + 2);
+  if ( bf == NULL || b == NULL || lxr_class_buff == NULL ) {
+    fprintf (stderr, "lxr_realloc failed");
+    exit (-1);
+  }
+  bf->bytes = b;
+  bf->next = lxr_buff_stack_current;
+  lxr_buff_stack_current = bf;
+  if (eob) b [0] = '\n';
+  yytext = & b [1];
+  yyleng = 0;
+  memcpy (yytext, bytes, size);
+  unsigned char * ub = (unsigned char *) yytext, 
+    * cls = lxr_class_buff;
+  for (size_t i=0; i<size; ++i)
+    *cls++ = lxr_class [*ub++];
+  cls [0] = cls [1] =
+    (size < len ? lxr_eob_class : lxr_eof_class);
+  lxr_bytes_start = & bytes [size];
+  lxr_bytes_end   = & bytes [len];
+  lxr_hold_char   = * yytext;
+  lxr_bptr = lxr_start = lxr_class_buff;
+  *yytext = '\0';
+  lxr_source_type = lxr_source_is_bytes;
+}
+
+/*
+.. In case input() or unput () was called after accepting the last
+.. token, create a new token depending on the pointer
+*/
+void lxr_token () {
+  if ( yyleng == (int) (lxr_bptr - lxr_start) )
+    return;
+  yytext [yyleng] = lxr_hold_char;
+  yyleng = (int) (lxr_bptr - lxr_start);
+  lxr_hold_char = yytext [yyleng];
+  yytext [yyleng] = '\0';
+}
+
+void lxr_clean () {
+  /*
+  .. Free all the memory blocks created for buffer.
+  .. User required to run this at the end of the program
+  */
+  lxr_buff_stack * s = lxr_buff_stack_current, * next;
+  while (s != NULL) {
+    next = s->next;
+    free (s->bytes);
+    free (s);
+    s = next;
+  }
+  lxr_buff_stack_current = NULL;
+
+  if (lxr_class_buff) {
+    free (lxr_class_buff);
+    lxr_class_buff = NULL;
+  }
+
+  if (lxr_in)
+    fclose (lxr_in);
+  if (lxr_infile)
+    free (lxr_infile);
+  lxr_in = NULL;
+  lxr_infile = NULL;
+  lxr_reset ();
+}
+
+/*
+.. return next (unsigned) byte from input stream. Return value is in
+.. [0x00, 0xFF]. Exception EOF
+*/
+int lxr_input () {
+  lxr_tables_init ();
+  if (*lxr_bptr == lxr_eob_class) {
+    yytext [yyleng] = lxr_hold_char;
+    lxr_buffer_update ();
+    lxr_hold_char = yytext [yyleng];
+    yytext [yyleng] = '\0';
+  }
+
+  if (*lxr_bptr == lxr_eof_class)
+    return EOF;
+
+  size_t idx = lxr_bptr++ - lxr_start;
+  return (int) (unsigned char) 
+   ( ((size_t) yyleng == idx) ? lxr_hold_char : yytext [idx] );
+}
+
+/*
+.. undo the lxr_input(). return previous byte.
+.. Note : there is a limit on how many unput() can be called. You
+.. cannot unput beyond the "yytext" pointer, i.e, you cannot go to
+.. the last accepted token.
+*/ 
+int lxr_unput () {
+  if ( (size_t) (lxr_bptr - lxr_start) > 0) {
+    size_t idx = (--lxr_bptr) - lxr_start;
+    return (int) (unsigned char) 
+      ( ((size_t) yyleng == idx) ? lxr_hold_char : yytext [idx] );
+  }
+  return EOF;               /*error : cannot undo beyond last token */
+}
+
+/*
+.. internal function to update buffer, when EOB transition is hit
+*/
+static void lxr_buffer_update () {
+
+  lxr_tables_init ();
+
+  if (lxr_in == NULL) {
+    lxr_in = stdin;
+    lxr_infile = strdup ("<stdin>");
+  }
+
+  if (lxr_bptr [0] != lxr_eob_class ||
+      lxr_bptr [1] != lxr_eob_class)
+  {
+    fprintf (stderr, "lxr_buffer_update () : internal check failed");
+    exit (-1);
+  }
+    
+  /*
+  .. "non_parsed" : Bytes already consumed by automaton but yet
+  .. to be accepted. These bytes will be copied to the new buffer.
+  .. fixme : may reallocate if non_parsed is > 50 % of buffer.
+  .. (as of now, reallocate if non_parsed == 100% of buffer)
+  */
+  size_t size = lxr_size, non_parsed = lxr_bptr - lxr_start;
+
+  lxr_buff_stack * s = lxr_buff_stack_current;
+  if (s == NULL || (yytext - s->bytes) > (size_t) 1 ) {
+
+    while ( size <= non_parsed )
+      size *= 2;
+
+    s = lxr_alloc (sizeof (lxr_buff_stack));
+    if ( s == NULL ) {
+      fprintf (stderr, "lxr_alloc failed");
+      exit (-1);
+    }
+    * s = (lxr_buff_stack) {
+      .size  = size,
+      .bytes = lxr_alloc (size + 2),
+      .next  = lxr_buff_stack_current
+    };
+    if (lxr_class_buff_size < size) {
+      lxr_class_buff_size = size;
+      lxr_class_buff = lxr_realloc (lxr_class_buff, size + 2); 
+    }
+    if ( s->bytes == NULL || lxr_class_buff == NULL ) {
+      fprintf (stderr, "lxr_alloc failed");
+      exit (-1);
+    }
+    memcpy (s->bytes, & yytext [-1], non_parsed + 1);
+    memmove (lxr_class_buff, lxr_start, non_parsed);
+
+    lxr_buff_stack_current = s; 
+  }
+  else {
+    size = s->size * 2;
+    s->bytes = lxr_realloc (s->bytes, size + 2);
+    if (lxr_class_buff_size < size) {
+      lxr_class_buff_size = size;
+      lxr_class_buff = lxr_realloc (lxr_class_buff, size + 2); 
+    }
+    s->size  = size;
+    if ( s->bytes == NULL || lxr_class_buff == NULL ) {
+      fprintf (stderr, "lxr_realloc failed");
+      exit (-1);
+    }
+  }
+
+  yytext = s->bytes + 1;
+  lxr_start = lxr_class_buff;
+  lxr_bptr = lxr_start + non_parsed;
+  lxr_hold_char = *yytext;
+  
+  size_t bytes;
+  switch (lxr_source_type) {
+    case lxr_source_is_stdin :
+    case lxr_source_is_file  :
+      bytes = 
+        fread ( & yytext [non_parsed], 1, size - non_parsed, lxr_in );
+      break;
+    case lxr_source_is_bytes :
+      bytes =
+        (size_t) (lxr_bytes_end - lxr_bytes_start) <=
+        (size - non_parsed) ? 
+        (size_t) (lxr_bytes_end - lxr_bytes_start) :
+        (size - non_parsed) ;
+      memcpy ( & yytext [non_parsed], lxr_bytes_start, bytes );
+      lxr_bytes_start += bytes;
+      break;
+    default :
+      fprintf (stderr, "lxr internal error: lxr_source_type unknown");
+      exit (-1);
+  }
+
+  unsigned char end_class = lxr_eob_class;
+  if (bytes < size - non_parsed) {
+    if (! ((lxr_source_type == lxr_source_is_bytes) ? 
+           (lxr_bytes_start == lxr_bytes_end) : feof (lxr_in)) )
+    {
+      fprintf (stderr, "lxr buffer : fread failed !!");
+      exit (-1);
+    }
+    end_class = lxr_eof_class;
+  }
+  unsigned char * byte = & ((unsigned char *) yytext) [non_parsed] ;
+  for (size_t i=0; i<bytes; ++i)
+    lxr_bptr [i] = lxr_class [ *byte++];
+  lxr_bptr [bytes] = lxr_bptr [bytes + 1] = end_class;
+  yytext   [bytes + non_parsed] = '\0';
+
+}
+
+
+/*
+.. table based tokenizer. Assumes,
+.. (a) state '0' : REJECT
+..     state '1' is the starting dfa.
+..     state '2' is the starting dfa (BOL)
+.. (b) There is no zero-length tokens,
+.. (c) maximum depth of lxr_max_depth for "def" (fallback) chaining.
+.. (d) states from lxr_template are templates, indexed by meta class.
+..     (or, if lxr_bitmap, there are neither fallbacks nor templates)
+.. (e) if lxr_npair, states with lxr_pidx [state] != 0 may take two
+..     bytes per lookup from lxr_pair [].
+.. (f) Token value '0' : rejected. No substring matched
+.. (g) accept value in [1, ntokens] for accepted tokens
+*/
+
+#define lxr_dead                             0
+#define lxr_not_rejected(s)                  (s)          /* s != 0 */
+#ifndef lxr_state_stack_size 
+#define lxr_state_stack_size                 128
+#endif
+#define lxr_clear_stack()           stack_idx = lxr_state_stack_size
+
+#if lxr_bitmap
+/*
+.. Bitmap encoding. Bit 'class' of lxr_bmap [state] is set, if the
+.. transition is not DEAD. Then the target is at the rank of the bit.
+*/
+#ifndef lxr_popcount
+#define lxr_popcount(x)                      __builtin_popcountll (x)
+#endif
+#define lxr_delta(state, class)                                      \
+  ( (lxr_bmap [state] >> (class) & 1) ?                              \
+    (int) lxr_target [lxr_boff [state] +                             \
+      lxr_popcount (lxr_bmap [state] & ((1ull << (class)) - 1))] :   \
+    lxr_dead )
+#else
+/*
+.. find the transition corresponding to the class using check/next
+.. tables and if not found in [base, base + nclass), use the fallback.
+.. Note: (a) a template is indexed by the meta class. (b) assumes
+.. transition is DEAD if number of fallbacks reaches max_depth
+*/
+static inline int lxr_delta ( int state, int class ) {
+  int depth = 0, meta = class;
+  while ( lxr_not_rejected (state) && 
+    ((int) lxr_check [lxr_base [state] + meta] != state) ) {
+    state = (depth++ == lxr_max_depth) ? lxr_dead : 
+      (int) lxr_def [state];
+    #if lxr_ntemplates
+    if (state >= lxr_template)
+      meta = (int) lxr_meta [class];
+    #endif
+  }
+  return lxr_not_rejected (state) ?
+    (int) lxr_next [lxr_base[state] + meta] : lxr_dead;
+}
+#endif
+
+/*
+.. The main lexer function. Returns 0, when EOF is encountered. So,
+.. don't use return value 0 inside any action.
+*/
+YYSTYPE
+{
+  static int states [lxr_state_stack_size];
+  unsigned char * cls;
+  int state, class, acc_token, acc_len, stack_idx, token,
+    acc_len_old, acc_token_old, state_old;
+
+  #define lxr_tokenizer_init()                                       \
+    do {                                                             \
+      yytext [yyleng] = lxr_hold_char;                               \
+      acc_len = (int) (lxr_bptr - lxr_start);                        \
+      yytext += acc_len;                                             \
+      for (; acc_len; --acc_len) {                                   \
+        if (*lxr_start++ == lxr_nel_class) {                         \
+          lxr_col_no = 1;                                            \
+          lxr_line_no++;                                             \
+          continue;                                                  \
+        }                                                            \
+        lxr_col_no++;                                                \
+      }                                                              \
+      state = 1 + (yytext [-1] == '\n');                             \
+      acc_token = 0;                                                 \
+      lxr_clear_stack();                                             \
+    } while (0) 
+
+  lxr_tables_init ();
+  lxr_tokenizer_init();
+  do {                  /* Loop looking the longest token until EOF */
+
+    /* in case to back up */
+    acc_len_old = acc_len;
+    acc_token_old = acc_token;
+    state_old = state;
+    
+    do {                            /* Transition loop until reject */
+      #if lxr_npair
+      /*
+      .. two bytes per lookup. Both the states are pushed to the stack.
+      .. A pair with a DEAD transition or a special class (like EOB) is
+      .. not in the table, then it falls back to a single step.
+      */
+      if ( lxr_pidx [state] && stack_idx > 1 &&
+        (class = (int) lxr_pclass [lxr_bptr [0]]) ) {
+        int pair = (int) lxr_pclass [lxr_bptr [1]];
+        pair = 2 * (((int) lxr_pidx [state] - 1) * lxr_npclass * 
+          lxr_npclass + class * lxr_npclass + pair);
+        if ( lxr_pair [pair + 1] ) {
+          states [--stack_idx] = state;
+          states [--stack_idx] = (int) lxr_pair [pair];
+          state = (int) lxr_pair [pair + 1];
+          lxr_bptr += 2;
+          continue;
+        }
+      }
+      #endif
+      class = (int) *lxr_bptr++;
+      states [--stack_idx] = state;         /* Keep stack of states */
+
+      state = lxr_delta (state, class);
+    } while ( lxr_not_rejected (state) && stack_idx );
+
+    cls = lxr_bptr - 1;
+    while (stack_idx < lxr_state_stack_size) {
+      /*
+      .. (a) "acc_token" will be the longest token
+      .. (b) In case two patterns are matched for the longest token,
+      .. use the first token defined in the lexer file.
+      .. (c) Before '\n' or EOF, the token is that of the state at
+      .. the end of line, lxr_eol_accept [] (i.e it may be a pattern
+      .. with the EOL anchor '$'). The table is not used, in case no
+      .. pattern use the anchor.
+      */
+      #if lxr_eol_used
+      if ( *cls == lxr_eof_class || *cls == lxr_nel_class )
+        token = lxr_eol_accept [states [stack_idx++]];
+      else
+      #endif
+      token = lxr_accept [states [stack_idx++]];
+      if ( token ) {
+        acc_len = cls - lxr_start;
+        acc_token = token;
+        break;
+      }
+      --cls;
+    }
+
+    if (lxr_not_rejected (state)) {
+      lxr_clear_stack ();
+      continue;
+    }
+
+    /*
+    .. Put the reading pointer at the last accepted location.
+    .. Update with the new holding character.
+    */
+    yyleng = acc_len ? acc_len : (acc_len = 1);
+    lxr_bptr = lxr_start + acc_len;
+    lxr_hold_char = yytext [acc_len];
+    yytext [acc_len] = '\0';
+
+    /*
+    .. handling accept/reject. In case of accepting, corresponding
+    .. action snippet will be executed. In case of reject (unknown,
+    .. pattern) lexer will simply consume without any warning. If you
+    .. don't want it to go unnoticed in suchcases, you can add an "all
+    .. catch" regex (.) in the last line of the rule section after all
+    .. the expected patterns are defined. A sample lex snippet is
+    ,, given below
+    ..
+    .. [_a-zA-Z][_a-zA-Z0-9]*                   { return ( IDENT );  }
+    .. .                                        { return ( ERROR );  }
+    */
+
+    do {   /* Just used a newer block to avoid clash of identifiers */
+
+      switch ( acc_token ) {
+        case 0 :                                 /* Unknown pattern */
+          #ifdef lxr_exception_fail
+          fprintf (stderr, "unknown token");
+          exit (-1);
+          #endif
+          break;
+
+
+        case 1 :
+          # line 34 "languages/c99/c99.lex"
+          {
+            int c;
+            while ( (c = lxr_input () ) != EOF ) {
+              if ( c != '*' ) continue;
+              while ( ( c = lxr_input () ) == '*' ) {}
+              if ( c == '/' ) break;
+            }
+          }
+          break;
+
+        case 2 :
+          # line 42 "languages/c99/c99.lex"
+          { /* skip single line comments */ }
+          break;
+
+        case 3 :
+          # line 43 "languages/c99/c99.lex"
+          { /* only for preprocessing */ }
+          break;
+
+        case 4 :
+          # line 44 "languages/c99/c99.lex"
+          { /* only for preprocessing */
+            int c, p = '#';
+            while ( (c = lxr_input () ) != EOF ) {
+              /* ISO C : '\\' immediately followed '\n' are ommitted */
+              if ( c == '\n' ) {
+                if ( p == '\\') {
+                  p = '\n'; continue;
+                }
+                break;
+              }
+              p = c;
+            }
+          }
+          break;
+
+        case 5 :
+          # line 57 "languages/c99/c99.lex"
+          { /* applied only for gcc/clang */
+            int c, scope = 1;
+            while ( (c = lxr_input () ) != EOF ) {
+              if ( c == '(' ) scope++;
+              if ( c == ')' ) {
+                scope--;
+                if (!scope) break;
+              }
+            }
+          }
+          break;
+
+        case 6 :
+          # line 67 "languages/c99/c99.lex"
+          {
+            /* fixme : classify : keywords, id, enum, typedef*/
+            return IDENTIFIER;
+          }
+          break;
+
+        case 7 :
+          # line 72 "languages/c99/c99.lex"
+          { return I_CONSTANT; }
+          break;
+
+        case 8 :
+          # line 73 "languages/c99/c99.lex"
+          { return I_CONSTANT; }
+          break;
+
+        case 9 :
+          # line 74 "languages/c99/c99.lex"
+          { return I_CONSTANT; }
+          break;
+
+        case 10 :
+          # line 75 "languages/c99/c99.lex"
+          { return I_CONSTANT; }
+          break;
+
+        case 11 :
+          # line 77 "languages/c99/c99.lex"
+          { return F_CONSTANT; }
+          break;
+
+        case 12 :
+          # line 78 "languages/c99/c99.lex"
+          { return F_CONSTANT; }
+          break;
+
+        case 13 :
+          # line 79 "languages/c99/c99.lex"
+          { return F_CONSTANT; }
+          break;
+
+        case 14 :
+          # line 80 "languages/c99/c99.lex"
+          { return F_CONSTANT; }
+          break;
+
+        case 15 :
+          # line 81 "languages/c99/c99.lex"
+          { return F_CONSTANT; }
+          break;
+
+        case 16 :
+          # line 82 "languages/c99/c99.lex"
+          { return F_CONSTANT; }
+          break;
+
+        case 17 :
+          # line 84 "languages/c99/c99.lex"
+          { return STRING_LITERAL; }
+          break;
+
+        case 18 :
+          # line 86 "languages/c99/c99.lex"
+          { return ELLIPSIS; }
+          break;
+
+        case 19 :
+          # line 87 "languages/c99/c99.lex"
+          { return RIGHT_ASSIGN; }
+          break;
+
+        case 20 :
+          # line 88 "languages/c99/c99.lex"
+          { return LEFT_ASSIGN; }
+          break;
+
+        case 21 :
+          # line 89 "languages/c99/c99.lex"
+          { return ADD_ASSIGN; }
+          break;
+
+        case 22 :
+          # line 90 "languages/c99/c99.lex"
+          { return SUB_ASSIGN; }
+          break;
+
+        case 23 :
+          # line 91 "languages/c99/c99.lex"
+          { return MUL_ASSIGN; }
+          break;
+
+        case 24 :
+          # line 92 "languages/c99/c99.lex"
+          { return DIV_ASSIGN; }
+          break;
+
+        case 25 :
+          # line 93 "languages/c99/c99.lex"
+          { return MOD_ASSIGN; }
+          break;
+
+        case 26 :
+          # line 94 "languages/c99/c99.lex"
+          { return AND_ASSIGN; }
+          break;
+
+        case 27 :
+          # line 95 "languages/c99/c99.lex"
+          { return XOR_ASSIGN; }
+          break;
+
+        case 28 :
+          # line 96 "languages/c99/c99.lex"
+          { return OR_ASSIGN; }
+          break;
+
+        case 29 :
+          # line 97 "languages/c99/c99.lex"
+          { return RIGHT_OP; }
+          break;
+
+        case 30 :
+          # line 98 "languages/c99/c99.lex"
+          { return LEFT_OP; }
+          break;
+
+        case 31 :
+          # line 99 "languages/c99/c99.lex"
+          { return INC_OP; }
+          break;
+
+        case 32 :
+          # line 100 "languages/c99/c99.lex"
+          { return DEC_OP; }
+          break;
+
+        case 33 :
+          # line 101 "languages/c99/c99.lex"
+          { return PTR_OP; }
+          break;
+
+        case 34 :
+          # line 102 "languages/c99/c99.lex"
+          { return AND_OP; }
+          break;
+
+        case 35 :
+          # line 103 "languages/c99/c99.lex"
+          { return OR_OP; }
+          break;
+
+        case 36 :
+          # line 104 "languages/c99/c99.lex"
+          { return LE_OP; }
+          break;
+
+        case 37 :
+          # line 105 "languages/c99/c99.lex"
+          { return GE_OP; }
+          break;
+
+        case 38 :
+          # line 106 "languages/c99/c99.lex"
+          { return EQ_OP; }
+          break;
+
+        case 39 :
+          # line 107 "languages/c99/c99.lex"
+          { return NE_OP; }
+          break;
+
+        case 40 :
+          # line 108 "languages/c99/c99.lex"
+          { return '{'; }
+          break;
+
+        case 41 :
+          # line 109 "languages/c99/c99.lex"
+          { return '}'; }
+          break;
+
+        case 42 :
+          # line 110 "languages/c99/c99.lex"
+          { return '['; }
+          break;
+
+        case 43 :
+          # line 111 "languages/c99/c99.lex"
+          { return ']'; }
+          break;
+
+        case 44 :
+          # line 112 "languages/c99/c99.lex"
+          {
+            /* single character tokens */
+            return yytext [0];
+          }
+          break;
+
+        case 45 :
+          # line 117 "languages/c99/c99.lex"
+          { /* consume */ }
+          break;
+
+        case 46 :
+          # line 118 "languages/c99/c99.lex"
+          { /* catch all bad characters */ }
+          break;
+
+
+# line 1196 "languages/c99/c99.c"
+
+        case lxr_eof_accept :
+          lxr_bptr = lxr_start;
+          yyleng = 0;
+          return 0;
+
+        case lxr_eob_accept :
+          lxr_bptr --;
+          lxr_buffer_update ();
+          break;
+
+        default :
+          fprintf (stderr, "internal error : unknown accept state");
+          exit (-1);
+
+      }
+    } while (0);
+
+    if (acc_token != lxr_eob_accept) {
+      lxr_tokenizer_init ();           /* start reading a new token */
+      continue;
+    }
+
+    /*
+    .. In case of EOB, we have to restart from the last state before
+    .. the lxr_eob_class transition. Reset acc_len and acc_token to
+    .. their backup ( In case there is no accepting state in the stack
+    .. "states [] ". )
+    */
+    state = (stack_idx == lxr_state_stack_size) ? 
+      state_old : states [stack_idx];
+    acc_len = acc_len_old;
+    acc_token = acc_token_old;
+
+  } while (1);
+
+  return EOF;                     /* The code will never reach here */
+}
+
+# line 121 "languages/c99/c99.lex"
+
+
+
+int main () {
+  int tkn;
+  while ( (tkn = lxr_lex()) ) {
+    printf ("\n[%3d] : %s", tkn, yytext);
+  }
+  lxr_clean ();
+}
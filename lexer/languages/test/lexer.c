@@ -0,0 +1,801 @@
+
+# line 3 "languages/test/lexer.c"
+
+/*
+.. Equivalence classes for alphabets in [0x00, 0xFF] are
+.. stored in the table lxr_class []. The number of equivalence
+.. classes also counts the special equivalence classes like
+.. that of EOB/EOL/EOF/BOL. However BOL transition is never
+.. used, as the state 2 is reserved for the starting DFA in
+.. case of BOL status. lxr_eol_class will be set to 0 in case
+.. no patterns are found with EOL requirement.
+*/
+#define lxr_nclass        11          /* num of eq classes */
+#define lxr_nel_class      1          /* new line  '\n'    */
+#define lxr_eob_class      7          /* end of buffer     */
+#define lxr_eol_class      8          /* end of line       */
+#define lxr_eof_class      9          /* end of file       */
+#define lxr_eol_used       1          /* EOL anchor used   */
+
+/*
+.. States [1, 9] are reserved for tokens listed in the lex 
+.. source file. In addition, the following two accept states
+.. are used internally for EOF/EOB
+*/
+#define lxr_eof_accept    10          /* end of file       */
+#define lxr_eob_accept    11          /* end of buffer     */
+
+/*
+.. A transition not found in the row of a state falls back to
+.. lxr_def [state], atmost lxr_max_depth times. States starting
+.. from lxr_template are template rows, which are indexed by the
+.. meta class lxr_meta [class] instead of the class.
+*/
+#define lxr_max_depth      1          /* def[] chain depth */
+#define lxr_template      21          /* first template    */
+#define lxr_ntemplates     0          /* num of templates  */
+
+/*
+.. If lxr_bitmap, transitions are encoded as a bitmap of the live
+.. classes, lxr_bmap [state], and the targets of the live classes
+.. starting from lxr_target [lxr_boff [state]].
+*/
+#define lxr_bitmap         0          /* bitmap backend    */
+
+/*
+.. If lxr_npair, the states of long tokens (lxr_pidx [state] != 0)
+.. read two bytes per lookup from the lxr_pair [] table, keyed on
+.. the pair classes lxr_pclass [] of the two bytes.
+*/
+#define lxr_npair          0          /* two byte stride   */
+#define lxr_npclass        0          /* num of pair class */
+
+static short lxr_check [38] = {
+    0,
+
+    0,   19,   19,   19,   15,    6,   10,    5,   17,    9,
+   17,   14,   11,    0,   14,   13,   13,   13,    2,    2,
+    2,   18,    0,   18,    2,   16,   12,   16,   12,    1,
+    0,    0,    0,    1,    0,    0,    0
+};
+
+static short lxr_next [38] = {
+    0,
+
+    0,   10,   13,   18,   15,    5,   20,    4,    7,   20,
+    8,   12,   20,    0,   20,   10,   11,   11,   14,   16,
+    6,   17,    0,   20,    3,   15,    9,   20,   20,   19,
+    0,    0,    0,   20,    0,    0,    0
+};
+
+static short lxr_base [21] = {
+    0,
+
+   27,   16,    0,    0,    0,    0,    0,    0,    3,    0,
+    6,   22,   14,    8,    0,   21,    3,   17,    0,    0
+
+};
+
+static short lxr_accept [21] = {
+    0,
+
+    0,    0,   10,    9,    0,    0,    8,    5,    6,    4,
+    0,    2,    1,    0,    3,    1,    7,    2,    0,   11
+
+};
+
+static short lxr_eol_accept [21] = {
+    0,
+
+    0,    0,   10,    9,    9,    0,    8,    5,    5,    4,
+    0,    2,    1,    0,    3,    1,    5,    2,    0,   11
+
+};
+
+static short lxr_def [21] = {
+    0,
+
+    2,   11,   20,   10,   10,   10,   10,   10,   17,    3,
+   13,   13,   14,   19,   10,   13,   10,   13,    9,    0
+
+};
+
+static unsigned char lxr_meta [11] = {
+    0,
+
+    0,    0,    0,    0,    0,    0,    0,    0,    0,    0
+
+};
+
+static unsigned char lxr_class [256] = {
+    0,
+
+    0,    0,    0,    0,    0,    0,    0,    0,    0,    1,
+    0,    0,    0,    0,    0,    0,    0,    0,    0,    0,
+    0,    0,    0,    0,    0,    0,    0,    0,    0,    0,
+    0,    0,    0,    0,    0,    0,    0,    0,    0,    0,
+    0,    0,    0,    0,    0,    0,    0,    2,    0,    0,
+    0,    0,    0,    0,    0,    0,    0,    0,    0,    0,
+    0,    0,    0,    0,    0,    0,    0,    0,    0,    0,
+    0,    0,    0,    0,    0,    0,    0,    0,    0,    0,
+    0,    0,    0,    0,    0,    0,    0,    0,    0,    0,
+    0,    0,    0,    0,    0,    0,    3,    4,    5,    6,
+
+    0,    0,    0,    0,    0,    0,    0,    0,    0,    0,
+    0,    0,    0,    0,    0,    0,    0,    0,    0,    0,
+    0,    0,    0,    0,    0,    0,    0,    0,    0,    0,
+    0,    0,    0,    0,    0,    0,    0,    0,    0,    0,
+    0,    0,    0,    0,    0,    0,    0,    0,    0,    0,
+    0,    0,    0,    0,    0,    0,    0,    0,    0,    0,
+    0,    0,    0,    0,    0,    0,    0,    0,    0,    0,
+    0,    0,    0,    0,    0,    0,    0,    0,    0,    0,
+    0,    0,    0,    0,    0,    0,    0,    0,    0,    0,
+    0,    0,    0,    0,    0,    0,    0,    0,    0,    0,
+
+    0,    0,    0,    0,    0,    0,    0,    0,    0,    0,
+    0,    0,    0,    0,    0,    0,    0,    0,    0,    0,
+    0,    0,    0,    0,    0,    0,    0,    0,    0,    0,
+    0,    0,    0,    0,    0,    0,    0,    0,    0,    0,
+    0,    0,    0,    0,    0,    0,    0,    0,    0,    0,
+    0,    0,    0,    0,    0
+};
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*
+.. User can define the signature for lexer function as a macro
+.. The default type is `int lxr_lex (void)`
+*/
+#ifndef YYSTYPE
+  #define YYSTYPE  int lxr_lex ()
+#endif
+
+/*
+.. The list of api defined in lxr
+.. - lxr_source ( const char * source ) : sets "source" as the input
+..     source for the lexer.
+.. - lxr_read_bytes ( const char * bytes, size_t len, int bol ) : 
+       sets "bytes []" as the input source.
+..     "len" is the size of bytes[]. Input non-zero value for "bol" if
+..     the first character from bytes[] satisfy BOL status. Assumes
+..     the last character of bytes[] is followed by EOF.
+..     Warning : expects "bytes []" is not modified in the middle of
+..     parsing.
+.. - lxr_input () : return the next byte from the input source and
+..     move the reading pointer forwards. Return value in [0x00, 0xFF]
+..     or EOF (-1)
+.. - lxr_unput () : return previous byte from the input source and
+..     move the reading pointer backwards, in [0x00, 0xFF].
+..     Return value in [0x00, 0xff] or error (-1) if "limit" reached.
+..     "limit" : You can unput a maximum of yyleng characters (and the
+..     recently emulated lxr_input () characters).
+.. - lxr_token () : in case input()/unput() moved the pointer, you can
+..     call lxr_token() to accept a new token wherever the pointer is.
+.. - lxr_clean () : clean the stack of buffers.
+..     Call at the end of the program
+*/
+
+void lxr_source     ( const char * source );
+void lxr_read_bytes ( const char * bytes, size_t len, int bol );
+int  lxr_input      ( );
+int  lxr_unput      ( );
+void lxr_token      ( );
+void lxr_clean      ( );
+
+/*
+.. If user hasn't defined alternative to malloc, realloc & free.
+.. Note : In case user, defines alternative macros, please make sure
+.. to use the signature of the malloc/realloc/free functions in stdlib
+*/
+#ifndef LXR_ALLOC
+  #define lxr_alloc(_s_)        malloc  (_s_)
+  #define lxr_realloc(_a_,_s_)  realloc (_a_, _s_)
+  #define lxr_free(_a_)         free (_a_)
+#endif
+  
+#ifndef LXR_BUFF_SIZE
+  #define LXR_BUFF_SIZE  1<<14       /* default buffer size : 16 kB */
+#endif
+static size_t lxr_size = LXR_BUFF_SIZE;
+
+/*
+.. Input stream of bytes on which tokenization happens. If no file or
+.. bytes are specified, stdin is assumed as the source of bytes.
+.. You can specify a file as input source using "lxr_source ()" or
+.. a bytes array as the input source using "lxr_read_bytes ()"
+*/
+#define lxr_source_is_stdin   0
+#define lxr_source_is_file    1
+#define lxr_source_is_bytes   2
+static int lxr_source_type    = lxr_source_is_stdin;
+static char * lxr_infile      = NULL;
+static FILE * lxr_in          = NULL;
+static const char * lxr_bytes_start = NULL;
+static const char * lxr_bytes_end   = NULL;
+
+static void lxr_buffer_update ();
+static char lxr_yytext_dummy[] = "\n";
+
+/*
+.. yytext and yyleng are respectively the token text and token length
+.. of the last accepted token
+*/
+char * yytext = & lxr_yytext_dummy [1];
+int    yyleng = 0;
+
+/*
+.. Current line number and columen number.
+*/
+int lxr_line_no = 1;
+int lxr_col_no = 1;
+
+
+/*
+.. ---------------------------- Lexer --------------------------------
+.. This is a generated file for table based lexical analysis. The file
+.. contains (a) functions and macros related to reading source code
+.. and running action when a lexicon detected (b) compressed table for
+.. table based lexical analysis.
+*/
+
+typedef struct lxr_buff_stack {
+  char * bytes;
+  size_t size;
+  struct lxr_buff_stack * next; 
+} lxr_buff_stack ;
+
+/*
+.. With a table file, the tables (and the classes) are known only
+.. after it's mapped by lxr_tables_init ().
+*/
+#ifdef lxr_tables_file
+static unsigned char lxr_dummy[3];
+#else
+#define lxr_tables_init()
+static unsigned char
+  lxr_dummy[3] = {lxr_eob_class, lxr_eob_class, lxr_eob_class};
+#endif
+static unsigned char * lxr_start = lxr_dummy;
+static unsigned char * lxr_bptr  = lxr_dummy;
+static unsigned char * lxr_class_buff = NULL;
+static int lxr_class_buff_size = 0;
+
+static char lxr_hold_char = '\0';
+
+#define lxr_reset() do {                                             \
+    lxr_start = lxr_bptr = lxr_dummy;                                \
+    lxr_hold_char = '\0';                                            \
+    yytext = & lxr_yytext_dummy [1];                                 \
+    yyleng = 0;                                                      \
+  } while (0)
+
+static lxr_buff_stack * lxr_buff_stack_current = NULL;
+
+void lxr_source (const char * in) {
+  /* fixme : warn in case "bytes[]" is being used */
+  if (lxr_in) {
+    fprintf (stderr, "cannot change source file in the middle."
+      "\nuse lxr_stack_push (source) to change source file."
+      "\nalternatively use lxr_clear() + lxr_source()");
+    exit (-1);
+  }
+  if (in == NULL || (lxr_in = fopen (in, "r")) == NULL) {
+    fprintf (stderr, "cannot find lxr_infile %s", in ? in : "");
+    fflush (stderr);
+    exit (-1);
+  }
+  lxr_infile = strdup (in);
+  lxr_source_type = lxr_source_is_file;
+}
+
+void lxr_read_bytes (const char * bytes, size_t len, int eob) {
+  /* fixme : in case another byte source available */
+  size_t size = len < lxr_size ? len : lxr_size;
+  lxr_tables_init ();
+  lxr_buff_stack * bf = malloc (sizeof (lxr_buff_stack));
+  char * b = malloc (size + 2);
+  if (lxr_class_buff_size < size)
+    lxr_class_buff_size = size;
+  lxr_class_buff =
+    lxr_realloc (lxr_class_buff, lxr_class_buff_size + 2);
+  if ( bf == NULL || b == NULL || lxr_class_buff == NULL ) {
+    fprintf (stderr, "lxr_realloc failed");
+    exit (-1);
+  }
+  bf->bytes = b;
+  bf->next = lxr_buff_stack_current;
+  lxr_buff_stack_current = bf;
+  if (eob) b [0] = '\n';
+  yytext = & b [1];
+  yyleng = 0;
+  memcpy (yytext, bytes, size);
+  unsigned char * ub = (unsigned char *) yytext, 
+    * cls = lxr_class_buff;
+  for (size_t i=0; i<size; ++i)
+    *cls++ = lxr_class [*ub++];
+  cls [0] = cls [1] =
+    (size < len ? lxr_eob_class : lxr_eof_class);
+  lxr_bytes_start = & bytes [size];
+  lxr_bytes_end   = & bytes [len];
+  lxr_hold_char   = * yytext;
+  lxr_bptr = lxr_start = lxr_class_buff;
+  *yytext = '\0';
+  lxr_source_type = lxr_source_is_bytes;
+}
+
+/*
+.. In case input() or unput () was called after accepting the last
+.. token, create a new token depending on the pointer
+*/
+void lxr_token () {
+  if ( yyleng == (int) (lxr_bptr - lxr_start) )
+    return;
+  yytext [yyleng] = lxr_hold_char;
+  yyleng = (int) (lxr_bptr - lxr_start);
+  lxr_hold_char = yytext [yyleng];
+  yytext [yyleng] = '\0';
+}
+
+void lxr_clean () {
+  /*
+  .. Free all the memory blocks created for buffer.
+  .. User required to run this at the end of the program
+  */
+  lxr_buff_stack * s = lxr_buff_stack_current, * next;
+  while (s != NULL) {
+    next = s->next;
+    free (s->bytes);
+    free (s);
+    s = next;
+  }
+  lxr_buff_stack_current = NULL;
+
+  if (lxr_class_buff) {
+    free (lxr_class_buff);
+    lxr_class_buff = NULL;
+  }
+
+  if (lxr_in)
+    fclose (lxr_in);
+  if (lxr_infile)
+    free (lxr_infile);
+  lxr_in = NULL;
+  lxr_infile = NULL;
+  lxr_reset ();
+}
+
+/*
+.. return next (unsigned) byte from input stream. Return value is in
+.. [0x00, 0xFF]. Exception EOF
+*/
+int lxr_input () {
+  lxr_tables_init ();
+  if (*lxr_bptr == lxr_eob_class) {
+    yytext [yyleng] = lxr_hold_char;
+    lxr_buffer_update ();
+    lxr_hold_char = yytext [yyleng];
+    yytext [yyleng] = '\0';
+  }
+
+  if (*lxr_bptr == lxr_eof_class)
+    return EOF;
+
+  size_t idx = lxr_bptr++ - lxr_start;
+  return (int) (unsigned char) 
+   ( ((size_t) yyleng == idx) ? lxr_hold_char : yytext [idx] );
+}
+
+/*
+.. undo the lxr_input(). return previous byte.
+.. Note : there is a limit on how many unput() can be called. You
+.. cannot unput beyond the "yytext" pointer, i.e, you cannot go to
+.. the last accepted token.
+*/ 
+int lxr_unput () {
+  if ( (size_t) (lxr_bptr - lxr_start) > 0) {
+    size_t idx = (--lxr_bptr) - lxr_start;
+    return (int) (unsigned char) 
+      ( ((size_t) yyleng == idx) ? lxr_hold_char : yytext [idx] );
+  }
+  return EOF;               /*error : cannot undo beyond last token */
+}
+
+/*
+.. internal function to update buffer, when EOB transition is hit
+*/
+static void lxr_buffer_update () {
+
+  lxr_tables_init ();
+
+  if (lxr_in == NULL) {
+    lxr_in = stdin;
+    lxr_infile = strdup ("<stdin>");
+  }
+
+  if (lxr_bptr [0] != lxr_eob_class ||
+      lxr_bptr [1] != lxr_eob_class)
+  {
+    fprintf (stderr, "lxr_buffer_update () : internal check failed");
+    exit (-1);
+  }
+    
+  /*
+  .. "non_parsed" : Bytes already consumed by automaton but yet
+  .. to be accepted. These bytes will be copied to the new buffer.
+  .. fixme : may reallocate if non_parsed is > 50 % of buffer.
+  .. (as of now, reallocate if non_parsed == 100% of buffer)
+  */
+  size_t size = lxr_size, non_parsed = lxr_bptr - lxr_start;
+
+  lxr_buff_stack * s = lxr_buff_stack_current;
+  if (s == NULL || (yytext - s->bytes) > (size_t) 1 ) {
+
+    while ( size <= non_parsed )
+      size *= 2;
+
+    s = lxr_alloc (sizeof (lxr_buff_stack));
+    if ( s == NULL ) {
+      fprintf (stderr, "lxr_alloc failed");
+      exit (-1);
+    }
+    * s = (lxr_buff_stack) {
+      .size  = size,
+      .bytes = lxr_alloc (size + 2),
+      .next  = lxr_buff_stack_current
+    };
+    if (lxr_class_buff_size < size) {
+      lxr_class_buff_size = size;
+      lxr_class_buff = lxr_realloc (lxr_class_buff, size + 2); 
+    }
+    if ( s->bytes == NULL || lxr_class_buff == NULL ) {
+      fprintf (stderr, "lxr_alloc failed");
+      exit (-1);
+    }
+    memcpy (s->bytes, & yytext [-1], non_parsed + 1);
+    memmove (lxr_class_buff, lxr_start, non_parsed);
+
+    lxr_buff_stack_current = s; 
+  }
+  else {
+    size = s->size * 2;
+    s->bytes = lxr_realloc (s->bytes, size + 2);
+    if (lxr_class_buff_size < size) {
+      lxr_class_buff_size = size;
+      lxr_class_buff = lxr_realloc (lxr_class_buff, size + 2); 
+    }
+    s->size  = size;
+    if ( s->bytes == NULL || lxr_class_buff == NULL ) {
+      fprintf (stderr, "lxr_realloc failed");
+      exit (-1);
+    }
+  }
+
+  yytext = s->bytes + 1;
+  lxr_start = lxr_class_buff;
+  lxr_bptr = lxr_start + non_parsed;
+  lxr_hold_char = *yytext;
+  
+  size_t bytes;
+  switch (lxr_source_type) {
+    case lxr_source_is_stdin :
+    case lxr_source_is_file  :
+      bytes = 
+        fread ( & yytext [non_parsed], 1, size - non_parsed, lxr_in );
+      break;
+    case lxr_source_is_bytes :
+      bytes =
+        (size_t) (lxr_bytes_end - lxr_bytes_start) <=
+        (size - non_parsed) ? 
+        (size_t) (lxr_bytes_end - lxr_bytes_start) :
+        (size - non_parsed) ;
+      memcpy ( & yytext [non_parsed], lxr_bytes_start, bytes );
+      lxr_bytes_start += bytes;
+      break;
+    default :
+      fprintf (stderr, "lxr internal error: lxr_source_type unknown");
+      exit (-1);
+  }
+
+  unsigned char end_class = lxr_eob_class;
+  if (bytes < size - non_parsed) {
+    if (! ((lxr_source_type == lxr_source_is_bytes) ? 
+           (lxr_bytes_start == lxr_bytes_end) : feof (lxr_in)) )
+    {
+      fprintf (stderr, "lxr buffer : fread failed !!");
+      exit (-1);
+    }
+    end_class = lxr_eof_class;
+  }
+  unsigned char * byte = & ((unsigned char *) yytext) [non_parsed] ;
+  for (size_t i=0; i<bytes; ++i)
+    lxr_bptr [i] = lxr_class [ *byte++];
+  lxr_bptr [bytes] = lxr_bptr [bytes + 1] = end_class;
+  yytext   [bytes + non_parsed] = '\0';
+
+}
+
+
+/*
+.. table based tokenizer. Assumes,
+.. (a) state '0' : REJECT
+..     state '1' is the starting dfa.
+..     state '2' is the starting dfa (BOL)
+.. (b) There is no zero-length tokens,
+.. (c) maximum depth of lxr_max_depth for "def" (fallback) chaining.
+.. (d) states from lxr_template are templates, indexed by meta class.
+..     (or, if lxr_bitmap, there are neither fallbacks nor templates)
+.. (e) if lxr_npair, states with lxr_pidx [state] != 0 may take two
+..     bytes per lookup from lxr_pair [].
+.. (f) Token value '0' : rejected. No substring matched
+.. (g) accept value in [1, ntokens] for accepted tokens
+*/
+
+#define lxr_dead                             0
+#define lxr_not_rejected(s)                  (s)          /* s != 0 */
+#ifndef lxr_state_stack_size 
+#define lxr_state_stack_size                 128
+#endif
+#define lxr_clear_stack()           stack_idx = lxr_state_stack_size
+
+#if lxr_bitmap
+/*
+.. Bitmap encoding. Bit 'class' of lxr_bmap [state] is set, if the
+.. transition is not DEAD. Then the target is at the rank of the bit.
+*/
+#ifndef lxr_popcount
+#define lxr_popcount(x)                      __builtin_popcountll (x)
+#endif
+#define lxr_delta(state, class)                                      \
+  ( (lxr_bmap [state] >> (class) & 1) ?                              \
+    (int) lxr_target [lxr_boff [state] +                             \
+      lxr_popcount (lxr_bmap [state] & ((1ull << (class)) - 1))] :   \
+    lxr_dead )
+#else
+/*
+.. find the transition corresponding to the class using check/next
+.. tables and if not found in [base, base + nclass), use the fallback.
+.. Note: (a) a template is indexed by the meta class. (b) assumes
+.. transition is DEAD if number of fallbacks reaches max_depth
+*/
+static inline int lxr_delta ( int state, int class ) {
+  int depth = 0, meta = class;
+  while ( lxr_not_rejected (state) && 
+    ((int) lxr_check [lxr_base [state] + meta] != state) ) {
+    state = (depth++ == lxr_max_depth) ? lxr_dead : 
+      (int) lxr_def [state];
+    #if lxr_ntemplates
+    if (state >= lxr_template)
+      meta = (int) lxr_meta [class];
+    #endif
+  }
+  return lxr_not_rejected (state) ?
+    (int) lxr_next [lxr_base[state] + meta] : lxr_dead;
+}
+#endif
+
+/*
+.. The main lexer function. Returns 0, when EOF is encountered. So,
+.. don't use return value 0 inside any action.
+*/
+YYSTYPE
+{
+  static int states [lxr_state_stack_size];
+  unsigned char * cls;
+  int state, class, acc_token, acc_len, stack_idx, token,
+    acc_len_old, acc_token_old, state_old;
+
+  #define lxr_tokenizer_init()                                       \
+    do {                                                             \
+      yytext [yyleng] = lxr_hold_char;                               \
+      acc_len = (int) (lxr_bptr - lxr_start);                        \
+      yytext += acc_len;                                             \
+      for (; acc_len; --acc_len) {                                   \
+        if (*lxr_start++ == lxr_nel_class) {                         \
+          lxr_col_no = 1;                                            \
+          lxr_line_no++;                                             \
+          continue;                                                  \
+        }                                                            \
+        lxr_col_no++;                                                \
+      }                                                              \
+      state = 1 + (yytext [-1] == '\n');                             \
+      acc_token = 0;                                                 \
+      lxr_clear_stack();                                             \
+    } while (0) 
+
+  lxr_tables_init ();
+  lxr_tokenizer_init();
+  do {                  /* Loop looking the longest token until EOF */
+
+    /* in case to back up */
+    acc_len_old = acc_len;
+    acc_token_old = acc_token;
+    state_old = state;
+    
+    do {                            /* Transition loop until reject */
+      #if lxr_npair
+      /*
+      .. two bytes per lookup. Both the states are pushed to the stack.
+      .. A pair with a DEAD transition or a special class (like EOB) is
+      .. not in the table, then it falls back to a single step.
+      */
+      if ( lxr_pidx [state] && stack_idx > 1 &&
+        (class = (int) lxr_pclass [lxr_bptr [0]]) ) {
+        int pair = (int) lxr_pclass [lxr_bptr [1]];
+        pair = 2 * (((int) lxr_pidx [state] - 1) * lxr_npclass * 
+          lxr_npclass + class * lxr_npclass + pair);
+        if ( lxr_pair [pair + 1] ) {
+          states [--stack_idx] = state;
+          states [--stack_idx] = (int) lxr_pair [pair];
+          state = (int) lxr_pair [pair + 1];
+          lxr_bptr += 2;
+          continue;
+        }
+      }
+      #endif
+      class = (int) *lxr_bptr++;
+      states [--stack_idx] = state;         /* Keep stack of states */
+
+      state = lxr_delta (state, class);
+    } while ( lxr_not_rejected (state) && stack_idx );
+
+    cls = lxr_bptr - 1;
+    while (stack_idx < lxr_state_stack_size) {
+      /*
+      .. (a) "acc_token" will be the longest token
+      .. (b) In case two patterns are matched for the longest token,
+      .. use the first token defined in the lexer file.
+      .. (c) Before '\n' or EOF, the token is that of the state at
+      .. the end of line, lxr_eol_accept [] (i.e it may be a pattern
+      .. with the EOL anchor '$'). The table is not used, in case no
+      .. pattern use the anchor.
+      */
+      #if lxr_eol_used
+      if ( *cls == lxr_eof_class || *cls == lxr_nel_class )
+        token = lxr_eol_accept [states [stack_idx++]];
+      else
+      #endif
+      token = lxr_accept [states [stack_idx++]];
+      if ( token ) {
+        acc_len = cls - lxr_start;
+        acc_token = token;
+        break;
+      }
+      --cls;
+    }
+
+    if (lxr_not_rejected (state)) {
+      lxr_clear_stack ();
+      continue;
+    }
+
+    /*
+    .. Put the reading pointer at the last accepted location.
+    .. Update with the new holding character.
+    */
+    yyleng = acc_len ? acc_len : (acc_len = 1);
+    lxr_bptr = lxr_start + acc_len;
+    lxr_hold_char = yytext [acc_len];
+    yytext [acc_len] = '\0';
+
+    /*
+    .. handling accept/reject. In case of accepting, corresponding
+    .. action snippet will be executed. In case of reject (unknown,
+    .. pattern) lexer will simply consume without any warning. If you
+    .. don't want it to go unnoticed in suchcases, you can add an "all
+    .. catch" regex (.) in the last line of the rule section after all
+    .. the expected patterns are defined. A sample lex snippet is
+    ,, given below
+    ..
+    .. [_a-zA-Z][_a-zA-Z0-9]*                   { return ( IDENT );  }
+    .. .                                        { return ( ERROR );  }
+    */
+
+    do {   /* Just used a newer block to avoid clash of identifiers */
+
+      switch ( acc_token ) {
+        case 0 :                                 /* Unknown pattern */
+          #ifdef lxr_exception_fail
+          fprintf (stderr, "unknown token");
+          exit (-1);
+          #endif
+          break;
+
+
+        case 1 :
+          # line 3 "languages/test/lexer.lex"
+          { return 1; }
+          break;
+
+        case 2 :
+          # line 4 "languages/test/lexer.lex"
+          { return 2; }
+          break;
+
+        case 3 :
+          # line 5 "languages/test/lexer.lex"
+          { return 3; }
+          break;
+
+        case 4 :
+          # line 6 "languages/test/lexer.lex"
+          { return 4; }
+          break;
+
+        case 5 :
+          # line 7 "languages/test/lexer.lex"
+          { return 5; }
+          break;
+
+        case 6 :
+          # line 8 "languages/test/lexer.lex"
+          { return 6; }
+          break;
+
+        case 7 :
+          # line 9 "languages/test/lexer.lex"
+          { return 7; }
+          break;
+
+        case 8 :
+          # line 10 "languages/test/lexer.lex"
+          { return 8; }
+          break;
+
+        case 9 :
+          # line 11 "languages/test/lexer.lex"
+          { return 9; }
+          break;
+
+
+# line 753 "languages/test/lexer.c"
+
+        case lxr_eof_accept :
+          lxr_bptr = lxr_start;
+          yyleng = 0;
+          return 0;
+
+        case lxr_eob_accept :
+          lxr_bptr --;
+          lxr_buffer_update ();
+          break;
+
+        default :
+          fprintf (stderr, "internal error : unknown accept state");
+          exit (-1);
+
+      }
+    } while (0);
+
+    if (acc_token != lxr_eob_accept) {
+      lxr_tokenizer_init ();           /* start reading a new token */
+      continue;
+    }
+
+    /*
+    .. In case of EOB, we have to restart from the last state before
+    .. the lxr_eob_class transition. Reset acc_len and acc_token to
+    .. their backup ( In case there is no accepting state in the stack
+    .. "states [] ". )
+    */
+    state = (stack_idx == lxr_state_stack_size) ? 
+      state_old : states [stack_idx];
+    acc_len = acc_len_old;
+    acc_token = acc_token_old;
+
+  } while (1);
+
+  return EOF;                     /* The code will never reach here */
+}
+
+# line 14 "languages/test/lexer.lex"
+
+
+int main () {
+  int tkn;
+  while ( (tkn = lxr_lex()) ) {
+    printf ("\nl%d c%2d: [tkn : %d] %s",
+      lxr_line_no, lxr_col_no, tkn, yytext);
+  } 
+}
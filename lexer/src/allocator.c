@@ -3,6 +3,7 @@
 #include <assert.h>
 #include <stdint.h>
 #include <stdio.h>
+#include <pthread.h>
 
 #include "allocator.h"
 #include "bits.h"
@@ -17,6 +18,26 @@ static Block  * blockhead = NULL;
 static void  ** bins      = NULL;
 static unsigned bits      = 0;
 
+/*
+.. Objects larger than PAGE_SIZE (like the transition tables of a
+.. large dfa, or the list of it's states) are not carved out of the
+.. blocks. Each of them is malloc'ed with a header, that links it to
+.. the list of large objects, so that deallocate () can free it.
+*/
+typedef struct Large {
+  struct Large * next, * prev;
+  size_t size, seq;
+} Large ;
+
+static Large  * largehead = NULL;
+static size_t   nlarge    = 0;      /* sequence number of the large */
+
+/*
+.. The pool is shared by all the threads (ex : parallel subset
+.. construction in dfa.c). So the bump pointer is moved under a lock.
+*/
+static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+
 static Block * block_new ( void ) {
   size_t s = BLOCK_SIZE;
   void * mem = NULL;
@@ -55,21 +76,104 @@ void destroy () {
     free ( blockhead );
     blockhead = next;
   }
+  while ( largehead ){
+    Large * next = largehead->next;
+    free ( largehead );
+    largehead = next;
+  }
+}
+
+static void * large_new ( size_t size ) {
+  Large * l = calloc ( 1, sizeof (Large) + size );
+  assert (l);
+  l->size = size;
+  pthread_mutex_lock (&lock);
+  l->seq = ++nlarge;
+  if ( (l->next = largehead) != NULL )
+    largehead->prev = l;
+  largehead = l;
+  pthread_mutex_unlock (&lock);
+  return (void *) (l + 1);
+}
+
+static void large_free ( void * m ) {
+  Large * l = (Large *) m - 1;
+  pthread_mutex_lock (&lock);
+  if (l->prev) l->prev->next = l->next;
+  else largehead = l->next;
+  if (l->next) l->next->prev = l->prev;
+  pthread_mutex_unlock (&lock);
+  free (l);
 }
 
 void * allocate ( size_t size ) {
   size = (size + 7) & ~((size_t) 7);
+  if ( size > PAGE_SIZE )
+    return large_new (size);
+  pthread_mutex_lock (&lock);
   if (!block_available (size)) {
     Block * oldb = blockhead, * newb = block_new();
     if (oldb) { oldb->prev = newb; }
   }
   char * mem = blockhead->head;
-  memset (mem, 0, size);
   blockhead->head += size;
   blockhead->size -= size;
+  pthread_mutex_unlock (&lock);
+  memset (mem, 0, size);
   return (void *) mem;
 }
 
+size_t allocated ( ) {
+  size_t used = 0;
+  pthread_mutex_lock (&lock);
+  for (Block * b = blockhead; b; b = b->next)
+    used += b->allocsize - b->size;
+  for (Large * l = largehead; l; l = l->next)
+    used += l->size;
+  pthread_mutex_unlock (&lock);
+  return used;
+}
+
+/*
+.. New blocks and large objects are added at the head of their lists.
+.. So the release frees the blocks up to the marked one (whose bump
+.. pointer is moved back) and the large objects with a larger sequence
+.. number.
+*/
+AllocMark allocator_mark ( ) {
+  pthread_mutex_lock (&lock);
+  AllocMark m = {
+    .block = blockhead, .head = blockhead ? blockhead->head : NULL,
+    .size = blockhead ? blockhead->size : 0, .large = nlarge
+  };
+  pthread_mutex_unlock (&lock);
+  return m;
+}
+
+void allocator_release ( AllocMark m ) {
+  pthread_mutex_lock (&lock);
+  while ( blockhead && blockhead != m.block ) {
+    Block * next = blockhead->next;
+    free ( blockhead );
+    blockhead = next;
+  }
+  if (blockhead) {
+    blockhead->prev = NULL;
+    blockhead->head = m.head;
+    blockhead->size = m.size;
+  }
+  else
+    bins = NULL;                 /* was in the first block, now freed */
+  while ( largehead && largehead->seq > m.large ) {
+    Large * next = largehead->next;
+    free ( largehead );
+    largehead = next;
+  }
+  if (largehead)
+    largehead->prev = NULL;
+  pthread_mutex_unlock (&lock);
+}
+
 char * allocate_str ( const char * s ) {
   size_t size = strlen (s) + 1;
   char * str  = allocate (size);
@@ -104,9 +208,12 @@ typedef struct Chunk {
 
 void deallocate ( void * m, size_t olds ) {
   /*
-  .. fixme : recover old memory
-  .. Dummy as of now. No recovery, yet.
+  .. fixme : recover old memory from the blocks.
+  .. Only the large objects are freed, as of now.
   */
+  olds = (olds + 7) & ~((size_t) 7);
+  if ( m && olds > PAGE_SIZE )
+    large_free (m);
 }
 
 void * reallocate ( void * m, size_t olds, size_t s ) {
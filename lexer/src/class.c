@@ -57,6 +57,20 @@ void class_get ( int ** c, int * n ) {
   *c = class; *n = nclass + BCLASSES;
 }
 
+void class_save ( ClassSave * s ) {
+  memcpy (s->class, class, sizeof (class));
+  memcpy (s->next,  next,  sizeof (next));
+  memcpy (s->head,  head,  sizeof (head));
+  s->nclass = nclass;
+}
+
+void class_restore ( const ClassSave * s ) {
+  memcpy (class, s->class, sizeof (class));
+  memcpy (next,  s->next,  sizeof (next));
+  memcpy (head,  s->head,  sizeof (head));
+  nclass = s->nclass;
+}
+
 #define END  -1
 void class_init () {
 
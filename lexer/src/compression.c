@@ -4,10 +4,13 @@
 #include <stdio.h>
 #include <string.h>
 #include <assert.h>
+#include <pthread.h>
 
 #include "allocator.h"
 #include "compression.h"
 #include "regex.h"
+#include "bits.h"
+#include "class.h"
 
 /* ...................................................................
 .. ...................................................................
@@ -17,12 +20,14 @@
 #define PARENT_THRESHOLD     0.7
 #define CHILD_THRESHOLD      0.9
 #define SMALL_THRESHOLD      5
+#define WINDOW               16    /* num of rows looked for a parent */
 #define EMPTY                -1
 #define DEADSTATE            0
-#define MAXDEPTH             1
+#define MAXTEMPLATES         64
+#define TEMPLATE_MIN         3       /* min number of rows to template */
 
 /*
-.. A row is a cache corresponding to a state 's', which stores a 
+.. A row is a cache corresponding to a state 's', which stores a
 .. cache of (c, δ (s,c)) where the transition δ (s,c) is not a DEAD
 .. state.
 ..    cache(s) := { (c, δ (s,c)) | δ (s,c) ≠ DEAD }
@@ -35,85 +40,178 @@ typedef struct Delta {
   int c, delta;
 } Delta;
 
-static int * check;                                  /* check array */
-static int * next;                                    /* next array */
-static int * base;                                    /* base array */
-static int * def;
 static int nclass;                          /* number of eq classes */
 static int nstates;                             /* number of states */
-static int limit;                 /* allocated size of check & next */
+
+/*
+.. Maximum number of fallbacks via def [] in a transition lookup.
+.. 0 : no fallback. Each row is stored with all it's transitions,
+..     so a transition is a single lookup. (largest, fastest)
+.. 1 : (default) a row may fall back to one row that is already added.
+.. 2 or more : def [] chains of that length and template rows indexed
+..     by meta classes. (smallest, slowest)
+*/
+static int maxdepth = 1;
+
+void rgx_table_depth ( int depth ) {
+  maxdepth = depth < 0 ? 0 : depth;
+}
+
+/*
+.. Parameters of the heuristics of the packing (refer
+.. rows_compression ()). "order" selects the comparison function used
+.. to sort the rows, and "twopass" enables the second pass.
+*/
+typedef struct Heuristic {
+  double parent, child;
+  int small, window, twopass, order;
+} Heuristic;
+
+static const Heuristic heuristic = {
+  PARENT_THRESHOLD, CHILD_THRESHOLD, SMALL_THRESHOLD, WINDOW, 1, 0
+};
+
+/*
+.. A packing of the rows into check[] & next[]. Each packing has it's
+.. own tables, so that packings with different heuristics can run in
+.. parallel (refer rgx_table_optimize ()).
+..
+.. used : Occupancy bitmap of check[], i.e bit i is set iff check[i]
+..   ≠ EMPTY, so that a row can be tested against 64 slots of check[]
+..   at a time.
+.. firstfree : a hint, check[i] ≠ EMPTY for all i < firstfree.
+.. template, tlen : templates and their number of entries.
+*/
+typedef struct Packer {
+  Heuristic h;
+  Row ** rows;
+  int * check, * next, * base, * def, * meta;
+  uint64_t * used;
+  int limit, k0, firstfree, size;
+  Delta * template [MAXTEMPLATES];
+  int tlen [MAXTEMPLATES], ntemplates, nmeta;
+} Packer;
+
+#define USEDBYTES(_k)     ( BITBYTES (_k) + sizeof (uint64_t) )
+#define ROWWORDS          8                /* nclass ≤ 256 + BCLASSES */
+
+/*
+.. Transition δ (s,c) as looked up at runtime (refer tokenize.c), i.e
+.. fall back to def [s] for atmost "hops" times. Templates (s > nstates)
+.. are indexed by the meta class. Returns EMPTY for a DEAD transition
+*/
+static inline
+int lookup ( Packer * p, int s, int c, int hops ) {
+  while (s != EMPTY) {
+    int k = p->base [s] + (s > nstates ? p->meta [c] : c);
+    if ( p->check [k] == s )
+      return p->next [k];
+    if ( hops-- == 0 )
+      break;
+    s = p->def [s];
+  }
+  return EMPTY;
+}
 
 /*
 .. For a candidate state 'ps' which is already added to check[], see
-.. the number of exact transitions (c, δ (s,c)), not found in the
-.. candidate's
+.. the transitions (c, δ (s,c)), (including DEAD transitions) which
+.. differ from that looked up via 'ps' (with one fallback less).
 */
 static inline
-int row_candidate ( Row * r, int ps, Delta residual [] ) {
-  int n = 0, i = r->n, c = nclass-1, 
-    * chk = & check [base [ps]],
-    * nxt = & next [base [ps]];
+int row_candidate ( Packer * p, Row * r, int ps, Delta residual [] ) {
+  int n = 0, i = r->n - 1;
   Delta * a = (Delta *) r->stack;
-  while ( i-- >= 0) {
-    int min = i >= 0 ? a[i].c : -1;
-    while (c > min) {
-      int _s = ps, depth = 1;
-
-      while (_s != EMPTY && check [base [_s]+c] != _s &&
-        /* This will work only if MAXDEPTH > 1*/
-        depth++ < MAXDEPTH ) 
-          _s = def [_s]; 
-
-      if ( _s != EMPTY && 
-        check [base [_s]+c] == _s &&
-        next [base [_s]+c] != EMPTY )
-          residual [n++] = (Delta) {c, EMPTY};
-
-      c--;
-    }
-    if (i < 0) break;
-    if ( chk [c] != ps || nxt [c] != a[i].delta )
-      residual [n++] = a [i];
-    c--;
+  for (int c = nclass-1; c >= 0; --c) {
+    int delta = (i >= 0 && a[i].c == c) ? a[i--].delta : EMPTY;
+    if ( lookup (p, ps, c, maxdepth - 1) != delta )
+      residual [n++] = (Delta) {c, delta};
   }
   return n;                                    /* size of residual. */
 }
 
 /*
-.. Look for a slot to insert a cache of (c, δ (s,c))
+.. See if the row bitmap "row" (of "nw" words) placed at "offset"
+.. doesn't collide with any occupied slot of check[]
+*/
+static inline
+int row_fits ( Packer * p, uint64_t * row, int nw, int offset ) {
+  int w = offset >> 6, b = offset & 63;
+  for (int k=0; k<nw; ++k) {
+    if ( p->used [w+k] & (row [k] << b) )
+      return 0;
+    if ( b && (p->used [w+k+1] & (row [k] >> (64 - b))) )
+      return 0;
+  }
+  return 1;
+}
+
+/*
+.. Look for a slot to insert a cache of (c, δ (s,c)). Returns the
+.. lowest offset, where all the entries fit. Offsets, for which the
+.. smallest class "cmin" of the cache falls on an occupied slot, are
+.. skipped by scanning the bitmap for the next free slot.
 */
 static
-int find_slot ( Delta residual [], int nr ) {
-  for (int offset=0; offset<=limit - nclass; ++offset) {
-    int n = nr;
-    while (n--)
-      if ( check [offset + residual [n].c] != EMPTY )
-        break; 
-    if (n >= 0) continue;
-    return offset;
+int find_slot ( Packer * p, Delta residual [], int nr ) {
+  uint64_t row [ROWWORDS], slots, * used = p->used;
+  int nw = (nclass + 63) >> 6, cmin = nclass, c, limit = p->limit,
+    nwords = BITBYTES (limit) >> 3;
+  memset (row, 0, sizeof (row));
+  for (int n=0; n<nr; ++n) {
+    c = residual [n].c;
+    BITINSERT (row, c);
+    if (c < cmin) cmin = c;
+  }
+
+  int offset = p->firstfree > cmin ? p->firstfree - cmin : 0;
+  for (; offset<=limit - nclass; ++offset) {
+    int i = offset + cmin, w = i >> 6;
+    slots = ~used [w] & (~(uint64_t) 0 << (i & 63));
+    while ( !slots && ++w < nwords )
+      slots = ~used [w];
+    if ( !slots )
+      break;
+    offset = (w << 6) + __builtin_ctzll (slots) - cmin;
+    if ( offset > limit - nclass )
+      break;
+    if ( row_fits (p, row, nw, offset) )
+      return offset;
   }
   return EMPTY;
 }
 
 /*
-.. Insert a row to check[] ( and corresponndingly to next []),
-.. given a parent candidate 'ps' (which may be empty)
+.. Place the entries "res" of the state 's' in the first slot, where
+.. all of them fit.
 */
 static
-int row_insert ( Row * r, int ps, Delta residual [] ) {
-  Delta * res = (ps != EMPTY) ? residual : (Delta *) r->stack;
-  int s = r->s, nr = (ps != EMPTY) ? 
-    row_candidate (r, ps, residual) : r->n;
+int row_place ( Packer * p, int s, Delta res [], int nr ) {
   if (!nr)
-    return (base [s] = 0);
-  int offset = find_slot (res, nr);
+    return (p->base [s] = 0);
+  int offset = find_slot (p, res, nr);
   if ( offset == EMPTY ) return RGXERR;
   int n = nr;
   while (n--) {
-    check [offset + res [n].c] = s;
-    next [offset + res [n].c] = res [n].delta;
+    p->check [offset + res [n].c] = s;
+    p->next [offset + res [n].c] = res [n].delta;
+    BITINSERT (p->used, offset + res [n].c);
   }
-  return (base[s] = offset);
+  while ( p->firstfree < p->limit && BITLOOKUP (p->used, p->firstfree) )
+    p->firstfree++;
+  return (p->base[s] = offset);
+}
+
+/*
+.. Insert a row to check[] ( and corresponndingly to next []),
+.. given a parent candidate 'ps' (which may be empty)
+*/
+static
+int row_insert ( Packer * p, Row * r, int ps, Delta residual [] ) {
+  if (ps == EMPTY)
+    return row_place (p, r->s, (Delta *) r->stack, r->n);
+  return row_place (p, r->s, residual,
+    row_candidate (p, r, ps, residual));
 }
 
 /*
@@ -122,7 +220,7 @@ int row_insert ( Row * r, int ps, Delta residual [] ) {
 static inline
 int row_similarity ( Row * r, Row * c ) {
   int n = 0;
-  Delta * a = (Delta *) r->stack, 
+  Delta * a = (Delta *) r->stack,
     * b = (Delta *) c->stack;
   int i = r->n-1, j = c->n-1;
   while ( i>=0 && j>=0 ) {
@@ -164,29 +262,195 @@ int row_similarity ( Row * r, Row * c ) {
 .. on greedy heauristic algorithm.
 */
 
+#define CMP(p,q) cmp = ((int) (p > q) - (int) (p < q));              \
+  if (cmp) return cmp
+
 static int compare ( const void * a, const void * b ) {
-  #define CMP(p,q) cmp = ((int) (p > q) - (int) (p < q));            \
-    if (cmp) return cmp
   Row * r = *((Row **)a), * s = *((Row **)b);
   int cmp;                  /* sort by                              */
   CMP (r->n, s->n);         /* number of transitions (decreasing)   */
   CMP (s->hash, r->hash);   /* Compare signature                    */
   CMP (s->s, r->s);         /* state id (lowest preferred)          */
   return 0;
-  #undef CMP
 }
 
-static int resize (int k0) {
+static int compare_state ( const void * a, const void * b ) {
+  Row * r = *((Row **)a), * s = *((Row **)b);
+  int cmp;
+  CMP (r->n, s->n);         /* number of transitions                */
+  CMP (s->s, r->s);         /* state id                             */
+  return 0;
+}
+
+static int compare_token ( const void * a, const void * b ) {
+  Row * r = *((Row **)a), * s = *((Row **)b);
+  int cmp;
+  CMP (r->n, s->n);         /* number of transitions                */
+  CMP (r->token, s->token); /* accepted token                       */
+  CMP (s->hash, r->hash);   /* signature                            */
+  CMP (s->s, r->s);         /* state id                             */
+  return 0;
+}
+#undef CMP
+
+static int (* const orders [])( const void *, const void * ) = {
+  compare, compare_state, compare_token
+};
+#define NORDERS ( sizeof (orders) / sizeof (orders[0]) )
+
+/*
+.. Grow check[] & next[] by k0 entries. k0 is doubled each time, so
+.. that the cost of copying is linear in the final table size.
+*/
+static int resize ( Packer * p ) {
+  int limit = p->limit, k0 = p->k0;
+  if ( limit > INT_MAX / 2 / sizeof (int) ) return RGXOOM;
   int sold = limit * sizeof (int), s = sold + k0 * sizeof(int);
-  if (s > PAGE_SIZE) return RGXOOM;
-  check = reallocate (check, sold, s);
-  next = reallocate (next, sold, s);
-  memset (& check [limit], EMPTY, s - sold);
-  limit += k0;
+  p->check = reallocate (p->check, sold, s);
+  p->next = reallocate (p->next, sold, s);
+  memset (& p->check [limit], EMPTY, s - sold);
+  p->used = reallocate (p->used, USEDBYTES (limit),
+    USEDBYTES (limit + k0));
+  memset ( (char *) p->used + USEDBYTES (limit), 0,
+    USEDBYTES (limit + k0) - USEDBYTES (limit) );
+  p->limit += k0;
+  p->k0 = p->limit;
   return 0;
 }
 
 
+/*
+.. Template rows (as in flex). Rows similar to each other are grouped
+.. into a cluster around the largest row among them. For each class,
+.. the transition shared by a majority of the cluster goes into the
+.. template of the cluster, which is a row that doesn't belong to any
+.. state. Templates are numbered after the states, (nstates, nstates
+.. + ntemplates]. Two classes fall in the same meta class, if they have
+.. the same transition in every template, and templates are indexed by
+.. the meta class (so a template is narrow). A state may fall back to
+.. a template. A template has no fallback.
+*/
+static void templates_create ( Packer * p, int m ) {
+  Row ** rows = p->rows;
+  int nclust = 0, * member = allocate (m * sizeof (int)),
+    * val = allocate (MAXTEMPLATES * nclass * sizeof (int)),
+    * cand = allocate (nclass * sizeof (int)),
+    * count = allocate (nclass * sizeof (int)),
+    * dense = allocate (nclass * sizeof (int)),
+    * rep = allocate (nclass * sizeof (int));
+  Row * seed [MAXTEMPLATES];
+
+  /*
+  .. Rows are sorted by increasing size, so the seeds are the largest
+  */
+  for (int i = m-1; i >= 0; --i) {
+    Row * r = rows [i];
+    int best = EMPTY, max = (int) (PARENT_THRESHOLD * r->n);
+    member [i] = EMPTY;
+    if (r->n <= SMALL_THRESHOLD) continue;
+    for (int k = 0; k < nclust; ++k) {
+      int sim = row_similarity (r, seed [k]);
+      if (sim >= max) { max = sim; best = k; }
+    }
+    if (best == EMPTY && nclust < MAXTEMPLATES)
+      seed [best = nclust++] = r;
+    member [i] = best;
+  }
+
+  /*
+  .. Majority vote (Boyer-Moore) for each class, where DEAD (EMPTY) is
+  .. also a vote. The first pass finds the candidate, and the second
+  .. pass counts it.
+  */
+  #define DENSE(_r)                                                   \
+    for (int c = 0; c < nclass; ++c) dense [c] = EMPTY;               \
+    for (int j = 0; j < (_r)->n; ++j)                                 \
+      dense [((Delta *) (_r)->stack) [j].c] =                         \
+        ((Delta *) (_r)->stack) [j].delta
+
+  int ntemplates = 0;
+  for (int k = 0; k < nclust; ++k) {
+    int nmember = 0, * v = & val [ntemplates * nclass];
+    for (int c = 0; c < nclass; ++c)
+      count [c] = 0;
+    for (int i = 0; i < m; ++i) {
+      if (member [i] != k) continue;
+      nmember++;
+      DENSE (rows [i]);
+      for (int c = 0; c < nclass; ++c) {
+        if (!count [c]) cand [c] = dense [c];
+        count [c] += cand [c] == dense [c] ? 1 : -1;
+      }
+    }
+    if (nmember < TEMPLATE_MIN) continue;
+    for (int c = 0; c < nclass; ++c)
+      count [c] = 0;
+    for (int i = 0; i < m; ++i) {
+      if (member [i] != k) continue;
+      DENSE (rows [i]);
+      for (int c = 0; c < nclass; ++c)
+        count [c] += cand [c] == dense [c];
+    }
+    int nonempty = 0;
+    for (int c = 0; c < nclass; ++c) {
+      v [c] = 2 * count [c] > nmember ? cand [c] : EMPTY;
+      nonempty += v [c] != EMPTY;
+    }
+    if (nonempty) ntemplates++;
+  }
+  #undef DENSE
+
+  /*
+  .. meta classes, and the templates indexed by meta class
+  */
+  int nmeta = 0;
+  for (int c = 0; c < nclass; ++c) {
+    int j = 0;
+    for (; j < nmeta; ++j) {
+      int k = 0;
+      while ( k < ntemplates &&
+        val [k * nclass + c] == val [k * nclass + rep [j]] ) k++;
+      if (k == ntemplates) break;
+    }
+    if (j == nmeta) rep [nmeta++] = c;
+    p->meta [c] = j;
+  }
+  for (int k = 0; k < ntemplates; ++k) {
+    Delta * t = p->template [k] = allocate (nmeta * sizeof (Delta));
+    p->tlen [k] = 0;
+    for (int j = 0; j < nmeta; ++j)
+      if (val [k * nclass + rep [j]] != EMPTY)
+        t [p->tlen [k]++] = (Delta) {j, val [k * nclass + rep [j]]};
+  }
+  p->ntemplates = ntemplates;
+  p->nmeta = nmeta;
+
+  deallocate (member, m * sizeof (int));
+  deallocate (val, MAXTEMPLATES * nclass * sizeof (int));
+  deallocate (cand, nclass * sizeof (int));
+  deallocate (count, nclass * sizeof (int));
+  deallocate (dense, nclass * sizeof (int));
+  deallocate (rep, nclass * sizeof (int));
+}
+
+/*
+.. Add the templates to check[]. Returns the largest offset used.
+*/
+static int templates_insert ( Packer * p ) {
+  int offset = 0;
+  for (int k = 0; k < p->ntemplates; ++k) {
+    int t = nstates + 1 + k, loc;
+    if (offset + 2*nclass > p->limit && resize (p))
+      return RGXOOM;
+    p->def [t] = EMPTY;
+    if ( (loc = row_place (p, t, p->template [k], p->tlen [k]))
+      == RGXERR )
+      return RGXERR;
+    if (loc > offset) offset = loc;
+  }
+  return offset;
+}
+
 #if 0
 void row_print ( Row ** rows) {
   int i = 0; Row * r; while ( (r=rows[i++]) ) {
@@ -201,6 +465,23 @@ void row_print ( Row ** rows) {
 }
 #endif
 
+/*
+.. Free the tables of a packing, except those in "keep" (if not NULL)
+*/
+static void packer_free ( Packer * p, int m, int keep ) {
+  deallocate (p->rows, (m+2)*sizeof (Row*));
+  deallocate (p->used, USEDBYTES (p->limit));
+  for (int k = 0; k < p->ntemplates; ++k)
+    deallocate (p->template [k], p->nmeta * sizeof (Delta));
+  if (keep) return;
+  int size = (m + 1 + p->ntemplates) * sizeof (int);
+  deallocate (p->check, p->limit * sizeof (int));
+  deallocate (p->next, p->limit * sizeof (int));
+  deallocate (p->base, size);
+  deallocate (p->def, size);
+  deallocate (p->meta, nclass * sizeof (int));
+}
+
 /*
 .. It is a heauristic approach. We have some rows of some density and
 .. size and we have to place one row after the other, such that
@@ -219,37 +500,50 @@ void row_print ( Row ** rows) {
 .. So following algorithm uses both technique. First insert few larger
 .. rows. Then other rows are inserted in the order of increasing cache
 .. size, and each time looking for a suitable parent row.
+.. Packs a copy of "rows" (m rows) with the heuristics p->h. Returns
+.. the size of check[] (or an error < 0).
 */
-int rows_compression ( Row ** rows, int *** tables, 
-  int ** tsize, int m, int n )
-{
+static int pack ( Packer * p, Row ** src, int m ) {
 
-  nstates = m, nclass = n;
+  int n = nclass;
   Delta residual [256];
+  Row ** rows = p->rows = allocate ( (m+2) * sizeof (Row *) );
+  memcpy (rows, src, (m+2) * sizeof (Row *));
 
   /*
   .. Sort the rows by increasing number of entries. Group rows with
   .. same signature together. Signature is evaluated from the last and
   .. first entry of cache.
   */
-  qsort (rows, m, sizeof (Row*), compare);
+  qsort (rows, m, sizeof (Row*), orders [p->h.order]);
 
   int k0 = 4 * n;   /* let's start with k=4n & reallocate if needed */
   k0 = 1 << (64 - __builtin_clzll ((unsigned long long)(k0 - 1)) );
-  limit = k0;
+  p->limit = p->k0 = k0;
 
-  check = allocate (limit* sizeof (int));
-  next = allocate (limit * sizeof(int));
-  base = tables [0][2];
-  def  = tables [0][4];
-  int * accept = tables [0][3];
-  #if 0
-  int * meta   = tables [0][5];  /* We don't use meta class for now */
-  #endif
-
-  memset ( check, EMPTY, limit * sizeof (int) );
+  p->check = allocate (p->limit * sizeof (int));
+  p->next = allocate (p->limit * sizeof(int));
+  p->meta = allocate (n * sizeof (int));
+  memset ( p->check, EMPTY, p->limit * sizeof (int) );
+  p->used = allocate ( USEDBYTES (p->limit) );
+  p->firstfree = 0;
+  assert ( nclass <= 64 * ROWWORDS );
 
-  int offset = 0, startindex = 0;
+  /*
+  .. Templates are used only if def [] chains are allowed. base[] and
+  .. def[] are extended for the templates, (m, m + ntemplates].
+  */
+  p->ntemplates = p->nmeta = 0;
+  if (maxdepth > 1)
+    templates_create (p, m);
+  p->base = allocate ((m + 1 + p->ntemplates) * sizeof (int));
+  p->def = allocate ((m + 1 + p->ntemplates) * sizeof (int));
+
+  int offset = templates_insert (p), startindex = 0;
+  if (offset < 0) {
+    error ("Table compression: Out of table size limit %d", p->limit);
+    return RGXOOM;
+  }
   for (int niter = 0; niter < 2; ++niter ) {
 
     if (startindex) {
@@ -260,36 +554,40 @@ int rows_compression ( Row ** rows, int *** tables,
     Row * r;
     for (int irow=0; (r = rows [irow]) != NULL; ++irow ) {
 
-      if (offset + 2*n > limit)   /* resize next[], check[] if reqd */
-        if (resize (k0)) {
+      if (offset + 2*n > p->limit)  /* resize next[], check[] if reqd */
+        if (resize (p)) {
           error ("Table compression: Out of table size limit %d",
-            (int) PAGE_SIZE / sizeof (int));
+            p->limit);
           return RGXOOM;
         }
 
       int s = r->s, jrow = irow - 1, nrows = 0, min = INT_MAX,
         best = EMPTY, queue [2];
       /*
-      .. We look among the rows that are already added, to see if 
+      .. We look among the rows that are already added, to see if
       .. it is a good candidate to be taken as the def[this state].
       .. The best candidate is chosen by minimum of |residual|,
       .. where residual is the set of transitions (c, delta) which are
       .. not found in the cache of candidate.
       */
-      while (jrow >= startindex && nrows++ < 16) {
-        queue [0] = rows [jrow]->s, queue [1] = def [queue [0]];
+      while (maxdepth && jrow >= startindex && nrows++ < p->h.window) {
+        queue [0] = rows [jrow]->s, queue [1] = p->def [queue [0]];
         for (int iq =0; iq < 2 && queue [iq] != EMPTY; ++iq) {
-          int nres = row_candidate ( r, queue [iq], residual );
+          int nres = row_candidate ( p, r, queue [iq], residual );
           if (nres < min) { min = nres; best = queue [iq]; }
         }
         jrow --;
       }
+      for (int k = 0; k < p->ntemplates; ++k) {
+        int nres = row_candidate ( p, r, m + 1 + k, residual );
+        if (nres < min) { min = nres; best = m + 1 + k; }
+      }
 
       if ( best != EMPTY &&
-        ( rows [irow+1] != NULL && r->n > SMALL_THRESHOLD ) &&
-        ( min > (int) ((1.0 - PARENT_THRESHOLD) * r->n) ) &&
-        ( row_similarity (r, rows[irow+1]) > 
-          (int) (CHILD_THRESHOLD* r->n)) ) 
+        ( rows [irow+1] != NULL && r->n > p->h.small ) &&
+        ( min > (int) ((1.0 - p->h.parent) * r->n) ) &&
+        ( row_similarity (r, rows[irow+1]) >
+          (int) (p->h.child * r->n)) )
       {
         /*
         .. After looking for possible parent candidates, we look if
@@ -300,7 +598,6 @@ int rows_compression ( Row ** rows, int *** tables,
         */
         best = EMPTY;
 
-        #if 1
         /*
         .. What we do here is we clear the check and next table, thus
         .. removing the rows in [0, strtindex) out of the table &
@@ -308,22 +605,27 @@ int rows_compression ( Row ** rows, int *** tables,
         .. (niter == 1). Why we do is that because, shorter rows like
         .. that in [0, strtindex) are easier to place in the gaps.
         */
-        if (!niter){
+        if (!niter && p->h.twopass) {
           /* We will insert the rows in [0, strindex) in next itern*/
           startindex = irow;
-          memset (check, EMPTY, (offset + n) * sizeof (int)); 
-          memset (next, 0, (offset + n) * sizeof (int));
+          memset (p->check, EMPTY, (offset + n) * sizeof (int));
+          memset (p->next, 0, (offset + n) * sizeof (int));
+          memset (p->used, 0, USEDBYTES (p->limit));
+          p->firstfree = 0;
+          if ( templates_insert (p) < 0 ) {
+            error ("Table compression: Out of table size limit %d",
+              p->limit);
+            return RGXOOM;
+          }
         }
-        #endif
       }
 
       /*
-      .. We set the def [], and accept [] token of this state
-      .. check[], base[] and next[] will be set inside "row_insert()".
+      .. We set the def [] of this state. check[], base[] and next[]
+      .. will be set inside "row_insert()".
       */
-      def [s] = best;
-      accept [s] = r->token;
-      int loc = row_insert ( r, best, residual );
+      p->def [s] = best;
+      int loc = row_insert ( p, r, best, residual );
       if (loc == RGXERR) {
         error ("table compression : internal error");
         return RGXERR;
@@ -335,16 +637,142 @@ int rows_compression ( Row ** rows, int *** tables,
       break;
   }
 
+  return (p->size = offset + n);
+}
+
+/*
+.. Optional search over the heuristics (thresholds, size of window,
+.. two pass, order of rows) of the packing, by a pool of "nsearch"
+.. threads. The smallest check[] is kept. In case of a tie, the first
+.. in the list of trials, so the result doesn't depend on the number
+.. of threads. Trial 0 is the default heuristic.
+*/
+static int nsearch = 0;
+
+void rgx_table_optimize ( int nthreads ) {
+  nsearch = nthreads < 0 ? 0 : nthreads;
+}
+
+static struct {
+  Heuristic * trial;
+  int ntrial, inext, ibest, m, size0;
+  Row ** rows;
+  Packer best;
+  pthread_mutex_t lock;
+} search;
+
+static void * search_worker ( void * arg ) {
+  for (;;) {
+    pthread_mutex_lock (&search.lock);
+    int i = search.inext++;
+    pthread_mutex_unlock (&search.lock);
+    if (i >= search.ntrial)
+      break;
+
+    Packer p = { .h = search.trial [i] };
+    int size = pack (&p, search.rows, search.m);
+
+    pthread_mutex_lock (&search.lock);
+    if (!i) search.size0 = size;
+    if ( size >= 0 && (search.ibest < 0 || size < search.best.size ||
+      (size == search.best.size && i < search.ibest)) ) {
+      if (search.ibest >= 0)
+        packer_free (&search.best, search.m, 0);
+      search.best = p;
+      search.ibest = i;
+    }
+    else
+      packer_free (&p, search.m, 0);
+    pthread_mutex_unlock (&search.lock);
+  }
+  return NULL;
+}
+
+static int search_heuristics ( Row ** rows, int m, Packer * best ) {
+  const double parent [] = { 0.5, 0.7, 0.9 },
+    child [] = { 0.8, 0.9, 1.01 };
+  const int small [] = { 3, 5, 8 }, window [] = { 8, 16, 64 };
+
+  search.ntrial = 1 + 3 * 3 * 3 * 3 * 2 * NORDERS;
+  search.trial = allocate (search.ntrial * sizeof (Heuristic));
+  search.trial [0] = heuristic;
+  int t = 1;
+  for (int a=0; a<3; ++a) for (int b=0; b<3; ++b)
+  for (int c=0; c<3; ++c) for (int d=0; d<3; ++d)
+  for (int e=0; e<2; ++e) for (int f=0; f<NORDERS; ++f)
+    search.trial [t++] = (Heuristic) {
+      parent [a], child [b], small [c], window [d], e, f
+    };
+
+  search.inext = 0; search.ibest = -1;
+  search.rows = rows; search.m = m;
+  pthread_mutex_init (&search.lock, NULL);
+
+  pthread_t * tid = allocate ( nsearch * sizeof (pthread_t) );
+  int nt = 0;
+  for (; nt < nsearch; ++nt)
+    if ( pthread_create (&tid[nt], NULL, search_worker, NULL) )
+      break;
+  if (!nt)
+    search_worker (NULL);
+  for (int i=0; i<nt; ++i)
+    pthread_join (tid[i], NULL);
+  deallocate (tid, nsearch * sizeof (pthread_t));
+  pthread_mutex_destroy (&search.lock);
+
+  if (search.ibest < 0) {
+    deallocate (search.trial, search.ntrial * sizeof (Heuristic));
+    return RGXERR;
+  }
+
+  Heuristic h = search.trial [search.ibest];
+  int size = search.best.size, size0 = search.size0;
+  printf ("\noptimize tables : %d trials, %d threads"
+    "\n  best : parent %.2f, child %.2f, small %d, window %d, "
+    "%s pass, order %d"
+    "\n  check[] : %d (default %d), %.1f %% smaller\n",
+    search.ntrial, nt ? nt : 1, h.parent, h.child, h.small, h.window,
+    h.twopass ? "two" : "one", h.order,
+    size, size0, size0 > 0 ? 100.0 * (size0 - size) / size0 : 0.0);
+  *best = search.best;
+  deallocate (search.trial, search.ntrial * sizeof (Heuristic));
+  return search.ibest;
+}
 
-  deallocate (rows, (m+1)*sizeof (Row*));
+/*
+.. Pack the rows (refer pack ()) with the default heuristics or, if
+.. rgx_table_optimize () is set, with the best of the heuristics.
+*/
+int rows_compression ( Row ** rows, int *** tables,
+  int ** tsize, int m, int n )
+{
+  nstates = m, nclass = n;
 
-  tsize [0][0] = tsize [0][1] = offset + n;
+  int * accept = tables [0][3];
+  for (int i=0; i<m; ++i)
+    accept [rows [i]->s] = rows [i]->token;
+
+  Packer p = { .h = heuristic };
+  if ( nsearch ? search_heuristics (rows, m, &p) < 0 :
+    pack (&p, rows, m) < 0 )
+    return RGXERR;
+  packer_free (&p, m, 1);
+  deallocate (rows, (m+2)*sizeof (Row*));
+
+  int * check = p.check, * next = p.next, * def = p.def;
+  deallocate (tables [0][2], (m+1) * sizeof (int));
+  deallocate (tables [0][4], (m+1) * sizeof (int));
+  deallocate (tables [0][5], n * sizeof (int));
+  tables [0][2] = p.base;  tables [0][4] = def;  tables [0][5] = p.meta;
+  tsize [0][2] = tsize [0][4] = m + 1 + p.ntemplates;
+
+  tsize [0][0] = tsize [0][1] = p.size;
   tables [0][0] = check;  tables[0][1] = next;
 
   for (int i=0; i<tsize [0][0]; ++i) {
-    if (check [i] == EMPTY) 
+    if (check [i] == EMPTY)
       check [i] = DEADSTATE;
-    if (next [i] == EMPTY) 
+    if (next [i] == EMPTY)
       next [i] = DEADSTATE;
   }
   for (int i=0; i<tsize [0][4]; ++i)
@@ -360,5 +788,227 @@ int rows_compression ( Row ** rows, int *** tables,
   return 0;
 }
 
+
+/* ...................................................................
+.. ...................................................................
+.. ........  Bitmap (popcount) encoding of the transitions ...........
+.. ...................................................................
+.. .................................................................*/
+
+/*
+.. Transition δ (s,c) using the compressed "tables" created with the
+.. def[] chain length "depth" (refer tokenize.c). The number of
+.. fallbacks (i.e loads of def[]) is returned in "hops" (if not NULL).
+*/
+int table_delta ( int ** tables, int * len, int depth, int s, int c,
+  int * hops )
+{
+  int * chk = tables [0], * bs = tables [2], k = c, d = 0;
+  while ( s && chk [bs [s] + k] != s ) {
+    s = (d++ == depth) ? DEADSTATE : tables [4][s];
+    if (s >= len [3]) k = tables [5][c];                /* template */
+  }
+  if (hops) *hops = d > depth ? depth : d;
+  return s ? tables [1][bs [s] + k] : DEADSTATE;
+}
+
+/*
+.. An alternative to the check[]/next[] encoding, when there are not
+.. more than 64 classes. For each state 's' in [0, len[3]),
+..   bmap [s]   : bit c is set iff δ (s,c) ≠ DEAD,
+..   offset [s] : index of the first live transition of 's' in target[]
+.. and the transition is
+..   δ (s,c) = target [offset [s] + popcount (bmap [s] & (2^c - 1))]
+.. if the bit c of bmap [s] is set, and DEAD otherwise. So there are
+.. neither check comparisons nor def[] chains. The transitions are
+.. read from the compressed "tables" created with the def[] chain
+.. length "depth". Returns the size of target[].
+*/
+int dfa_bitmap ( int ** tables, int * len, int depth,
+  uint64_t ** bmap, int ** offset, int ** target )
+{
+  int nc = len [5], m = len [3], ntarget = 0, max = 64;
+  if (nc > 64) {
+    error ("bitmap tables : more than 64 classes");
+    return RGXERR;
+  }
+
+  uint64_t * b = allocate (m * sizeof (uint64_t));
+  int * o = allocate (m * sizeof (int)),
+    * t = allocate (max * sizeof (int));
+  for (int s = 0; s < m; ++s) {
+    o [s] = ntarget;
+    for (int c = 0; c < nc; ++c) {
+      int q = table_delta (tables, len, depth, s, c, NULL);
+      if (!q)
+        continue;
+      if (ntarget == max) {
+        t = reallocate (t, max * sizeof (int), 2 * max * sizeof (int));
+        max *= 2;
+      }
+      b [s] |= (uint64_t) 1 << c;
+      t [ntarget++] = q;
+    }
+  }
+
+  *bmap = b; *offset = o; *target = t;
+  return ntarget;
+}
+
+/*
+.. Two byte stride. For the states of long tokens (identifiers, numbers,
+.. string bodies ..), i.e states with a transition to itself and not
+.. more than PAIRTARGETS distinct live targets, a pair of transitions
+..   q = δ (s,c1), r = δ (q,c2)
+.. is read by a single lookup. The classes are grouped into "pair
+.. classes", such that the classes of a pair class have the same
+.. transitions from each of these states and their targets. So,
+..   pclass [c]  : pair class of "c" in [1, npclass). 0 for the special
+..                 classes (EOB/EOL/EOF/BOL), which are never paired.
+..   pidx [s]    : 0, or 1 + the index 'k' of the pair table of "s"
+..   pair [2*((k*npclass + p1)*npclass + p2)] : q and r
+.. A pair with a DEAD q or r is stored as r = 0, so that the scanner
+.. falls back to single steps for the last bytes of a token. States
+.. are added (fewest targets first), as long as there are not more
+.. than PAIRCLASSES pair classes. Returns the number of pair tables.
+*/
+#define PAIRTARGETS  4
+#define PAIRCLASSES 16
+#define PAIRSTATES  64
+
+/* refine the pair classes "pc" with the transitions of state "t" */
+static int pair_refine ( int * d, int nc, int t, int * pc, int * key ) {
+  int np = 1;
+  for (int c = 0; c < nc; ++c) {
+    if (!pc [c]) continue;
+    int k = 1;
+    while ( k < np && !(key [2*k] == pc [c] &&
+      key [2*k+1] == d [t*nc + c]) ) k++;
+    if (k == np) {
+      key [2*k] = pc [c]; key [2*k+1] = d [t*nc + c]; np++;
+    }
+    pc [c] = k;
+  }
+  return np;
+}
+
+int dfa_pairs ( int ** tables, int * len, int depth, int ** pclass,
+  int ** pidx, int ** pair, int * npclass )
+{
+  int nc = len [5], m = len [3], nstates = 0, np = 2;
+  int * d = allocate (m * nc * sizeof (int)),
+    * order = allocate (m * sizeof (int)),
+    * ntarget = allocate (m * sizeof (int)),
+    * inT = allocate (m * sizeof (int)),
+    * pc = allocate (nc * sizeof (int)),
+    * old = allocate (nc * sizeof (int)),
+    * key = allocate (2 * (nc + 1) * sizeof (int)),
+    * idx = allocate (m * sizeof (int)),
+    * added = allocate ((nc + 1) * sizeof (int)),
+    * rep = allocate (nc * sizeof (int));
+
+  for (int s = 0; s < m; ++s)
+    for (int c = 0; c < nc; ++c)
+      d [s*nc + c] = table_delta (tables, len, depth, s, c, NULL);
+
+  /* candidates : self loop by an ordinary class, few live targets */
+  int ncand = 0;
+  for (int s = 1; s < m; ++s) {
+    int loop = 0, n = 0;
+    for (int c = 0; c < nc; ++c) {
+      int q = d [s*nc + c], j = 0;
+      if (!q) continue;
+      if (q == s && c < nc - BCLASSES) loop = 1;
+      while (j < c && d [s*nc + j] != q) j++;
+      n += (j == c);
+    }
+    if (loop && n <= PAIRTARGETS) {
+      ntarget [s] = n;
+      order [ncand++] = s;
+    }
+  }
+  for (int i = 1; i < ncand; ++i) {         /* fewest targets first */
+    int s = order [i], j = i;
+    while (j && ntarget [order [j-1]] > ntarget [s]) {
+      order [j] = order [j-1]; j--;
+    }
+    order [j] = s;
+  }
+
+  for (int c = 0; c < nc; ++c)
+    pc [c] = c < nc - BCLASSES;
+  for (int i = 0; i < ncand && nstates < PAIRSTATES; ++i) {
+    int s = order [i], nadd = 0, n = np;
+    memcpy (old, pc, nc * sizeof (int));
+    if (!inT [s]) inT [added [nadd++] = s] = 1;
+    for (int c = 0; c < nc - BCLASSES; ++c) {
+      int q = d [s*nc + c];
+      if (q && !inT [q]) inT [added [nadd++] = q] = 1;
+    }
+    for (int j = 0; j < nadd; ++j)
+      n = pair_refine (d, nc, added [j], pc, key);
+    if (n > PAIRCLASSES) {                                   /* undo */
+      memcpy (pc, old, nc * sizeof (int));
+      for (int j = 0; j < nadd; ++j) inT [added [j]] = 0;
+      continue;
+    }
+    np = n;
+    idx [s] = ++nstates;
+  }
+
+  for (int c = nc - 1; c >= 0; --c)
+    rep [pc [c]] = c;
+  int * p = allocate ((2 * nstates * np * np + 1) * sizeof (int));
+  for (int s = 1; s < m; ++s) {
+    if (!idx [s]) continue;
+    int * t = p + 2 * (idx [s] - 1) * np * np;
+    for (int p1 = 1; p1 < np; ++p1)
+      for (int p2 = 1; p2 < np; ++p2) {
+        int q = d [s*nc + rep [p1]],
+          r = q ? d [q*nc + rep [p2]] : DEADSTATE;
+        t [2*(p1*np + p2)] = q;
+        t [2*(p1*np + p2) + 1] = r;
+      }
+  }
+
+  deallocate (d, m * nc * sizeof (int));
+  deallocate (order, m * sizeof (int));
+  deallocate (ntarget, m * sizeof (int));
+  deallocate (inT, m * sizeof (int));
+  deallocate (old, nc * sizeof (int));
+  deallocate (key, 2 * (nc + 1) * sizeof (int));
+  deallocate (added, (nc + 1) * sizeof (int));
+  deallocate (rep, nc * sizeof (int));
+
+  *pclass = pc; *pidx = idx; *pair = p; *npclass = np;
+  return nstates;
+}
+
+#undef PAIRTARGETS
+#undef PAIRCLASSES
+#undef PAIRSTATES
+
+/*
+.. Token accepted by each state 's' in [0, len[3]), if the position
+.. after it is an end of line (i.e before '\n' or EOF) :
+.. accept [δ (s, EOL)] if it's not 0 and has precedence over (i.e is
+.. lower than) accept [s], or else accept [s]. So the scanner doesn't
+.. have to follow the EOL transition while backtracking. Returns the
+.. array in "eolaccept".
+*/
+int dfa_eol_accept ( int ** tables, int * len, int depth,
+  int ** eolaccept )
+{
+  int m = len [3], nclass = len [5], * acc = tables [3],
+    * e = allocate (m * sizeof (int));
+  for (int s = 0; s < m; ++s) {
+    int q = s ? table_delta (tables, len, depth, s, EOL_CLASS, NULL) :
+      DEADSTATE, t = q ? acc [q] : 0;
+    e [s] = ( t && (!acc [s] || t < acc [s]) ) ? t : acc [s];
+  }
+  *eolaccept = e;
+  return m;
+}
+
 #undef EMPTY
 #undef DEADSTATE
@@ -72,6 +72,20 @@ int rgx_rpn_print ( int * rpn ) {
           assert (PUSH(inode) >= 0); inode++;
           break;
 
+        case '(' :                     /* group k, refer rgx_rpn () */
+          assert (rpn[0] >= 0 && rpn[1] >= 0);
+          e1 = POP(stack);
+          assert(e1>=0);
+          printf ( "\n\t\033[1;32m[%2d] =", inode - 512);
+          if (e1>=512)
+            printf (" \033[1;31m[%2d]", e1-512);
+          else
+            printf (" \033[1;31m  %c ", e1);
+          printf (" \033[1;32m(%d)", rpn[0]);
+          rpn += 2;
+          assert (PUSH(inode) >= 0); inode++;
+          break;
+
         default:
       }
     }
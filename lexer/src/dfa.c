@@ -2,6 +2,8 @@
 #include <stdio.h>
 #include <string.h>
 #include <assert.h>
+#include <pthread.h>
+#include <time.h>
 
 #include "nfa.h"
 #include "class.h"
@@ -9,6 +11,7 @@
 #include "allocator.h"
 #include "stack.h"
 #include "bits.h"
+#include "position.h"
 
 /*
 .. Functions and objects required for creating a
@@ -27,22 +30,172 @@ typedef struct DState {
 static DState ** states = NULL;               /* list of dfa states */
 static int       nstates = 0;              /* Number of Dfa states. */
 static DState ** htable  = NULL;                /* Uses a hashtable */
-static int       hsize;                /* fixme : use prime numbers */
+static int       hsize;            /* RGXSTRIPES x a prime number */
+static int       hcount;                /* number of entries in htable */
 static int       stacksize;    /* bit stack size rounded to 8 bytes */
 static int     * class = NULL;
 static int       nclass = 0;
 
+/*
+.. The objects above (and those of class.c, nfa.c and position.c) are
+.. shared by every regex being compiled. So the compilers of the self
+.. contained objects (RgxProg, RgxSet, RgxLazy, and the programs of
+.. rgx_match ()) are serialised by "compiling". Matching with those
+.. objects doesn't touch any of them, and runs concurrently.
+*/
+static pthread_mutex_t compiling = PTHREAD_MUTEX_INITIALIZER;
+
+/*
+.. Optional parallel subset construction. "nthreads" workers drain
+.. the worklist of dfa states and insert new states to the hashtable.
+.. Buckets of the hashtable are guarded by a set of striped locks.
+*/
+#ifndef RGXSTRIPES
+  #define RGXSTRIPES 64
+#endif
+static int             nthreads = 1;
+static int             striped  = 0;    /* use the locks in state() */
+static pthread_mutex_t stripe [RGXSTRIPES];
+
+void rgx_dfa_threads ( int n ) {
+  nthreads = n < 1 ? 1 : n;
+}
+
+/*
+.. The sets of nfa states of the dfa states are created either from
+.. the Thompson NFA (nfa.c) or directly from the positions of each
+.. regex (position.c), which has no ε-states.
+*/
+static int positions = 0;
+static struct {
+  int (* create)     ( char *, State **, int );
+  int (* start)      ( State *, Stack *, State *** );
+  int (* transition) ( Stack *, Stack *, State ***, int, Stack * );
+} automaton = { rgx_nfa, states_at_start, states_transition_r };
+
+void rgx_dfa_positions ( int on ) {
+  positions = on;
+}
+
+/*
+.. Size of the automaton (number of nfa states or positions), and the
+.. time & memory used in creating the dfa from it. Reported in stats
+*/
+static struct {
+  int nnfa, pruned;
+  double ms;
+  size_t bytes;
+} construction;
+
+static void automaton_reset ( ) {
+  if (positions) {
+    automaton.create     = rgx_positions;
+    automaton.start      = positions_at_start;
+    automaton.transition = positions_transition_r;
+    positions_reset ();
+    return;
+  }
+  automaton.create     = rgx_nfa;
+  automaton.start      = states_at_start;
+  automaton.transition = states_transition_r;
+}
+
+/*
+.. The nfa list of a new dfa state is sorted by nfa id and duplicates
+.. are removed. So the list (and hence the order in which rgx_dfa_tree
+.. () visits the dfa states) depends only on the set of nfa states and
+.. not on which transition created the dfa state first.
+*/
+static int ist_cmp ( const void * a, const void * b ) {
+  int p = (*(State **) a)->ist, q = (*(State **) b)->ist;
+  return (p > q) - (p < q);
+}
+
+static void list_sort ( Stack * list ) {
+  State ** s = (State **) list->stack;
+  int n = list->len / sizeof (void *), k = 0;
+  qsort (s, n, sizeof (State *), ist_cmp);
+  for (int i=0; i<n; ++i)
+    if (!k || s[k-1] != s[i])
+      s [k++] = s[i];
+  list->nentries = k;
+  list->len = k * sizeof (void *);
+}
+
+/*
+.. Labels of the transitions from a dfa state. Refer labels_next ()
+*/
+#define LABELS(_d_)                                                  \
+  ( (Labels) { (State **) (_d_)->list->stack,                        \
+    (int) ((_d_)->list->len / sizeof (void *)), -1 } )
+
+/*
+.. Smallest prime > n
+*/
+static int prime_above ( int n ) {
+  for (int p = n + 1; ; ++p) {
+    int k = 2;
+    while ( k * k <= p && p % k ) k++;
+    if ( k * k > p ) return p;
+  }
+}
+
+/*
+.. hsize is kept a multiple of RGXSTRIPES, so that a bucket is always
+.. guarded by the same stripe (hash % RGXSTRIPES), even after growing
+.. the hashtable. It's grown to twice it's size once the load factor
+.. exceeds 2. In case of the parallel construction, all the stripes
+.. are locked (in order) before rehashing, as the bucket of a key
+.. depends on hsize. The caller shouldn't hold any stripe.
+*/
+static int htable_size ( int n ) {
+  return RGXSTRIPES * prime_above (n / RGXSTRIPES);
+}
+
+static void htable_grow ( ) {
+  if (striped)
+    for (int i=0; i<RGXSTRIPES; ++i)
+      pthread_mutex_lock (&stripe[i]);
+  if (hcount > 2 * hsize) {
+    int nsize = htable_size (2 * hsize);
+    DState ** t = allocate ( nsize * sizeof (DState *) ), * d, * next;
+    for (int i=0; i<hsize; ++i)
+      for (d = htable [i]; d; d = next) {
+        next = d->hchain;
+        d->hchain = t [d->hash % nsize];
+        t [d->hash % nsize] = d;
+      }
+    deallocate (htable, hsize * sizeof (DState *));
+    htable = t;
+    hsize = nsize;
+  }
+  if (striped)
+    for (int i=RGXSTRIPES-1; i>=0; --i)
+      pthread_mutex_unlock (&stripe[i]);
+}
+
+/*
+.. The hash is over the "stacksize" bytes of the bit set, and not the
+.. capacity of "bits" (a pooled stack may be larger), so that equal
+.. sets always fall in the same bucket, whichever stack is used.
+*/
 static DState * state ( Stack * list, Stack * bits, int * exists) {
   states_bstack (list, bits);
-  uint32_t hash = stack_hash ((uint32_t *) bits->stack, bits->max);
+  uint32_t hash = stack_hash ((uint32_t *) bits->stack, stacksize);
+  pthread_mutex_t * lock = striped ?
+    & stripe [ hash % RGXSTRIPES ] : NULL;
+  if (lock) pthread_mutex_lock (lock);
   DState ** ptr = & htable [hash % hsize], * d;
   *exists = 1;
   while ( (d = *ptr) != NULL ) {          /* resolve hash collision */
-    if (d->hash == hash && !stack_cmp (bits, d->bits))
+    if (d->hash == hash && !stack_cmp (bits, d->bits)) {
+      if (lock) pthread_mutex_unlock (lock);
       return d;
+    }
     ptr = & d->hchain;
   }
   *exists = 0;
+  list_sort (list);
   d = allocate ( sizeof (DState) );
   *d = (DState) {
     .next = allocate ( nclass * sizeof (DState *)),
@@ -51,28 +204,31 @@ static DState * state ( Stack * list, Stack * bits, int * exists) {
     .list = stack_copy ( list ),
     .bits = stack_copy ( bits )
   };
-  return (*ptr = d);
+  *ptr = d;
+  int grow = __atomic_add_fetch (&hcount, 1, __ATOMIC_RELAXED) > 2*hsize;
+  if (lock) pthread_mutex_unlock (lock);
+  if (grow)
+    htable_grow ();
+  return d;
 }
 
 static DState * dfa_root ( State * nfa, int nnfa ) {
 
+  stacksize = BITBYTES (nnfa);        /* rounded as 64 bits multiple*/
   Stack * list = stack_new (0);
   Stack * bits = stack_new (stacksize);
   #define RTN(r) stack_free (list); stack_free (bits); return r
 
   State ** buff[RGXSIZE];
-  int status = states_at_start ( nfa, list, buff );
+  int status = automaton.start ( nfa, list, buff );
 
   if (status < 0) { RTN (NULL); }
 
   nstates = 0;                   /* fixme : Cleaned previous nodes? */
-  int n = 6, exists, primes[] = /* prime > 2^N for N in { 6, 7, .. }*/
-    { 67, 131, 257, 521, 1031, 2053, 4099, 8209, 16411 };
-  while ((1<<n) < nnfa) n++;
-  stacksize = BITBYTES (nnfa);        /* rounded as 64 bits multiple*/
-  hsize = primes[ n - 6 ];
-  while (hsize * sizeof (void *) > PAGE_SIZE)       /* memory limit */
-    hsize = primes[ --n - 6 ];
+  int n = 6, exists;
+  while ((1<<n) < nnfa && n < 14) n++;   /* grows later, if needed */
+  hsize = htable_size (1 << n);
+  hcount = 0;
   htable = allocate ( hsize * sizeof (State *) );
   DState * root = state (list, bits, &exists);
   RTN (root);
@@ -94,55 +250,52 @@ static DState * dfa_root ( State * nfa, int nnfa ) {
 */
 static int
 rgx_dfa_tree ( DState * root, Stack ** Qptr ) {
-  #define RTN(r)  stack_free (list); stack_free (bits);              \
+  #define RTN(r)  stack_free (list); stack_free (bits); free (stack); \
     if (r<0) stack_free (Q); else *Qptr = Q;                         \
     return r
 
   DState * dfa;
-  int c, exists = 0;
+  int c, exists = 0, max = RGXSIZE;
   struct tree {
-    DState * d; State ** s; int n;
-  } stack [ RGXSIZE ];
-  State ** buff[RGXSIZE], *s;
+    DState * d; Labels l;
+  } * stack = malloc ( max * sizeof (struct tree) ), * more;
+  State ** buff[RGXSIZE];
   Stack * list = stack_new (0),
     * bits = stack_new (stacksize),
     * Q = stack_new(0);                   /* Q   : set of DFA nodes */
 
-  stack[0] = (struct tree) {
-    root, (State **) root->list->stack,
-    root->list->len / sizeof (void *)
-  };
+  stack[0] = (struct tree) { root, LABELS (root) };
   int state_id = 0, n = 1;                     /* Depth of the tree */
   while (n) {
 
     /*
     .. Go down the tree if 'next' dfa node is a newly created node
     */
-    while ((s = stack[n-1].n ? stack[n-1].s[--stack[n-1].n] : NULL)) {
-                                   /* iterate each nfa of dfa cache */
+    while ( (c = labels_next (&stack[n-1].l)) >= 0 ) {
+                         /* iterate each label of nfa of dfa cache */
       dfa = stack[n-1].d;
-      c = s->id;
       if (c >= 256 || dfa->next[c] ) continue;
 
-      if (states_transition (dfa->list, list, buff, c) < 0) {
+      if (automaton.transition (dfa->list, list, buff, c, NULL) < 0) {
           RTN (RGXERR);
       }
       dfa->next[c] = state (list, bits, &exists);
       if (!exists) {     /* 'dfa' was recently pushed to hash table */
         dfa = dfa->next[c];
-        if (n == RGXSIZE) { RTN (RGXOOM); }
+        if (n == max) {    /* long chains of dfa, like that of x{m} */
+          more = realloc (stack, (max *= 2) * sizeof (struct tree));
+          if (!more) { RTN (RGXOOM); }
+          stack = more;
+        }
         stack[n++] = (struct tree) {   /* PUSH() & go down the tree */
-          dfa, (State **) dfa->list->stack,
-          dfa->list->len / sizeof (void *)
+          dfa, LABELS (dfa)
         };
       }
     }
 
-    do {
-      dfa = stack[--n].d; /* Pop a dfa from stack, add the dfa to Q */
-      dfa->i = state_id++;
-      stack_push (Q, dfa);                     /* Set of all states */
-    } while ( n && !stack[n-1].n );
+    dfa = stack[--n].d;   /* Pop a dfa from stack, add the dfa to Q */
+    dfa->i = state_id++;
+    stack_push (Q, dfa);                       /* Set of all states */
   }
 
   states = (DState **) Q->stack;
@@ -151,36 +304,211 @@ rgx_dfa_tree ( DState * root, Stack ** Qptr ) {
   #undef RTN
 }
 
-  #define POP(B)          ( B->len == 0 ? NULL :                     \
-    ((uint64_t **) B->stack)                                         \
-    [ (B->len -= sizeof (void *))/sizeof(void *) ] )
-  #define PUSH(S,B)       stack_push (S, B)
-  #define FREE(B,s)       BITCLEAR (B,s); PUSH (pool, B)
-  #define BSTACK(B)       uint64_t * B =                             \
-    pool->len ? POP(pool) : allocate (qsize)
-  #define STACK(S)        Stack * S = stack_new (0)
-  #define COPY(S)                                                    \
-    memcpy ( allocate (qsize), S, qsize )
+/*
+.. Parallel version of rgx_dfa_tree (). Worker threads pop a dfa state
+.. from the shared worklist, evaluate all its transitions and push the
+.. newly created dfa states back to the worklist. The set of dfa states
+.. and the transitions are the same as that of rgx_dfa_tree (), but the
+.. order in which states are discovered is not. So the numbering "i"
+.. is restored afterwards by rgx_dfa_order (), which replays the depth
+.. first traversal of rgx_dfa_tree () on the (now complete) dfa graph.
+.. This makes the tables byte-identical to that of a single threaded
+.. run.
+*/
+static struct {
+  pthread_mutex_t lock;
+  pthread_cond_t  wake;
+  Stack * work, * all;      /* worklist, and all the created states */
+  int busy, status;
+} pool = { PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER };
+
+static void * dfa_worker ( void * arg ) {
+  Stack * list = stack_new (0),
+    * bits = stack_new (stacksize),
+    * seen = stack_new (stacksize),
+    * created = stack_new (0);
+  State ** buff[RGXSIZE];
+  DState * dfa, * d;
+  Labels l;
+  int c, exists, status = 0;
+
+  pthread_mutex_lock (&pool.lock);
+  for (;;) {
+    while ( !pool.work->len && pool.busy && !pool.status )
+      pthread_cond_wait (&pool.wake, &pool.lock);
+    if ( !pool.work->len || pool.status )
+      break;                       /* Done, or some thread failed */
+    pool.work->len -= sizeof (void *);
+    pool.work->nentries--;
+    dfa = ((DState **) pool.work->stack) [pool.work->len/sizeof (void *)];
+    pool.busy++;
+    pthread_mutex_unlock (&pool.lock);
+
+    stack_reset (created);
+    l = LABELS (dfa);
+    while ( !status && (c = labels_next (&l)) >= 0 ) {
+      if (c >= 256 || dfa->next[c] ) continue;
+      status = automaton.transition (dfa->list, list, buff, c, seen);
+      if (status < 0) break;
+      d = dfa->next[c] = state (list, bits, &exists);
+      if (!exists)
+        stack_push (created, d);
+    }
+
+    pthread_mutex_lock (&pool.lock);
+    DState ** dnew = (DState **) created->stack;
+    for (int k=0; k < created->len / sizeof (void *); ++k) {
+      stack_push (pool.work, dnew[k]);
+      stack_push (pool.all, dnew[k]);
+    }
+    if (status < 0) pool.status = status;
+    pool.busy--;
+    pthread_cond_broadcast (&pool.wake);
+  }
+  pthread_cond_broadcast (&pool.wake);
+  pthread_mutex_unlock (&pool.lock);
+
+  stack_free (list); stack_free (bits);
+  stack_free (seen); stack_free (created);
+  return arg;
+}
+
+/*
+.. Replays the traversal of rgx_dfa_tree () on a complete dfa graph,
+.. and number the states in the same order.
+*/
+static int rgx_dfa_order ( DState * root, Stack * Q ) {
+  struct tree {
+    DState * d; Labels l;
+    uint64_t done [ BITBYTES (256 + BCLASSES) >> 3 ];
+  } * stack = malloc ( RGXSIZE * sizeof (struct tree) ), * more;
+  DState * dfa, * child;
+  int c, n = 1, state_id = 0, max = RGXSIZE;
+
+  root->i = -2;
+  stack[0] = (struct tree) { root, LABELS (root) };
+  while (n) {
+    while ( (c = labels_next (&stack[n-1].l)) >= 0 ) {
+      dfa = stack[n-1].d;
+      if (c >= 256 || BITLOOKUP (stack[n-1].done, c)) continue;
+      BITINSERT (stack[n-1].done, c);
+      child = dfa->next[c];
+      if (child->i != -1) continue;           /* Already discovered */
+      child->i = -2;
+      if (n == max) {
+        more = realloc (stack, (max *= 2) * sizeof (struct tree));
+        if (!more) { free (stack); return RGXOOM; }
+        stack = more;
+      }
+      stack[n++] = (struct tree) { child, LABELS (child) };
+    }
+    dfa = stack[--n].d;
+    dfa->i = state_id++;
+    stack_push (Q, dfa);
+  }
+  free (stack);
+  return 0;
+}
 
-static int dfa_minimal ( Stack * Q, Stack * P, DState ** dfa ) {
+static int
+rgx_dfa_tree_parallel ( DState * root, Stack ** Qptr ) {
+  pthread_t * tid = allocate ( nthreads * sizeof (pthread_t) );
+  int status = 0, nt = 0;
+
+  for (int i=0; i<RGXSTRIPES; ++i)
+    pthread_mutex_init (&stripe[i], NULL);
+  pool.work = stack_new (0);
+  pool.all  = stack_new (0);
+  pool.busy = pool.status = 0;
+  stack_push (pool.work, root);
+  stack_push (pool.all, root);
+
+  striped = 1;
+  for (; nt < nthreads; ++nt)
+    if ( pthread_create (&tid[nt], NULL, dfa_worker, NULL) )
+      break;
+  if (!nt)
+    status = RGXERR;
+  for (int i=0; i<nt; ++i)
+    pthread_join (tid[i], NULL);
+  striped = 0;
+
+  if (!status) status = pool.status;
+  if (!status) {
+    DState ** d = (DState **) pool.all->stack;
+    for (int k=0; k < pool.all->len / sizeof (void *); ++k)
+      d[k]->i = -1;                                 /* not visited */
+    Stack * Q = stack_new (pool.all->len);
+    status = rgx_dfa_order (root, Q);
+    if (status < 0) stack_free (Q);
+    else {
+      states = (DState **) Q->stack;
+      *Qptr = Q;
+    }
+  }
+  stack_free (pool.work); stack_free (pool.all);
+  for (int i=0; i<RGXSTRIPES; ++i)
+    pthread_mutex_destroy (&stripe[i]);
+  return status;
+}
 
-  /*
-  .. Converting Partition P(Q) (which is a bit set representation) to
-  .. a new DFA table Q' and store it in the global cache states [].
-  .. Also, identifying accepting states of Q'. Lowest token number
-  .. will be assigned to q->flag for all q in Q'.
-  .. ( Assumes : lower the itoken, more the precedence )
-  */
+/*
+.. Partition of the dfa states Q, stored as a "refinable partition"
+.. (Refer Valmari & Lehtinen, "Efficient minimization of DFAs with
+.. partial transition functions"). States of a block b are
+.. elem [first[b], end[b]). While splitting a block b by a splitter,
+.. the marked states (i.e those in Y ∩ X) are moved to the front of
+.. the block, elem [first[b], mid[b]). loc[q] is the index of the
+.. state q in elem[] and blk[q] is the block of q.
+*/
+typedef struct Partition {
+  int * elem, * loc, * blk, * first, * mid, * end, n;
+} Partition;
+
+static void partition_mark ( Partition * P, int q, int * touched,
+  int * ntouched )
+{
+  int b = P->blk [q], i = P->loc [q], j = P->mid [b], r = P->elem [j];
+  if (i < j) return;                               /* already marked */
+  if (j == P->first [b])
+    touched [(*ntouched)++] = b;
+  P->elem [j] = q;  P->loc [q] = j;
+  P->elem [i] = r;  P->loc [r] = i;
+  P->mid [b]++;
+}
 
-  uint64_t i64, ** bitstack = (uint64_t **) P->stack, * Y;
-  int nq = Q->len/sizeof (void *), np = P->len/sizeof (void *),
-    qsize = BITBYTES (nq);
-  DState * d, ** next, * child,                        /* iterators */
-    ** q = (DState **) Q->stack,             /* original dfa states */
-    ** p =  (hsize < np) ?                        /* new dfa states */
-    allocate ( np * sizeof (DState *) ) :
-    memset ( htable, 0, np * sizeof (DState *) );   /* reuse memory */
-  Stack * cache = stack_new (0);       /* stacking pointers of q[i] */
+/*
+.. Split the block b into Y1 = elem [first, mid) (marked), and
+.. Y2 = elem [mid, end). Y1 is the new block. Returns -1 if Y2 = ∅
+*/
+static int partition_split ( Partition * P, int b ) {
+  if (P->mid [b] == P->end [b]) {
+    P->mid [b] = P->first [b];
+    return -1;
+  }
+  int nb = P->n++;
+  P->first [nb] = P->mid [nb] = P->first [b];
+  P->end [nb] = P->mid [b];
+  P->first [b] = P->end [nb];
+  for (int k = P->first [nb]; k < P->end [nb]; ++k)
+    P->blk [P->elem [k]] = nb;
+  return nb;
+}
+
+/*
+.. Converting the partition P (blk [q] is the block of q in Q) to a
+.. new DFA table Q' and store it in the global cache states [].
+.. Blocks are numbered in the order of their first state in Q.
+.. Also, identifying accepting states of Q'. Lowest token number
+.. will be assigned to q->flag for all q in Q'.
+.. ( Assumes : lower the itoken, more the precedence )
+*/
+static int dfa_minimal ( Stack * Q, int * blk, int np, DState ** dfa ) {
+
+  int nq = Q->len/sizeof (void *);
+  DState * d, ** q = (DState **) Q->stack,   /* original dfa states */
+    ** p = allocate ( (np+1) * sizeof (DState *) ), /* new dfa states */
+    ** rep = allocate ( np * sizeof (DState *) );  /* a state of p[j] */
 
   /*
   .. We reserved states [0] for root DFA node, and states [1] node for
@@ -198,93 +526,77 @@ static int dfa_minimal ( Stack * Q, Stack * P, DState ** dfa ) {
   memset (map, -1, np * sizeof (int));
 
   /*
-  .. Allocating Memory for q[i] and assigning values.
-  */  
-  for (int j=0; j<np; ++j) {                  /* each j in [0, |P|) */
-
-    d = allocate (sizeof (DState));                    /* p[j] in P */
-    int tkn = 0;
-
-    stack_reset (cache);
-    Y = bitstack[j] ;
-    for (int k = 0; k < qsize >> 3; ++k) {         /* decoding bits */
-      int base = k << 6, bit = 0;
-      i64 = Y[k];
-      while (i64) {
-        bit = __builtin_ctzll(i64);       /* position of lowest bit */
-
-        child = q [bit|base];
-        if (child->i == nq-1) {   /* root dfa is the TOP of Q stack */
-          *dfa = d;                  /* root of the new DFA tree Q' */
-          map [j] = 0;
-        }
-        else if (child->i == bol)
-          map [j] = 1;
-        else if (map [j] == -1) {
-          if (mapindex == np) {
-            error ( "Wrong dfa mapping to states [] cache.\n"
-              ".. Internal error");
-            return RGXERR;
-          }
-          map [j] = mapindex++;
-        }
-
-        child->i = map [j];    /* from now 'i' map each q[i] to p[j]*/
-        stack_push (cache, child);                  /* Cache of q[i]*/
-        stack_free (child->bits); child->bits = NULL;
-        if (RGXMATCH (child))
-          tkn = RGXMATCH (child);
-
-        i64 &= (i64 - 1);                   /* clear lowest set bit */
+  .. Blocks of the root DFA and the root BOL DFA are mapped first, so
+  .. that no index in [2,np-1] is wasted on them. In case both are
+  .. equivalent (same block), the block is mapped to 0, and states [1]
+  .. is created later as a copy of states [0].
+  */
+  int dup = blk [nq-1] == blk [bol];
+  map [blk [nq-1]] = 0;
+  if (!dup) map [blk [bol]] = 1;
+  for (int i=0; i<nq; ++i) {
+    int j = blk [i];
+    if (rep [j]) continue;
+    rep [j] = q [i];
+    if (map [j] == -1) {
+      if (mapindex == np + dup) {
+        error ( "Wrong dfa mapping to states [] cache.\n"
+          ".. Internal error");
+        return RGXERR;
       }
+      map [j] = mapindex++;
     }
 
     /*
     .. Where to place this dfa in states [] array.
     .. states [0] is reserved for root/start DFA.
     .. states [1] is reserved for root/start DFA that satisfy BOL
+    .. All the states of a block accept the same token.
     */
+    d = allocate (sizeof (DState));
     *d = (DState) {
-      .list = stack_copy (cache),
       .i    = map [j],
-      .flag = tkn,
+      .flag = RGXMATCH (q [i]),
       .next = allocate (nclass * sizeof (DState *))
     };
     p [ map[j] ] = d;
   }
-  stack_free (cache);
+  *dfa = p[0];                       /* root of the new DFA tree Q' */
 
   /*
   .. Internal check to see if root DFA and root BOL DFA are
   .. located?
   */
-  if ( p[0] == NULL || p[1] == NULL || mapindex < np ) {
+  if ( p[0] == NULL || (p[1] == NULL) != dup || mapindex < np + dup ) {
     error ("DFA Internal error : failed mapping.");
     return RGXERR;
   }
 
   /*
-  .. (b) Creating the transition for each p[i]
+  .. (b) Creating the transition for each p[i]. All the states of a
+  .. block have the same transitions (w.r.t blocks), so we take them
+  .. from any one state, rep [j].
   */
-  int c, n, m;
   for (int j=0; j<np; ++j) {
-    d = p[j];
-    cache = d->list;
-    DState ** s = (DState **) cache->stack;
-    n = cache->len / sizeof (void *);
-    next = d->next;
-
-    while (n--) {
-      State ** nfa = (State **) s[n]->list->stack;
-      m = s[n]->list->len / sizeof (void *);
-      while (m--)
-        if ( (c = nfa[m]->id) < 256 && c >= 0 && !next[c] ) {
-          if (s[n]->next[c] == NULL) return RGXERR;
-          next[c] = p[ s[n]->next[c]->i ];
-        }
-      stack_free (s[n]->list); s[n]->list = NULL;
-    }
-    stack_free (cache); d->list = NULL;
+    DState ** next = p [map [j]]->next, ** old = rep [j]->next;
+    for (int c=0; c<nclass; ++c)
+      if (old [c])
+        next [c] = p [ map [ blk [old [c]->i] ] ];
+  }
+  for (int i=0; i<nq; ++i) {
+    stack_free (q[i]->list);  q[i]->list = NULL;
+    stack_free (q[i]->bits);  q[i]->bits = NULL;
+  }
+
+  if (dup) {
+    d = p[1] = allocate (sizeof (DState));
+    *d = (DState) {
+      .i    = 1,
+      .flag = p[0]->flag,
+      .next = allocate (nclass * sizeof (DState *))
+    };
+    memcpy (d->next, p[0]->next, nclass * sizeof (DState *));
+    d->next [BOL_CLASS] = NULL;
   }
 
   /*
@@ -293,31 +605,161 @@ static int dfa_minimal ( Stack * Q, Stack * P, DState ** dfa ) {
   .. (b) nstates : |states|
   */
   states = p;
-  nstates = np;
+  nstates = np + dup;
   return 1;
 }
 
-#if 0
-void print_partition (Stack * P, int qsize) {
-  int _np = P->len / sizeof (void *);
-  uint64_t ** _bits = (uint64_t **) P->stack;
-  int _nbits;
-  printf ("\n  |P| = %d; \n  P = { ", _np);
-  for(int i=0; i<_np;++i) {
-    BITCOUNT(_bits[i], _nbits, qsize);
-    printf ("%d {", _nbits);
-    for (int j=0; j<qsize>>3; ++j) {
-      uint64_t b = _bits[i][j];
-      while (b) {
-        printf ("%d,", __builtin_ctzll (b) + 64 * j);
-        b &= b-1;
+/*
+.. Pruning of the states, which are never used by the scanner. Those
+.. are the states that
+.. (a) cannot be reached from the root. At run time, a BOL transition
+..     is taken only from the root, and the target of an EOL transition
+..     is only checked for acceptance (refer tokenize.c). So the BOL
+..     transitions of other states are removed, and the transitions of
+..     a state that is reached only by EOL are removed.
+.. (b) cannot reach an accepting state ("doomed"). A transition to
+..     such a state is redirected to the dead state, so that the
+..     scanner rejects early instead of consuming (and backtracking
+..     over) bytes that can never be a part of a token.
+.. The root (q [nq-1]) and the root BOL are always kept. Q is compacted
+.. and renumbered, keeping the order. Returns |Q|.
+*/
+static int prune = 1;
+void rgx_dfa_prune ( int on ) {
+  prune = on;
+}
+
+static int dfa_prune ( Stack * Q ) {
+  int nq = Q->len / sizeof (void *), nr = 0, nl = 0, ne = 0;
+  DState ** q = (DState **) Q->stack, * root = q [nq-1], * next,
+    * bol = root->next [BOL_CLASS];
+  int * mark = allocate (nq * sizeof (int)),
+    * list = allocate (nq * sizeof (int));
+  #define REACHED 1
+  #define EOLONLY 2
+  #define LIVE    4
+
+  /* (a) forward, ignoring EOL transitions (and BOL, except of root) */
+  for (int i=0; i<nq-1; ++i)
+    q[i]->next [BOL_CLASS] = NULL;
+  mark [root->i] = REACHED;
+  list [nr++] = root->i;
+  for (int k=0; k<nr; ++k)
+    for (int c=0; c<nclass; ++c)
+      if ( c != EOL_CLASS && (next = q [list [k]]->next [c]) &&
+        !mark [next->i] ) {
+        mark [next->i] = REACHED;
+        list [nr++] = next->i;
       }
+  for (int k=0; k<nr; ++k)
+    if ( (next = q [list [k]]->next [EOL_CLASS]) && !mark [next->i] )
+      mark [next->i] = EOLONLY;
+  for (int i=0; i<nq; ++i)
+    if (mark [i] == EOLONLY)
+      memset (q[i]->next, 0, nclass * sizeof (DState *));
+
+  /* (b) backward from the accepting states, using the inverse δ */
+  int * in = allocate ((nq + 1) * sizeof (int));
+  for (int i=0; i<nq; ++i)
+    for (int c=0; c<nclass; ++c)
+      if ( mark [i] && (next = q[i]->next [c]) ) {
+        in [next->i + 1]++;
+        ne++;
+      }
+  for (int i=0; i<nq; ++i)
+    in [i+1] += in [i];
+  int * src = allocate ((ne + 1) * sizeof (int)),
+    * fill = allocate (nq * sizeof (int));
+  memcpy (fill, in, nq * sizeof (int));
+  for (int i=0; i<nq; ++i)
+    for (int c=0; c<nclass; ++c)
+      if ( mark [i] && (next = q[i]->next [c]) )
+        src [fill [next->i]++] = i;
+  for (int i=0; i<nq; ++i)
+    if ( mark [i] && RGXMATCH (q[i]) ) {
+      mark [i] |= LIVE;
+      list [nl++] = i;
+    }
+  for (int k=0; k<nl; ++k)
+    for (int e = in [list [k]]; e < in [list [k] + 1]; ++e)
+      if ( !(mark [src [e]] & LIVE) ) {
+        mark [src [e]] |= LIVE;
+        list [nl++] = src [e];
+      }
+
+  /* keep the reached & live states (and the roots), compact Q */
+  mark [root->i] |= LIVE;
+  if (bol) mark [bol->i] |= LIVE;
+  int n = 0;
+  for (int i=0; i<nq; ++i) {
+    if (!(mark [i] & LIVE)) {
+      stack_free (q[i]->list);  q[i]->list = NULL;
+      stack_free (q[i]->bits);  q[i]->bits = NULL;
+      continue;
     }
-    printf ("} ");
+    for (int c=0; c<nclass; ++c)
+      if ( (next = q[i]->next [c]) && !(mark [next->i] & LIVE) )
+        q[i]->next [c] = NULL;
+    q [n++] = q [i];
   }
-  printf ("}");
+  for (int i=0; i<n; ++i)
+    q[i]->i = i;
+  construction.pruned = nq - n;
+  Q->len = n * sizeof (void *);
+
+  deallocate (mark, nq * sizeof (int));
+  deallocate (list, nq * sizeof (int));
+  deallocate (in, (nq + 1) * sizeof (int));
+  deallocate (src, (ne + 1) * sizeof (int));
+  deallocate (fill, nq * sizeof (int));
+  return n;
+
+  #undef REACHED
+  #undef EOLONLY
+  #undef LIVE
+}
+
+/*
+.. Accept sets of rgx_set_compile (). The accepting nfa states (or
+.. positions) of a dfa state give the set of patterns it accepts, a
+.. bitmask of "setwords" words. The distinct sets are kept in "sets",
+.. and the flag of the state is replaced by 1 + the index of its set,
+.. so that the minimisation keeps apart the states of different sets.
+.. Returns the number of sets.
+*/
+static int        setwords = 0, nsets = 0;
+static uint64_t * sets = NULL;
+
+static int accept_sets ( DState ** q, int nq ) {
+  size_t w = setwords * sizeof (uint64_t);
+  int hsize = 2 * nq + 1, * h = allocate (hsize * sizeof (int));
+  sets = allocate ((nq + 1) * w);
+  nsets = 0;
+  memset (h, 0, hsize * sizeof (int));
+  for (int i=0; i<nq; ++i) {
+    if (!RGXMATCH (q[i]))
+      continue;
+    uint64_t * set = sets + (size_t) nsets * setwords;
+    State ** s = (State **) q[i]->list->stack;
+    memset (set, 0, w);
+    for (int k = q[i]->list->len / sizeof (State *); k--; )
+      if (s[k]->id == NFAACC) {
+        int t = positions ? s[k]->flag : state_token (s[k]);
+        BITINSERT (set, t - 1);
+      }
+    uint32_t j = stack_hash ((uint32_t *) set, w) % hsize;
+    while ( h [j] && memcmp (sets + (size_t) (h [j] - 1) * setwords,
+      set, w) )
+      j = (j + 1) % hsize;
+    if (!h [j])
+      h [j] = ++nsets;
+    q[i]->flag = h [j];
+  }
+  deallocate (h, hsize * sizeof (int));
+  return nsets;
 }
-#endif
+
+static int dfa_minimise ( Stack * Q, DState ** dfa, int ntokens );
 
 /*
 .. Given a "root" NFA, it returns minimized DFA (*dfa)
@@ -326,8 +768,6 @@ void print_partition (Stack * P, int qsize) {
 static int
 hopcroft ( State * nfa, DState ** dfa, int nnfa, int ntokens ) {
 
-  #define RTN(r) stack_free (Q); stack_free (P); return (r);
-
   /*
   .. Given an NFA "nfa", it will first create the root dfa, and from
   .. which the entire list of dfa states are created and connected via
@@ -335,13 +775,42 @@ hopcroft ( State * nfa, DState ** dfa, int nnfa, int ntokens ) {
   .. stored in the stack 'Q' (same as global variable 'states').
   */
   Stack * Q;
-  DState * root = dfa_root (nfa, nnfa); if (!nfa) return RGXERR;
-  if ( rgx_dfa_tree (root, &Q) < 0 || !Q )return RGXERR;
-  int nq = Q->len / sizeof (void *), qsize = BITBYTES(nq);
-  DState ** q = (DState **) Q->stack, * next;
+  struct timespec t0, t1;
+  size_t mem = allocated ();
+  clock_gettime (CLOCK_MONOTONIC, &t0);
+  DState * root = dfa_root (nfa, nnfa);
+  if (!root) {
+    error ("dfa : cannot create the root dfa");
+    return RGXERR;
+  }
+  Q = NULL;
+  if ( ( nthreads > 1 ? rgx_dfa_tree_parallel (root, &Q) :
+      rgx_dfa_tree (root, &Q) ) < 0 || !Q )
+    return RGXERR;
+  clock_gettime (CLOCK_MONOTONIC, &t1);
+  construction.nnfa  = nnfa;
+  construction.bytes = allocated () - mem;
+  construction.ms    = 1e3 * (t1.tv_sec - t0.tv_sec) +
+                       1e-6 * (t1.tv_nsec - t0.tv_nsec);
+  construction.pruned = 0;
+  int nq = prune ? dfa_prune (Q) : Q->len / sizeof (void *);
+  if (setwords)                          /* refer rgx_set_compile () */
+    ntokens = accept_sets ((DState **) Q->stack, nq);
   #if 0
   printf ("\n |Q| %d ", nq); fflush (stdout);
   #endif
+  return dfa_minimise (Q, dfa, ntokens);
+}
+
+/*
+.. Hopcroft's minimisation of the dfa states Q (the root is the last
+.. one), where the flag of a state (RGXMATCH) is its token in
+.. [0, ntokens]. The minimal dfa is stored in states [] (refer
+.. dfa_minimal ()), and Q is freed.
+*/
+static int dfa_minimise ( Stack * Q, DState ** dfa, int ntokens ) {
+  int nq = Q->len / sizeof (void *);
+  DState ** q = (DState **) Q->stack, * next;
 
   if (ntokens > nq) {
     error ("dfa : Bad Lexer Design. "
@@ -349,15 +818,33 @@ hopcroft ( State * nfa, DState ** dfa, int nnfa, int ntokens ) {
     return RGXERR;
   }
 
+  #define ARRAY(_n)  allocate ( (size_t) (_n) * sizeof (int) )
+  #define FREE(_a,_n) deallocate (_a, (size_t) (_n) * sizeof (int))
+
   /*
-  .. Maintain a pool of bitsets. Create the partition set P(Q) stored
-  .. in stack 'P'. 'W' is a temporary stack used in Hopcroft alogirthm
+  .. Inverse of the transitions δ, i.e for each state t, the list of
+  .. (s, c) with δ (s,c) = t, stored as src[], cls[] in the range
+  .. [in[t], in[t+1]). (A transition to NULL is to the dead state,
+  .. which is not a part of Q)
   */
-  int rounded =                           /* rounded, 2^N >= 1 + nq */
-    1 << (64 - __builtin_clzll ((unsigned long long) nq) );
-  Stack * pool = stack_new (rounded * sizeof (void *)),
-    * P = stack_new (rounded * sizeof (void *)),
-    * W = stack_new (rounded * sizeof (void *));
+  int * in = ARRAY (nq + 1), ne = 0;
+  for (int i=0; i<nq; ++i)
+    for (int c=0; c<nclass; ++c)
+      if ( (next = q[i]->next[c]) != NULL ) {
+        in [next->i + 1]++;
+        ne++;
+      }
+  for (int i=0; i<nq; ++i)
+    in [i+1] += in [i];
+  int * src = ARRAY (ne), * cls = ARRAY (ne), * fill = ARRAY (nq);
+  memcpy (fill, in, nq * sizeof (int));
+  for (int i=0; i<nq; ++i)
+    for (int c=0; c<nclass; ++c)
+      if ( (next = q[i]->next[c]) != NULL ) {
+        int e = fill [next->i]++;
+        src [e] = i; cls [e] = c;
+      }
+  FREE (fill, nq);
 
   /*
   .. Lets's initialize P with a very coarse partition of Q. Most
@@ -375,41 +862,36 @@ hopcroft ( State * nfa, DState ** dfa, int nnfa, int ntokens ) {
   .. token matched the string. (In case of match collision, it gives
   .. the lowest token number that satisfied the input string)
   */
-
-  {
-    uint64_t ** y = (uint64_t **) P->stack, * f;
-    for (int i=0; i<nq; ++i) {
-      int token = RGXMATCH (q[i]);
-      if (! y [token]) {
-        BSTACK (bset);
-        y [token] = bset;
-      }
-      f = y [token];
-      BITINSERT (f, i);
-    }
-
-    uint64_t ** w = (uint64_t **) W->stack;
-    for (int t=1; t<=ntokens; ++t) {
-      if (! y[t]) {
-        error ("dfa : Bad Lexer Design. "
-          "Some tokens are never reachable?!");
-        return RGXERR;
-      }
-      w[t-1] = COPY (y[t]); // FCOPY [t * 64];
-    }
-
-    P->len = (ntokens+1) * sizeof (void *);
-    W->len = ntokens * sizeof (void *);
-    if (!y[0]) {
-      y [0] = y [ntokens]; y [ntokens] = NULL;
-      P->len -= sizeof (void *);
+  Partition P = {
+    .elem = ARRAY (nq),  .loc = ARRAY (nq),  .blk = ARRAY (nq),
+    .first = ARRAY (nq), .mid = ARRAY (nq),  .end = ARRAY (nq)
+  };
+  int * tb = ARRAY (ntokens + 1);           /* block of each token */
+  for (int t=0; t<=ntokens; ++t)
+    tb [t] = -1;
+  for (int i=0; i<nq; ++i) {
+    int t = RGXMATCH (q[i]);
+    if (tb [t] < 0)
+      tb [t] = P.n++;
+    P.end [tb [t]]++;                           /* count, for now */
+  }
+  for (int t=1; t<=ntokens; ++t)
+    if (tb [t] < 0) {
+      error ("dfa : Bad Lexer Design. "
+        "Some tokens are never reachable?!");
+      return RGXERR;
     }
-
+  for (int b=0, k=0; b<P.n; ++b) {
+    P.first [b] = P.mid [b] = k;
+    k += P.end [b];
+    P.end [b] = P.first [b];
   }
-
-  #if 0
-  print_partition (P, qsize);
-  #endif
+  for (int i=0; i<nq; ++i) {
+    int b = P.blk [i] = tb [RGXMATCH (q[i])];
+    P.elem [P.end [b]] = i;
+    P.loc [i] = P.end [b]++;
+  }
+  FREE (tb, ntokens + 1);
 
   /*
   ..  function hopcroft(DFA):
@@ -429,48 +911,58 @@ hopcroft ( State * nfa, DState ** dfa, int nnfa, int ntokens ) {
   ..          else:
   ..            add smaller of (Y1,Y2) to W
   ..    return P
+  ..
+  .. Since the dfa is partial (the dead state is not a part of Q), all
+  .. the initial blocks are added to W. The transitions into A are
+  .. read from the inverse δ, and grouped by the symbol c (X of each
+  .. symbol c is then contiguous in "xs"). The blocks Y that
+  .. intersect X are split by marking the states of X in them.
   */
-  int count1 = 0, count2 = 0;
-  BSTACK (X); BSTACK (Y1); BSTACK (Y2);
-  while (W->len) {                                 /* while |W| > 0 */
-    uint64_t * A = POP (W);                        /* A <- POP (W)  */
+  int * W = ARRAY (nq), nw = 0, * inw = ARRAY (nq),
+    * touched = ARRAY (nq), ntouched,
+    * xs = ARRAY (ne), * xc = ARRAY (nclass + 1);
+  for (int b=0; b<P.n; ++b) {
+    W [nw++] = b;
+    inw [b] = 1;
+  }
+  while (nw) {                                     /* while |W| > 0 */
+    int A = W [--nw];                              /* A <- POP (W)  */
+    inw [A] = 0;
+
+    /* X for each c, grouped by c, (counting sort by c) */
+    memset (xc, 0, (nclass + 1) * sizeof (int));
+    for (int k = P.first [A]; k < P.end [A]; ++k) {
+      int t = P.elem [k];
+      for (int e = in [t]; e < in [t+1]; ++e)
+        xc [cls [e] + 1]++;
+    }
+    for (int c=0; c<nclass; ++c)
+      xc [c+1] += xc [c];
+    for (int k = P.first [A]; k < P.end [A]; ++k) {
+      int t = P.elem [k];
+      for (int e = in [t]; e < in [t+1]; ++e)
+        xs [xc [cls [e]]++] = src [e];
+    }
+
     int c = nclass;
     while ( c-- ) {                          /* each c in [0, P(Σ)) */
-      BITCLEAR (X, qsize);
-      int k = 0;
-      for (int i=0; i<nq; ++i) {
-        if( (next = q[i]->next[c]) && BITLOOKUP (A, next->i) ) {
-          k++; BITINSERT (X, i);   /* X <- { q in Q | δ(q,c) in A } */
+      int x0 = c ? xc [c-1] : 0, x1 = xc [c];
+      if (x0 == x1) continue;                   /* X = ∅ */
+      ntouched = 0;
+      for (int k = x0; k < x1; ++k)             /* Y1 <- Y ∩ X   */
+        partition_mark (&P, xs [k], touched, &ntouched);
+      for (int k = 0; k < ntouched; ++k) {      /* each Y ∩ X ≠ ∅ */
+        int Y = touched [k], Y1 = partition_split (&P, Y);
+        if (Y1 < 0) continue;                      /* Y \ X = ∅     */
+        if ( inw [Y] ||                            /* if (Y ∈ W)    */
+          P.end [Y1] - P.first [Y1] <= P.end [Y] - P.first [Y] ) {
+          W [nw++] = Y1;
+          inw [Y1] = 1;
         }
-      }
-      if (!k) continue;
-      int nP = P->len/sizeof(void *);
-      for (int i=0; i<nP; ++i) {                   /* each Y in P   */
-        uint64_t ** y = (uint64_t **) P->stack,
-          ** w = (uint64_t **) W->stack;
-        uint64_t * Y = y [i];
-        BITAND ( Y, X, Y1, k, qsize );             /* Y1 <- Y ∩ X   */
-        if (!k) continue;                          /* Y ∩ X = ∅     */
-        BITMINUS ( Y, X, Y2, qsize );              /* Y2 <- Y \ X   */
-        BITCOUNT ( Y1, count1, qsize );            /* |Y1|          */
-        BITCOUNT ( Y2, count2, qsize );            /* |Y2|          */
-        if ( !count2 ) continue;                   /* Y \ X = ∅     */
-        y [i] = COPY (Y1);
-        PUSH ( P, COPY (Y2) );
-        k = -1;
-        int issame;
-        for ( int l=0; l<W->len/sizeof(void *); ++l) {
-          BITCMP ( Y, w[l], issame, qsize );
-          if (issame) {                            /* if (Y ∈ W)    */
-            FREE ( w[l], qsize );
-            w[l] = COPY (Y1) ;
-            PUSH (W, COPY(Y2));
-            k = l; break;
-          }
+        else {
+          W [nw++] = Y;
+          inw [Y] = 1;
         }
-        if (k<0)                                   /* if (Y ∉ W)    */
-          PUSH ( W, count1 <= count2 ? COPY(Y1) : COPY(Y2) );
-        FREE ( Y, qsize );
       }
     }
   }
@@ -480,29 +972,34 @@ hopcroft ( State * nfa, DState ** dfa, int nnfa, int ntokens ) {
   .. (i)   P = {p_0, p_1, .. } with p_i ⊆ Q, and p_i ≠ ∅
   .. (ii)  p_i ∩ p_j = ∅ iff i ≠ j
   .. (iii) collectively exhaustive, i.e,  union of p_i is Q
+  .. Blocks are renumbered in the order of their first state in Q,
+  .. so that the numbering doesn't depend on the order of splitting
   */
-  stack_free(W); stack_free (pool);
-  int np = P->len/sizeof (void *);
-  #if 0
-  print_partition (P, qsize);
-  printf ("|Q'| %d", np);
-  #endif
+  int np = P.n, * order = P.first;
+  memset (order, -1, np * sizeof (int));
+  for (int i=0, k=0; i<nq; ++i) {
+    if (order [P.blk [i]] < 0)
+      order [P.blk [i]] = k++;
+    P.blk [i] = order [P.blk [i]];
+  }
+
+  FREE (in, nq + 1);  FREE (src, ne);  FREE (cls, ne);
+  FREE (W, nq);  FREE (inw, nq);  FREE (touched, nq);
+  FREE (xs, ne);  FREE (xc, nclass + 1);
+  FREE (P.elem, nq);  FREE (P.loc, nq);  FREE (P.first, nq);
+  FREE (P.mid, nq);  FREE (P.end, nq);
+
   dfa [0] = q[nq-1];
   int rval = ( nq >= np ) ?
-    dfa_minimal( Q, P, dfa) :
+    dfa_minimal ( Q, P.blk, np, dfa ) :
     RGXERR;                              /* |P(Q)| should be <= |Q| */
-  RTN (rval);
-
-  #undef RTN
-
-}
+  FREE (P.blk, nq);
+  stack_free (Q);
+  return rval;
 
-  #undef BSTACK
-  #undef POP
+  #undef ARRAY
   #undef FREE
-  #undef PUSH
-  #undef STACK
-  #undef COPY
+}
 
 int rgx_list_dfa ( char ** rgx, int nr, DState ** dfa ) {
   int n, nt = 0;
@@ -510,10 +1007,11 @@ int rgx_list_dfa ( char ** rgx, int nr, DState ** dfa ) {
     ** out = allocate ( (nr+1) * sizeof (State *) );
   nfa_reset ( rgx, nr );
   class_get ( &class, &nclass );
+  automaton_reset ();
   for (int i=0; i<nr; ++i) {
-    n = rgx_nfa (rgx[i], &out[i], 1);
+    n = automaton.create (rgx[i], &out[i], setwords ? i+1 : 1);
     if ( n < 0 ) {
-      error ("rgx list nfa : cannot create nfa for rgx \"%s\"", rgx);
+      error ("rgx list nfa : cannot create nfa for rgx \"%s\"", rgx [i]);
       return RGXERR;
     }
     nt += n;
@@ -532,13 +1030,14 @@ int rgx_lexer_dfa ( char ** rgx, int nr, DState ** dfa ) {
     ** out = allocate ( (nr+2) * sizeof (State *) );
   nfa_reset ( rgx, nr );
   class_get ( &class, &nclass );
+  automaton_reset ();
   for (int i=0; i<nr; ++i) {
     /*
     .. Note that the token number itoken = 0, is reserved for error
     */
-    n = rgx_nfa (rgx[i], &out[i], i+1);
+    n = automaton.create (rgx[i], &out[i], i+1);
     if ( n < 0 ) {
-      error ("rgx list nfa : cannot create nfa for rgx \"%s\"", rgx);
+      error ("rgx list nfa : cannot create nfa for rgx \"%s\"", rgx [i]);
       return RGXERR;
     }
     nt += n;
@@ -550,14 +1049,20 @@ int rgx_lexer_dfa ( char ** rgx, int nr, DState ** dfa ) {
     .. δ (0, class [EOF]) = EOF_STATE;
     .. accept (EOF_STATE) = nr + 1; 
     */
-    n = rgx_nfa ("x", &out[nr], nr+1);         /* a dummy regex "x" */
+    n = automaton.create ("x", &out[nr], nr+1);  /* dummy regex "x" */
     if (n < 0) {
       error ("rgx list nfa : cannot create EOF transition");
       return RGXERR;
     }
     State * nfa = out [nr]; assert (nfa->id == NFAEPS);
-    nfa = nfa->out[0];      assert (nfa->id == BOL_CLASS);
-    nfa = nfa->out[0];      assert (nfa->id == class ['x']);
+    if (positions) {
+      nfa = nfa->out[1];    /* firstpos of ^?x is { ^, x } */
+    }
+    else {
+      nfa = nfa->out[0];    assert (nfa->id == BOL_CLASS);
+      nfa = nfa->out[0];
+    }
+    assert (nfa->id == class ['x']);
     nfa->id = EOF_CLASS;         /* replace class['x'] by EOF class */
     nt += n;
   }
@@ -587,6 +1092,1428 @@ int rgx_dfa_match ( DState * dfa, const char * txt ) {
   return end ? (int) (end - start + 1) : 0;
 }
 
+/*
+.. Flat program of the minimal dfa (refer RgxProg in regex.h). Only
+.. the classes of the bytes are used (i.e not BOL/EOL/EOF/EOB), as
+.. in rgx_dfa_match (). States are renumbered, so that the accepting
+.. states are the last ones, [accept, nstates), and the root is the
+.. first of its kind (non accepting : 1, accepting : accept).
+.. A transition stores the row (state x nclass) of the target, so
+.. that the scanner has neither a multiplication nor a load of an
+.. accept flag per byte. If "tokens", the flag of each state is also
+.. stored (at the offset "token"). The program starts from the root
+.. (start = 0) or from the BOL root (start = 1), and "inner" is the
+.. root. Uses the latest dfa.
+*/
+static int prog_create ( int tokens, int start, RgxProg ** prog ) {
+  uint32_t n = nstates + 1, nc = nclass - BCLASSES, nacc = 0;
+  for (int i=0; i<nstates; ++i)
+    nacc += RGXMATCH (states [i]) != 0;
+  uint64_t rows = (uint64_t) n * nc;
+  uint32_t wide = rows > 65535, next = sizeof (RgxProg);
+  size_t tsize = rows * (wide ? 4 : 2),
+    token = next + ((tsize + 3) & ~(size_t) 3),           /* aligned */
+    size = tokens ? token + (size_t) n * 4 : next + tsize;
+  size = (size + 7) & ~(size_t) 7;  /* so that programs can be chained */
+  if (size > UINT32_MAX) {
+    error ("rgx compile : program too large");
+    return RGXOOM;
+  }
+  RgxProg * p = calloc (1, size);
+  if (!p) {
+    error ("rgx compile : out of memory");
+    return RGXOOM;
+  }
+  uint32_t * map = allocate (nstates * sizeof (uint32_t));
+
+  /* renumber : non accepting in [1, n-nacc), accepting in [n-nacc, n) */
+  uint32_t k [2] = { 1, n - nacc };
+  for (int i=0; i<nstates; ++i)
+    map [i] = k [RGXMATCH (states [i]) != 0]++;
+
+  *p = (RgxProg) {
+    .size = size, .nstates = n, .nclass = nc, .wide = wide,
+    .next = next, .accept = (n - nacc) * nc, .start = map [start] * nc,
+    .inner = map [0] * nc,
+    .token = tokens ? token : 0, .lead = -1
+  };
+  for (int c=0; c<256; ++c)
+    p->class [c] = class [c];
+  char * t = (char *) p + next;
+  for (int i=0; i<nstates; ++i)
+    for (int c=0; c<nc; ++c) {
+      DState * d = states [i]->next [c];
+      uint32_t row = d ? map [d->i] * nc : 0;
+      if (wide)
+        ((uint32_t *) t) [map [i] * nc + c] = row;
+      else
+        ((uint16_t *) t) [map [i] * nc + c] = row;
+    }
+  uint32_t * tk = (uint32_t *) ((char *) p + token);
+  for (int i=0; tokens && i<nstates; ++i)
+    tk [map [i]] = RGXMATCH (states [i]);
+  deallocate (map, nstates * sizeof (uint32_t));
+  *prog = p;
+  return 0;
+}
+
+static inline uint32_t prog_next ( const RgxProg * p, uint32_t s,
+  uint32_t c )
+{
+  const char * t = (const char *) p + p->next;
+  return p->wide ? ((const uint32_t *) t) [s + c] :
+    ((const uint16_t *) t) [s + c];
+}
+
+/*
+.. Bytes for the prefilter of rgx_search (). A class of a single byte
+.. is required, if no accepting state is reachable from the start
+.. without its transitions. "lead" is the byte, if every match starts
+.. with the same one.
+*/
+static void prog_literals ( RgxProg * p ) {
+  uint32_t nc = p->nclass, ns = p->nstates, count [256] = {0},
+    byte [256], nlead = 0, lead = 0;
+  if (p->start >= p->accept)          /* matches the empty string */
+    return;
+  for (int c=255; c>=0; --c) {
+    count [p->class [c]]++;
+    byte [p->class [c]] = c;
+  }
+  for (uint32_t c=0; c<nc; ++c)
+    if ( prog_next (p, p->start, c) && nlead++ == 0 )
+      lead = c;
+  if ( nlead == 1 && count [lead] == 1 )
+    p->lead = byte [lead];
+
+  char * seen = allocate (ns);
+  uint32_t * queue = allocate (ns * sizeof (uint32_t));
+  for (uint32_t c=0; c<nc && p->nreq < RGXREQ; ++c) {
+    if ( count [c] != 1 )
+      continue;
+    int live = 0, nq = 0;
+    memset (seen, 0, ns);
+    seen [p->start / nc] = 1;
+    queue [nq++] = p->start;
+    while ( nq && !live ) {
+      uint32_t s = queue [--nq];
+      for (uint32_t d=0; d<nc && !live; ++d) {
+        uint32_t r = d == c ? 0 : prog_next (p, s, d);
+        if ( !r || seen [r / nc] ) continue;
+        live = r >= p->accept;
+        seen [r / nc] = 1;
+        queue [nq++] = r;
+      }
+    }
+    if (!live)
+      p->req [p->nreq++] = byte [c];
+  }
+  deallocate (queue, ns * sizeof (uint32_t));
+  deallocate (seen, ns);
+}
+
+/*
+.. The program is followed (in the same block) by that of the
+.. unanchored regex (.|\n)*(rgx), at "search", and that of the
+.. reversed regex, at "reverse". Refer rgx_search (). All start from
+.. the BOL root, as a match starts at a BOL. The EOL isn't in the
+.. program, so a "rgx" that uses '$' is an error.
+*/
+static int prog_compile ( char * rgx, RgxProg ** prog ) {
+  RgxProg * q [3] = { NULL, NULL, NULL };
+  size_t n = strlen (rgx) + 16;
+  char * any = allocate (n);
+  snprintf (any, n, "(.|\\n)*(%s)", rgx);
+  /* "rgx" is the last, as rgx_dfa_match () uses the latest classes */
+  DState * dfa;
+  rgx_rpn_reverse (1);
+  int status = rgx_dfa (rgx, &dfa);
+  rgx_rpn_reverse (0);
+  if (status >= 0)
+    status = prog_create (0, 1, &q[2]);
+  if (status >= 0 && (status = rgx_dfa (any, &dfa)) >= 0)
+    status = prog_create (0, 1, &q[1]);
+  if (status >= 0 && (status = rgx_dfa (rgx, &dfa)) >= 0) {
+    if (dfa_eol_used ()) {
+      error ("rgx compile : '$' is not supported (rgx \"%s\")", rgx);
+      status = RGXERR;
+    }
+    else
+      status = prog_create (0, 1, &q[0]);
+  }
+  deallocate (any, n);
+  if (status < 0) {
+    free (q[1]); free (q[2]);
+    return status;
+  }
+
+  uint32_t size = q[0]->size + q[1]->size + q[2]->size;
+  RgxProg * p = realloc (q[0], size);
+  if (!p) {
+    error ("rgx compile : out of memory");
+    free (q[0]); free (q[1]); free (q[2]);
+    return RGXOOM;
+  }
+  p->search  = p->size;
+  p->reverse = p->size + q[1]->size;
+  memcpy ((char *) p + p->search,  q[1], q[1]->size);
+  memcpy ((char *) p + p->reverse, q[2], q[2]->size);
+  p->size = size;
+  free (q[1]); free (q[2]);
+  prog_literals (p);
+  *prog = p;
+  return 0;
+}
+
+int rgx_compile ( char * rgx, RgxProg ** prog ) {
+  pthread_mutex_lock (&compiling);
+  int status = prog_compile (rgx, prog);
+  pthread_mutex_unlock (&compiling);
+  return status;
+}
+
+/*
+.. Run the program from the start state over buf [i] while "_more".
+.. Returns 1 + the length of the longest prefix that matches, or 0 if
+.. none.
+*/
+#define RGXEXEC(_type, _more)                                         \
+  do {                                                                \
+    const _type * next = (const _type *) ((const char *) p + p->next);\
+    for (size_t i=0; _more; ++i) {                                    \
+      s = next [s + cls [(uint8_t) buf [i]]];                         \
+      if (s >= acc) end = i + 1;                                      \
+      else if (!s) break;                                             \
+    }                                                                 \
+  } while (0)
+
+static int prog_exec ( const RgxProg * p, uint32_t s, const char * buf,
+  size_t len )
+{
+  const uint8_t * cls = p->class;
+  uint32_t acc = p->accept;
+  long end = s >= acc ? 0 : -1;
+  if (p->wide)
+    RGXEXEC (uint32_t, i < len);
+  else
+    RGXEXEC (uint16_t, i < len);
+  return (int) (end + 1);
+}
+
+int rgx_exec ( const RgxProg * p, const char * buf, size_t len ) {
+  return prog_exec (p, p->start, buf, len);
+}
+
+/*
+.. Match over chunked input : the loop of rgx_exec () resumed at each
+.. chunk, from the row kept in the RgxStream. The end of a match in the
+.. chunk is moved by the bytes fed before.
+*/
+void rgx_stream_init ( RgxStream * st, const RgxProg * p ) {
+  *st = (RgxStream) {
+    .prog = p, .state = p->start, .pos = 0,
+    .end = p->start >= p->accept ? 0 : -1
+  };
+}
+
+int rgx_stream_feed ( RgxStream * st, const char * buf, size_t len ) {
+  const RgxProg * p = st->prog;
+  const uint8_t * cls = p->class;
+  uint32_t s = st->state, acc = p->accept;
+  long end = -1;
+  if (!s)
+    return 0;
+  if (p->wide)
+    RGXEXEC (uint32_t, i < len);
+  else
+    RGXEXEC (uint16_t, i < len);
+  if (end >= 0)
+    st->end = st->pos + end;
+  st->pos += len;
+  st->state = s;
+  return s != 0;
+}
+
+long rgx_stream_match ( const RgxStream * st ) {
+  return st->end + 1;
+}
+
+/*
+.. Programs of rgx_match (), in a cache of the RGXCACHE latest regex
+.. of each thread (the least recently used one is replaced). A regex
+.. of at most RGXBITS positions gets the bit-parallel program of its
+.. positions (refer positions_bits ()), which is created in linear
+.. time, and the others the program of the dfa. They are created
+.. between allocator_mark () and allocator_release (), so that the
+.. memory doesn't grow with the number of regex matched. The classes
+.. and the latest dfa are restored, for rgx_dfa_match () and
+.. rgx_nfa_match (). Both programs start with a BOL transition, as
+.. in rgx_nfa_match ().
+*/
+typedef struct RgxCached {
+  char * rgx;
+  RgxProg * prog;
+  RgxBits * bits;
+  uint32_t hash;
+  uint64_t used;
+} RgxCached;
+
+static __thread RgxCached cache [RGXCACHE];     /* one per thread */
+static __thread uint64_t  ticks = 0;
+static int                matchbits = 1;
+static pthread_key_t      cachekey;   /* frees it at the thread exit */
+static pthread_once_t     cacheonce = PTHREAD_ONCE_INIT;
+
+void rgx_match_bits ( int on ) {
+  matchbits = on;
+}
+
+static uint32_t rgx_hash ( const char * rgx ) {
+  uint32_t h = 2166136261u;                                /* FNV-1a */
+  while (*rgx)
+    h = (h ^ (uint8_t) *rgx++) * 16777619u;
+  return h;
+}
+
+static void cache_clear ( RgxCached * c ) {
+  for (int i=0; i<RGXCACHE; ++i) {
+    free (c [i].rgx);
+    free (c [i].prog);
+    free (c [i].bits);
+  }
+  memset (c, 0, RGXCACHE * sizeof (RgxCached));
+}
+
+static void cache_key ( ) {
+  pthread_key_create (&cachekey, (void (*) (void *)) cache_clear);
+}
+
+static RgxCached * prog_cached ( char * rgx ) {
+  uint32_t h = rgx_hash (rgx);
+  int lru = 0;
+  for (int i=0; i<RGXCACHE; ++i) {
+    if ( cache [i].rgx && cache [i].hash == h &&
+      !strcmp (cache [i].rgx, rgx) ) {
+      cache [i].used = ++ticks;
+      return &cache [i];
+    }
+    if ( cache [i].used < cache [lru].used )
+      lru = i;
+  }
+
+  int snclass, snstates;
+  DState ** sstates, * dfa;
+  ClassSave saved;
+  RgxProg * p = NULL;
+  RgxBits * b = NULL;
+  char * key = malloc (strlen (rgx) + 1);
+  if (!key) {
+    error ("rgx match : out of memory");
+    return NULL;
+  }
+  strcpy (key, rgx);
+  pthread_mutex_lock (&compiling);
+  snclass = nclass; snstates = nstates; sstates = states;
+  class_save (&saved);
+  AllocMark mark = allocator_mark ();
+  int status = matchbits ? positions_bits (rgx, &b) : 1;
+  if (status == 1 && (status = rgx_dfa (rgx, &dfa)) >= 0)
+    status = prog_create (0, 1, &p);
+  allocator_release (mark);
+  stack_dstr ();                   /* the pool of stacks was released */
+  class_restore (&saved);
+  nfa_classes ();
+  nclass  = snclass;
+  states  = sstates;
+  nstates = snstates;
+  pthread_mutex_unlock (&compiling);
+  if (status < 0) {
+    free (key);
+    return NULL;
+  }
+
+  free (cache [lru].rgx);
+  free (cache [lru].prog);
+  free (cache [lru].bits);
+  cache [lru] = (RgxCached) {
+    .rgx = key, .prog = p, .bits = b, .hash = h, .used = ++ticks
+  };
+  pthread_once (&cacheonce, cache_key);
+  pthread_setspecific (cachekey, cache);
+  return &cache [lru];
+}
+
+void rgx_cache_free ( ) {
+  cache_clear (cache);
+  ticks = 0;
+}
+
+int rgx_match ( char * rgx, const char * txt ) {
+  const RgxCached * e = prog_cached (rgx);
+  if (!e) {
+    error ("rgx match : regex error");
+    return RGXERR;
+  }
+  if (e->bits)
+    return positions_bits_match (e->bits, txt);
+  const RgxProg * p = e->prog;
+  const uint8_t * cls = p->class;
+  const char * buf = txt;
+  uint32_t s = p->start, acc = p->accept;
+  long end = s >= acc ? 0 : -1;
+  if (p->wide)
+    RGXEXEC (uint32_t, buf [i]);
+  else
+    RGXEXEC (uint16_t, buf [i]);
+  return (int) (end + 1);
+}
+
+#undef RGXEXEC
+
+/*
+.. Lazy dfa (refer RgxLazy in regex.h). A state is the set of nfa
+.. states (as bits of their ist, like the keys of htable) reached by
+.. the input so far, and its transitions are evaluated by
+.. states_transition () the first time the input takes them. The
+.. states are carved out of a fixed "budget" of memory, which also
+.. holds the hashtable of the states. Once it's full, all the states
+.. are dropped (a flush) and the current one is created again. So the
+.. memory stays bounded, even if the full dfa explodes, while the
+.. transitions already taken cost a single lookup, as in a dfa. If
+.. the states are flushed before the input used each of them a few
+.. times (RGXLAZYRUN bytes per state, since the previous flush),
+.. creating them costs more than it saves, and the rest of the match
+.. simulates the nfa (as RE2 does).
+*/
+#define RGXLAZYRUN 4
+
+typedef struct LazyState {
+  struct LazyState * hchain, ** next;     /* next [class], NULL : new */
+  uint32_t hash;
+  int flag;
+  uint64_t bits [];
+} LazyState;
+
+struct RgxLazy {
+  State ** index;                          /* nfa state of an ist */
+  uint64_t * start, * bits;     /* nfa states of the start, scratch */
+  Stack * from, * to, * seen;     /* no allocation while matching */
+  LazyState ** table, * root;
+  char * mem;
+  size_t budget, used, hsize, ssize, cap;         /* cap : states */
+  size_t scanned, flushed;       /* bytes so far, and at the flush */
+  int words, nc, startflag, nstates, nflush;
+  uint8_t class [256];
+};
+
+static LazyState lazydead;             /* no nfa state : no match */
+
+static void lazy_flush ( RgxLazy * z ) {
+  memset (z->table, 0, z->hsize * sizeof (LazyState *));
+  z->used = z->hsize * sizeof (LazyState *);
+  z->root = NULL;
+  z->nstates = 0;
+}
+
+/* bits of the list of nfa states. The index of each is updated */
+static uint64_t * lazy_bits ( RgxLazy * z, Stack * list ) {
+  State ** s = (State **) list->stack;
+  memset (z->bits, 0, z->words * sizeof (uint64_t));
+  for (int i=0; i<list->nentries; ++i) {
+    z->index [s[i]->ist] = s[i];
+    BITINSERT (z->bits, s[i]->ist);
+  }
+  return z->bits;
+}
+
+static LazyState * lazy_state ( RgxLazy * z, const uint64_t * bits,
+  int flag, int * flushed )
+{
+  size_t w = z->words * sizeof (uint64_t);
+  uint32_t hash = stack_hash ((uint32_t *) bits, w);
+  LazyState ** ptr = & z->table [hash & (z->hsize - 1)], * s;
+  for (s = *ptr; s; s = s->hchain)
+    if (s->hash == hash && !memcmp (s->bits, bits, w))
+      return s;
+  if (z->used + z->ssize > z->budget) {
+    lazy_flush (z);
+    z->nflush++;
+    *flushed = 1;
+  }
+  s = (LazyState *) (z->mem + z->used);
+  z->used += z->ssize;
+  *s = (LazyState) {
+    .hchain = *ptr, .next = (LazyState **) ((char *) s->bits + w),
+    .hash = hash, .flag = flag
+  };
+  memcpy (s->bits, bits, w);
+  memset (s->next, 0, z->nc * sizeof (LazyState *));
+  z->nstates++;
+  return (*ptr = s);
+}
+
+/*
+.. Transition from "s" by the class "c". Not stored in "s", if the
+.. target flushed the states (including "s").
+*/
+static LazyState * lazy_step ( RgxLazy * z, LazyState * s, int c ) {
+  State ** buff [RGXSIZE];
+  stack_reset (z->from);
+  for (int k=0; k<z->words; ++k)
+    for (uint64_t b = s->bits [k]; b; b &= b - 1)
+      stack_push (z->from, z->index [64 * k + __builtin_ctzll (b)]);
+  if ( states_transition_r (z->from, z->to, buff, c, z->seen) )
+    return NULL;
+  if ( !z->to->nentries )
+    return (s->next [c] = &lazydead);
+  int flushed = 0;
+  LazyState * t = lazy_state (z, lazy_bits (z, z->to), RGXMATCH (z->to),
+    &flushed);
+  if (!flushed)
+    s->next [c] = t;
+  return t;
+}
+
+static int lazy_compile ( char * rgx, size_t budget,
+  RgxLazy ** lazy )
+{
+  State * nfa, ** buff [RGXSIZE];
+  int * cls, ncls;
+  nfa_reset (&rgx, 1);
+  int n = rgx_nfa (rgx, &nfa, 1);
+  if (n < 0)
+    return n;
+  class_get (&cls, &ncls);
+
+  RgxLazy * z = calloc (1, sizeof (RgxLazy));
+  if (!z) {
+    error ("rgx lazy : out of memory");
+    return RGXOOM;
+  }
+  z->words = BITBYTES (n) / sizeof (uint64_t);
+  z->nc = ncls - BCLASSES;
+  z->budget = budget ? budget : RGXLAZY;
+  z->ssize = sizeof (LazyState) + z->words * sizeof (uint64_t) +
+    z->nc * sizeof (LazyState *);
+  z->hsize = 64;               /* about a bucket per state, at most */
+  while ( 2 * z->hsize * z->ssize <= z->budget )
+    z->hsize *= 2;
+  z->index = calloc (n, sizeof (State *));
+  z->start = calloc (z->words, sizeof (uint64_t));
+  z->bits  = calloc (z->words, sizeof (uint64_t));
+  z->mem   = malloc (z->budget);
+  z->table = (LazyState **) z->mem;
+  if ( !z->index || !z->start || !z->bits || !z->mem ||
+    z->hsize * sizeof (LazyState *) + 4 * z->ssize > z->budget ) {
+    error ("rgx lazy : budget of %zu bytes too small for \"%s\"",
+      z->budget, rgx);
+    rgx_lazy_free (z);
+    return RGXOOM;
+  }
+  for (int c=0; c<256; ++c)
+    z->class [c] = cls [c];
+  z->cap = (z->budget - z->hsize * sizeof (LazyState *)) / z->ssize;
+
+  /* start : after the transition by BOL, as in rgx_nfa_match () */
+  z->from = stack_new ((n + 1) * sizeof (State *));
+  z->to   = stack_new ((n + 1) * sizeof (State *));
+  z->seen = stack_new (BITBYTES (n));
+  if ( states_at_start (nfa, z->from, buff) ||
+    states_transition (z->from, z->to, buff, ncls - 1) ) {
+    rgx_lazy_free (z);
+    return RGXOOM;
+  }
+  memcpy (z->start, lazy_bits (z, z->to), z->words * sizeof (uint64_t));
+  z->startflag = RGXMATCH (z->to);
+  lazy_flush (z);
+  *lazy = z;
+  return 0;
+}
+
+int rgx_lazy_compile ( char * rgx, size_t budget, RgxLazy ** lazy ) {
+  pthread_mutex_lock (&compiling);
+  int status = lazy_compile (rgx, budget, lazy);
+  pthread_mutex_unlock (&compiling);
+  return status;
+}
+
+/*
+.. nfa simulation of buf [i, len) from the nfa states of the latest
+.. transition (z->to). Refer rgx_nfa_match ()
+*/
+static long lazy_nfa ( RgxLazy * z, const char * buf, size_t i,
+  size_t len, long end )
+{
+  State ** buff [RGXSIZE];
+  Stack * s0 = z->to, * s1 = z->from, * t;
+  for (; i<len && s0->nentries; ++i) {
+    if ( states_transition_r (s0, s1, buff, z->class [(uint8_t) buf [i]],
+      z->seen) )
+      return RGXOOM;
+    t = s0; s0 = s1; s1 = t;
+    if ( RGXMATCH (s0) )
+      end = i + 1;
+  }
+  return end;
+}
+
+int rgx_lazy_match ( RgxLazy * z, const char * buf, size_t len ) {
+  int flushed = 0, nflush = z->nflush;
+  LazyState * s = z->root, * t;
+  if (!s)
+    s = z->root = lazy_state (z, z->start, z->startflag, &flushed);
+  long end = s->flag ? 0 : -1;
+  size_t i;
+  for (i=0; i<len; ++i) {
+    int c = z->class [(uint8_t) buf [i]];
+    if ( !(t = s->next [c]) && !(t = lazy_step (z, s, c)) ) {
+      end = RGXOOM;
+      break;
+    }
+    if (t == &lazydead)
+      break;
+    if ( (s = t)->flag )
+      end = i + 1;
+    if ( z->nflush != nflush ) {         /* "s" is new, z->to its list */
+      size_t run = z->scanned + i - z->flushed;
+      nflush = z->nflush;
+      z->flushed = z->scanned + i;
+      if ( run < RGXLAZYRUN * z->cap ) {
+        end = lazy_nfa (z, buf, i + 1, len, end);
+        break;
+      }
+    }
+  }
+  z->scanned += i;
+  if (end == RGXOOM) {
+    error ("rgx lazy : out of memory");
+    return RGXOOM;
+  }
+  return (int) (end + 1);
+}
+
+void rgx_lazy_stats ( const RgxLazy * z, int * nstates, int * nflush ) {
+  *nstates = z->nstates;
+  *nflush  = z->nflush;
+}
+
+void rgx_lazy_free ( RgxLazy * z ) {
+  if (!z)
+    return;
+  if (z->from) stack_free (z->from);
+  if (z->to)   stack_free (z->to);
+  if (z->seen) stack_free (z->seen);
+  free (z->index); free (z->start); free (z->bits); free (z->mem);
+  free (z);
+}
+
+/*
+.. Leftmost longest match, using the programs of rgx_compile ()
+.. (a) prefilter : each required byte should be in buf, and a match
+..     can't start before the first "lead" byte (memchr).
+.. (b) the unanchored program finds the first end "e" of a match.
+.. (c) the reversed program, run backwards from "e", finds the
+..     smallest start "s" of the matches ending at "e".
+.. (d) a match starting before "s" has to end after "e". Those starts
+..     are checked by prog_leftmost (), and prog_exec () gives the
+..     longest match from the leftmost start.
+.. A run from buf [0] starts at the BOL root ("start"), and a run from
+.. a later byte at the root ("inner"), so that a '^' matches only at
+.. buf [0].
+*/
+/*
+.. Leftmost start in [lo, s] of a match, given that "s" is one. The
+.. runs of the program from each start before "s" are done at once.
+.. Runs in the same state have the same future, so only the leftmost
+.. of them is kept (first [state] = start + 1), and there are at most
+.. nstates runs at a time. Returns (size_t) -1 if out of memory.
+*/
+static size_t prog_leftmost ( const RgxProg * p, const char * buf,
+  size_t len, size_t lo, size_t s )
+{
+  #define NSTACK 64
+  uint32_t ns = p->nstates, nc = p->nclass, na = 0, nb, r, c,
+    sbuf [NSTACK * 6];
+  size_t * first = (size_t *) sbuf;
+  if ( ns > NSTACK &&
+    !(first = calloc (ns, 2 * sizeof (size_t) + 2 * sizeof (uint32_t))) )
+    return (size_t) -1;
+  if ( ns <= NSTACK )
+    memset (first, 0, ns * sizeof (size_t));
+  size_t * st = first + ns;
+  uint32_t * act = (uint32_t *) (st + ns), * nxt = act + ns, * tmp;
+
+  for (size_t i=lo; i<len && (na || i<s); ++i) {
+    if ( !na ) {                  /* skip the bytes that can't start */
+      if ( p->lead >= 0 ) {
+        const char * l = memchr (buf + i, p->lead, s - i);
+        if (!l) break;
+        i = l - buf;
+      }
+      else
+        while ( i < s &&
+          !prog_next (p, p->start, p->class [(uint8_t) buf [i]]) )
+          ++i;
+      if ( i == s ) break;
+    }
+    r = i ? p->inner : p->start;                  /* a run from i */
+    if ( !first [r / nc] ) {
+      first [r / nc] = i + 1;
+      act [na++] = r;
+    }
+    for (uint32_t k=0; k<na; ++k) {
+      st [k] = first [act [k] / nc];
+      first [act [k] / nc] = 0;
+    }
+    c = p->class [(uint8_t) buf [i]];
+    nb = 0;
+    for (uint32_t k=0; k<na; ++k) {
+      if ( st [k] > s || !(r = prog_next (p, act [k], c)) )
+        continue;          /* can't be left of "s" (anymore) or dead */
+      if ( r >= p->accept )
+        s = st [k] - 1;
+      size_t * f = & first [r / nc];
+      if (!*f)
+        nxt [nb++] = r;
+      if (!*f || st [k] < *f)
+        *f = st [k];
+    }
+    tmp = act; act = nxt; nxt = tmp;
+    na = nb;
+  }
+  if ( ns > NSTACK )
+    free (first);
+  return s;
+  #undef NSTACK
+}
+
+#define RGXFIRST(_type)                                               \
+  do {                                                                \
+    const _type * next = (const _type *) ((const char *) f + f->next);\
+    const uint8_t * cls = f->class;                                   \
+    uint32_t q = lo ? f->inner : f->start, acc = f->accept;           \
+    for (size_t i=lo; i<len; ++i)                                     \
+      if ( (q = next [q + cls [(uint8_t) buf [i]]]) >= acc ) {        \
+        e = i + 1;                                                    \
+        break;                                                        \
+      }                                                               \
+  } while (0)
+
+#define RGXSTART(_type)                                               \
+  do {                                                                \
+    const _type * next = (const _type *) ((const char *) r + r->next);\
+    const uint8_t * cls = r->class;                                   \
+    uint32_t q = r->start, acc = r->accept;                           \
+    for (size_t i=e; i>lo; --i) {                                     \
+      if ( !(q = next [q + cls [(uint8_t) buf [i-1]]]) )              \
+        break;                                                        \
+      if ( q >= acc )                                                 \
+        s = i - 1;                                                    \
+    }                                                                 \
+  } while (0)
+
+int rgx_search ( const RgxProg * p, const char * buf, size_t len,
+  size_t * start, size_t * end )
+{
+  if ( !p->search ) {
+    error ("rgx search : program has no search tables");
+    return RGXERR;
+  }
+  size_t lo = 0, e = 0, s = 0;
+  if ( p->start >= p->accept ) {              /* empty match at 0 */
+    *start = 0;
+    *end = rgx_exec (p, buf, len) - 1;
+    return 1;
+  }
+  for (int i=0; i<p->nreq; ++i)
+    if ( !memchr (buf, p->req [i], len) )
+      return 0;
+  if ( p->lead >= 0 ) {
+    const char * c = memchr (buf, p->lead, len);
+    if (!c)
+      return 0;
+    lo = c - buf;
+  }
+
+  const RgxProg * f = (const RgxProg *) ((const char *) p + p->search),
+    * r = (const RgxProg *) ((const char *) p + p->reverse);
+  if (f->wide)
+    RGXFIRST (uint32_t);
+  else
+    RGXFIRST (uint16_t);
+  if (!e)
+    return 0;
+  if (r->wide)
+    RGXSTART (uint32_t);
+  else
+    RGXSTART (uint16_t);
+
+  if ( (s = prog_leftmost (p, buf, len, lo, s)) == (size_t) -1 ) {
+    error ("rgx search : out of memory");
+    return RGXOOM;
+  }
+  *start = s;
+  *end = s + prog_exec (p, s ? p->inner : p->start, buf + s,
+    len - s) - 1;
+  return 1;
+}
+
+#undef RGXFIRST
+#undef RGXSTART
+
+/*
+.. The patterns get the tokens 1..n in rgx_list_dfa (), and the flag
+.. of the dfa states is their accept set (refer accept_sets ()).
+*/
+static int set_compile ( char ** rgx, int n, RgxSet ** set ) {
+  DState * dfa;
+  RgxProg * p;
+  setwords = (n + 63) / 64;
+  int status = rgx_list_dfa (rgx, n, &dfa);
+  setwords = 0;
+  if (status >= 0 && dfa_eol_used ()) {
+    error ("rgx set compile : '$' is not supported");
+    status = RGXERR;
+  }
+  if (status < 0 || (status = prog_create (1, 1, &p)) < 0)
+    return status;
+
+  size_t w = (n + 63) / 64 * sizeof (uint64_t),
+    size = sizeof (RgxSet) + nsets * w + p->size;
+  RgxSet * t = size > UINT32_MAX ? NULL : malloc (size);
+  if (!t) {
+    error ("rgx set compile : out of memory");
+    free (p);
+    return RGXOOM;
+  }
+  *t = (RgxSet) {
+    .size = size, .npatterns = n, .nwords = w / sizeof (uint64_t),
+    .nsets = nsets, .sets = sizeof (RgxSet),
+    .prog = sizeof (RgxSet) + nsets * w
+  };
+  memcpy ((char *) t + t->sets, sets, nsets * w);
+  memcpy ((char *) t + t->prog, p, p->size);
+  free (p);
+  *set = t;
+  return 0;
+}
+
+int rgx_set_compile ( char ** rgx, int n, RgxSet ** set ) {
+  pthread_mutex_lock (&compiling);
+  int status = set_compile (rgx, n, set);
+  pthread_mutex_unlock (&compiling);
+  return status;
+}
+
+/*
+.. The accept set of each accepting state on the way is added to
+.. "ids" (once, for a run of the same set).
+*/
+#define RGXSET(_type)                                                 \
+  do {                                                                \
+    const _type * next = (const _type *) ((const char *) p + p->next);\
+    for (size_t i=0; i<len; ++i) {                                    \
+      s = next [s + cls [(uint8_t) buf [i]]];                         \
+      if (s >= acc) {                                                 \
+        if ( (t = token [s / nc]) != last )                           \
+          for (uint32_t k=0; k<nw; ++k)                               \
+            ids [k] |= sets [(t - 1) * nw + k];                       \
+        last = t;                                                     \
+      }                                                               \
+      else if (!s) break;                                             \
+    }                                                                 \
+  } while (0)
+
+int rgx_set_match ( const RgxSet * set, const char * buf, size_t len,
+  uint64_t * ids )
+{
+  const RgxProg * p = (const RgxProg *) ((const char *) set + set->prog);
+  const uint64_t * sets = (const uint64_t *) ((const char *) set +
+    set->sets);
+  const uint32_t * token = (const uint32_t *) ((const char *) p +
+    p->token);
+  const uint8_t * cls = p->class;
+  uint32_t s = p->start, acc = p->accept, nc = p->nclass,
+    nw = set->nwords, last = 0, t;
+  int count = 0;
+  memset (ids, 0, nw * sizeof (uint64_t));
+  if (s >= acc) {
+    last = token [s / nc];
+    memcpy (ids, sets + (last - 1) * nw, nw * sizeof (uint64_t));
+  }
+  if (p->wide)
+    RGXSET (uint32_t);
+  else
+    RGXSET (uint16_t);
+  for (uint32_t k=0; k<nw; ++k)
+    count += __builtin_popcountll (ids [k]);
+  return count;
+}
+
+#undef RGXSET
+
+/*
+.. Tagged dfa of rgx_capture_compile () (refer RgxCapture in regex.h).
+.. A state is the list of the nfa states (other than ε) reached by the
+.. input, in the order of priority of their paths : alternatives from
+.. the left and greedy quantifiers, as in a backtracking matcher. The
+.. closure visits the ε-states in that order (depth first), and an nfa
+.. state reached again is dropped, so that each keeps its path of the
+.. highest priority (as in the Pike VM). The i-th nfa state of a list
+.. is the slot i, and each (slot, tag) has a register, shared by the
+.. slots whose tag has the same value (refer tdfa_regs ()). A state is
+.. identified by its list and its registers, and each transition
+.. carries the operations on the registers : a tag passed by the
+.. closure is set to the position, and the others are copied from the
+.. slot the nfa state came from, where the register differs. So a
+.. loop that sets no tag runs no operation. The register 0 is a
+.. temporary (refer tdfa_ops ()). The groups of an accepting state are
+.. those of the slot of its (first) accepting nfa state. The states
+.. are then pruned and minimised as those of a dfa, with the token of
+.. a state being its signature : the registers of the groups, and the
+.. operations of each transition.
+*/
+typedef struct TState {
+  DState d;
+  int final, * ops;           /* ops [c] : offset in tcode, 0 : none */
+  int * regs;                   /* regs [slot x ntags + tag] */
+} TState;
+
+typedef struct TPath {
+  State * s;
+  uint64_t tags;                    /* tags passed by the closure */
+} TPath;
+
+static int        ntags, nslots, ntnfa;
+static int      * tcode = NULL, ncode, maxcode;    /* n, dst, src .. */
+static int      * thash = NULL, nthash, nlists;  /* lists in tcode */
+static uint64_t * tseen, * tset;              /* refer tdfa_closure */
+static TPath    * tpath;
+static int      * tfrom, * tkey, * treads, * twriter, * tmoves;
+static int      * tval, * treg;                 /* refer tdfa_regs */
+
+/*
+.. Closure of the nfa state "s" reached from the slot "from" (-1 for
+.. the root). The nfa states are appended to "list", with their slot
+.. of origin in tfrom [] and the tags passed on the way in tset [].
+*/
+static void tdfa_closure ( State * s, int from, Stack * list ) {
+  int n = 0;
+  tpath [n++] = (TPath) { s, 0 };
+  while (n) {
+    TPath p = tpath [--n];
+    if ( !p.s || BITLOOKUP (tseen, p.s->ist) )
+      continue;
+    BITINSERT (tseen, p.s->ist);
+    if (p.s->id == NFATAG) {
+      p.tags |= (uint64_t) 1 << state_tag (p.s);
+      tpath [n++] = (TPath) { p.s->out [0], p.tags };
+    }
+    else if (p.s->id == NFAEPS) {
+      int k = 0;
+      while (p.s->out [k]) ++k;
+      while (k--)                     /* out [0] is visited first */
+        tpath [n++] = (TPath) { p.s->out [k], p.tags };
+    }
+    else {
+      tfrom [list->nentries] = from;
+      tset  [list->nentries] = p.tags;
+      stack_push (list, p.s);
+    }
+  }
+}
+
+/*
+.. Offset of the list "op" [0, 2n) in tcode [] (the same list is kept
+.. once, tcode [0] is the empty list). thash [] is an open addressed
+.. table of the offsets. Returns -1 if out of memory.
+*/
+static uint32_t tdfa_hash ( int * list ) {
+  return stack_hash ((uint32_t *) list, 4 * (2 * list [0] + 1));
+}
+
+static int tdfa_code ( int * op, int n ) {
+  int size = 2*n + 1, * h;
+  if (!n)
+    return 0;
+  if ( ncode + size > maxcode ) {
+    int * more = realloc (tcode, 2 * (ncode + size) * sizeof (int));
+    if (!more) return -1;
+    tcode = more;
+    maxcode = 2 * (ncode + size);
+  }
+  if ( 2 * (nlists + 1) > nthash ) {             /* grow and rehash */
+    int hsize = 2 * nthash + 64;
+    if ( !(h = calloc (hsize, sizeof (int))) ) return -1;
+    for (int i=0; i<nthash; ++i)
+      if (thash [i]) {
+        uint32_t j = tdfa_hash (tcode + thash [i]) % hsize;
+        while (h [j]) j = (j + 1) % hsize;
+        h [j] = thash [i];
+      }
+    free (thash);
+    thash = h;
+    nthash = hsize;
+  }
+  int * list = tcode + ncode;
+  list [0] = n;
+  memcpy (list + 1, op, 2 * n * sizeof (int));
+  uint32_t j = tdfa_hash (list) % nthash;
+  while ( thash [j] &&
+    memcmp (tcode + thash [j], list, size * sizeof (int)) )
+    j = (j + 1) % nthash;
+  if (!thash [j]) {
+    thash [j] = ncode;
+    ncode += size;
+    nlists++;
+  }
+  return thash [j];
+}
+
+/*
+.. Registers of the list of "n" nfa states reached from the state
+.. "from" (NULL for the root, refer tdfa_closure ()). The value of the
+.. tag t in the slot j is the position if the closure passed t (-1),
+.. or else the register of t in the slot it came from (-2 at the root :
+.. not set). For each tag, the distinct values are numbered from 0 in
+.. the order of the slots, and the g-th is in the register 1 + g x
+.. ntags + t. treg [] gets the register of each (slot, tag), and
+.. tmoves [] the pairs (register, value) to assign. Returns the number
+.. of pairs.
+*/
+static int tdfa_regs ( TState * from, int n ) {
+  int np = 0;
+  for (int t=0; t<ntags; ++t)
+    for (int j=0, ng=0, i; j<n; ++j) {
+      int v = (tset [j] >> t) & 1 ? -1 : tfrom [j] < 0 ? -2 :
+        from->regs [tfrom [j] * ntags + t], * r = treg + j * ntags + t;
+      tval [j] = v;
+      for (i=0; i<j && tval [i] != v; ++i) ;
+      if (i < j) {
+        *r = treg [i * ntags + t];
+        continue;
+      }
+      *r = 1 + ng++ * ntags + t;
+      if ( v != -2 && v != *r ) {
+        tmoves [np++] = *r; tmoves [np++] = v;
+      }
+    }
+  return np / 2;
+}
+
+/*
+.. Operations of the "np" pairs of tdfa_regs (). The copies are a
+.. parallel assignment of the new registers from the old ones. A copy
+.. is taken once no other copy reads its target. If none is left, the
+.. rest are cycles, and one is broken by saving a target in the
+.. register 0. The tags set to the position come last, as the copies
+.. read the older values.
+*/
+static int tdfa_ops ( int np ) {
+  int nm = 0, nop = 0, nready = 0, left, * pair = tmoves,
+    * md = pair + 2 * np, * ms = md + np, * op = ms + np,
+    * ready = op + 4 * np;
+  for (int k=0; k<np; ++k)
+    if ( pair [2*k + 1] > 0 ) {
+      md [nm] = pair [2*k]; ms [nm] = pair [2*k + 1];
+      treads [ms [nm]]++;
+      twriter [md [nm]] = nm;
+      nm++;
+    }
+  for (int k=0; k<nm; ++k)
+    if (!treads [md [k]])
+      ready [nready++] = k;
+  for (left = nm; left; ) {
+    while (nready) {
+      int k = ready [--nready], r = ms [k], w;
+      op [nop++] = md [k]; op [nop++] = r;
+      twriter [md [k]] = -1;
+      md [k] = -1;
+      left--;
+      if ( r && !--treads [r] && (w = twriter [r]) >= 0 )
+        ready [nready++] = w;
+    }
+    int k = 0;
+    while ( left && md [k] < 0 ) ++k;
+    if (!left) break;
+    op [nop++] = 0; op [nop++] = md [k];            /* cycle : save */
+    for (int m=0; m<nm; ++m)
+      if ( md [m] >= 0 && ms [m] == md [k] ) {
+        ms [m] = 0;
+        treads [md [k]]--;
+      }
+    ready [nready++] = k;
+  }
+  for (int k=0; k<np; ++k)
+    if ( pair [2*k + 1] < 0 ) {
+      op [nop++] = pair [2*k]; op [nop++] = -1;
+    }
+  return tdfa_code (op, nop / 2);
+}
+
+/*
+.. The state of the list (the order of the nfa states included) and
+.. of the registers treg []. Returns NULL if out of memory.
+*/
+static TState * tdfa_state ( Stack * list, int * exists ) {
+  int n = list->nentries, nr = n * ntags;
+  State ** s = (State **) list->stack;
+  for (int i=0; i<n; ++i)
+    tkey [i] = s[i]->ist;
+  memcpy (tkey + n, treg, nr * sizeof (int));
+  uint32_t hash = stack_hash ((uint32_t *) tkey, 4 * (n + nr));
+  DState ** ptr = & htable [hash % hsize], * d;
+  *exists = 1;
+  for ( ; (d = *ptr) != NULL; ptr = & d->hchain )
+    if ( d->hash == hash && d->list->len == list->len &&
+      !memcmp (d->list->stack, list->stack, list->len) &&
+      !memcmp (((TState *) d)->regs, treg, nr * sizeof (int)) )
+      return (TState *) d;
+  *exists = 0;
+  TState * t = allocate ( sizeof (TState) );
+  *t = (TState) {
+    .d = {
+      .next = allocate ( nclass * sizeof (DState *) ),
+      .hash = hash,
+      .list = stack_copy ( list )
+    },
+    .final = -1,
+    .ops = allocate ( nclass * sizeof (int) ),
+    .regs = allocate ( nr * sizeof (int) )
+  };
+  memcpy (t->regs, treg, nr * sizeof (int));
+  for (int i=0; i<n; ++i)
+    if (s[i]->id == NFAACC) {          /* the registers of the groups */
+      if ( (t->final = tdfa_code (treg + i * ntags, ntags / 2)) < 0 )
+        return NULL;
+      break;
+    }
+  t->d.flag = t->final >= 0;
+  if (n > nslots)
+    nslots = n;
+  *ptr = &t->d;
+  if (++hcount > 2 * hsize)
+    htable_grow ();
+  return t;
+}
+
+/*
+.. All the states reached from the root, in Q. The root is the last.
+.. Only the root has a BOL transition, to the start of the match, and
+.. EOL (and EOF, EOB) aren't used, as in rgx_exec ().
+*/
+static int tdfa_tree ( State * nfa, Stack * Q, int * begin ) {
+  Stack * list = stack_new (0);
+  int exists, c;
+  memset (tseen, 0, BITBYTES (ntnfa));
+  tdfa_closure (nfa, -1, list);
+  int np = tdfa_regs (NULL, list->nentries);
+  TState * root = tdfa_state (list, &exists), * t, * start = NULL;
+  *begin = root ? tdfa_ops (np) : -1;
+  stack_push (Q, root);
+
+  /*
+  .. BOL holds at the start : the nfa states labelled by BOL take the
+  .. transition, and the others stay (in their order)
+  */
+  if (*begin >= 0) {
+    State ** s = (State **) root->d.list->stack;
+    stack_reset (list);
+    memset (tseen, 0, BITBYTES (ntnfa));
+    for (int j=0; j < root->d.list->nentries; ++j)
+      tdfa_closure (LABELLED (s[j], BOL_CLASS) ? s[j]->out [0] : s[j],
+        j, list);
+    np = tdfa_regs (root, list->nentries);
+    if ( !(start = t = tdfa_state (list, &exists)) ||
+      (root->ops [BOL_CLASS] = tdfa_ops (np)) < 0 )
+      *begin = -1;
+    else {
+      root->d.next [BOL_CLASS] = &t->d;
+      if (!exists)
+        stack_push (Q, t);
+    }
+  }
+
+  for (int k=0; k < Q->nentries && *begin >= 0; ++k) {
+    TState * d = ((TState **) Q->stack) [k];
+    if (d == root && start != root)       /* never used by a match */
+      continue;
+    Labels l = LABELS (&d->d);
+    while ( (c = labels_next (&l)) >= 0 ) {
+      if ( c >= nclass - BCLASSES || c >= 256 || d->d.next [c] )
+        continue;
+      State ** s = (State **) d->d.list->stack;
+      stack_reset (list);
+      memset (tseen, 0, BITBYTES (ntnfa));
+      for (int j=0; j < d->d.list->nentries; ++j)
+        if ( LABELLED (s[j], c) )
+          tdfa_closure (s[j]->out [0], j, list);
+      np = tdfa_regs (d, list->nentries);
+      if ( !(t = tdfa_state (list, &exists)) ||
+        (d->ops [c] = tdfa_ops (np)) < 0 ) {
+        *begin = -1;
+        break;
+      }
+      d->d.next [c] = &t->d;
+      if (!exists)
+        stack_push (Q, t);
+    }
+  }
+  stack_free (list);
+  if (*begin < 0) {
+    error ("rgx capture : out of memory");
+    return RGXOOM;
+  }
+
+  /* the root last, as in rgx_dfa_tree () */
+  DState ** q = (DState **) Q->stack;
+  int nq = Q->nentries;
+  memmove (q, q + 1, (nq - 1) * sizeof (DState *));
+  q [nq - 1] = &root->d;
+  for (int i=0; i<nq; ++i)
+    q[i]->i = i;
+  return 0;
+}
+
+/*
+.. The signature of each state, the row of its final register and the
+.. operations of each transition, (nclass - BCLASSES + 2) ints in
+.. sig []. The flag of a state is 1 + the index of its signature.
+.. Returns the number of signatures.
+*/
+static int tdfa_signatures ( DState ** q, int nq, int ** sig ) {
+  int nc = nclass - BCLASSES, w = nc + 2, hsize = 2 * nq + 1, n = 0,
+    * h = calloc (hsize, sizeof (int)), * row = malloc (w * sizeof (int));
+  *sig = malloc ((size_t) nq * w * sizeof (int));
+  if (!h || !row || !*sig) {
+    free (h); free (row); free (*sig);
+    return RGXOOM;
+  }
+  for (int i=0; i<nq; ++i) {
+    TState * t = (TState *) q[i];
+    row [0] = t->final;
+    for (int c=0; c<nc; ++c)
+      row [1 + c] = t->d.next [c] ? t->ops [c] : 0;
+    row [nc + 1] = t->d.next [BOL_CLASS] ? t->ops [BOL_CLASS] : 0;
+    uint32_t j = stack_hash ((uint32_t *) row, 4 * w) % hsize;
+    while ( h [j] && memcmp (*sig + (size_t) (h [j] - 1) * w, row,
+      w * sizeof (int)) )
+      j = (j + 1) % hsize;
+    if (!h [j]) {
+      memcpy (*sig + (size_t) n * w, row, w * sizeof (int));
+      h [j] = ++n;
+    }
+    t->d.flag = h [j];
+  }
+  free (h); free (row);
+  return n;
+}
+
+/*
+.. Flat program of the minimal tagged dfa (states [], whose flag is
+.. the signature), numbered as in prog_create (). Starts from the BOL
+.. root.
+*/
+static int capture_create ( int * sig, int ngroups, int begin,
+  RgxCapture ** cap )
+{
+  uint32_t n = nstates + 1, nc = nclass - BCLASSES, w = nc + 2, nacc = 0;
+  #define SIG(_d_)  ( sig + (size_t) ((_d_)->flag - 1) * w )
+  for (int i=0; i<nstates; ++i)
+    nacc += SIG (states [i]) [0] >= 0;
+  uint64_t rows = (uint64_t) n * nc;
+  size_t next = sizeof (RgxCapture), ops = next + rows * 4,
+    final = ops + rows * 4, code = final + (size_t) n * 4,
+    size = code + (size_t) ncode * 4;
+  RgxCapture * x = size > UINT32_MAX ? NULL : calloc (1, size);
+  if (!x) {
+    error ("rgx capture : out of memory");
+    return RGXOOM;
+  }
+  uint32_t * map = allocate (nstates * sizeof (uint32_t)),
+    k [2] = { 1, n - nacc };
+  for (int i=0; i<nstates; ++i)
+    map [i] = k [SIG (states [i]) [0] >= 0]++;
+
+  *x = (RgxCapture) {
+    .size = size, .ngroups = ngroups, .nregs = 1 + nslots * ntags,
+    .nstates = n, .nclass = nc, .start = map [1] * nc,
+    .accept = (n - nacc) * nc, .next = next, .ops = ops,
+    .final = final, .code = code,
+    .begin = { begin, SIG (states [0]) [nc + 1] }
+  };
+  for (int c=0; c<256; ++c)
+    x->class [c] = class [c];
+  uint32_t * tn = (uint32_t *) ((char *) x + next),
+    * to = (uint32_t *) ((char *) x + ops);
+  int32_t * tf = (int32_t *) ((char *) x + final);
+  tf [0] = -1;
+  for (int i=0; i<nstates; ++i) {
+    int * s = SIG (states [i]);
+    uint32_t r = map [i] * nc;
+    tf [map [i]] = s [0];
+    for (uint32_t c=0; c<nc; ++c) {
+      DState * d = states [i]->next [c];
+      tn [r + c] = d ? map [d->i] * nc : 0;
+      to [r + c] = d ? s [1 + c] : 0;
+    }
+  }
+  memcpy ((char *) x + code, tcode, ncode * sizeof (int));
+  deallocate (map, nstates * sizeof (uint32_t));
+  *cap = x;
+  return 0;
+  #undef SIG
+}
+
+static int capture_compile ( char * rgx, RgxCapture ** cap ) {
+  int rpn [RGXSIZE], ngroups = 0, status, begin = 0, * sig = NULL;
+  State * nfa;
+  DState * dfa;
+  rgx_rpn_groups (1);
+  if ( (status = rgx_rpn (rgx, rpn)) >= RGXEOE )
+    for (int i=0; rpn [i] >= 0; ++i)
+      if ( rpn [i] == RGXOP ('(') && rpn [i+1] > ngroups )
+        ngroups = rpn [++i];
+  if (status < RGXEOE || ngroups > RGXGROUPS) {
+    rgx_rpn_groups (0);
+    if (status < RGXEOE)
+      error ("rgx capture : cannot make rpn for rgx \"%s\"", rgx);
+    else
+      error ("rgx capture : more than %d groups", RGXGROUPS);
+    return RGXERR;
+  }
+  nfa_reset (&rgx, 1);
+  class_get (&class, &nclass);
+  ntnfa = rgx_nfa (rgx, &nfa, 1);
+  rgx_rpn_groups (0);
+  if (ntnfa < 0)
+    return ntnfa;
+
+  ntags = 2 * ngroups;
+  nslots = nthash = nlists = 0;
+  ncode = maxcode = 1;
+  size_t regs = 1 + (size_t) ntnfa * ntags;
+  tcode   = calloc (1, sizeof (int));
+  tseen   = malloc (BITBYTES (ntnfa));
+  tpath   = malloc ((2 * ntnfa + 2) * sizeof (TPath));
+  tfrom   = malloc (ntnfa * sizeof (int));
+  tkey    = malloc (regs * sizeof (int) + ntnfa * sizeof (int));
+  tval    = malloc (ntnfa * sizeof (int));
+  treg    = malloc (regs * sizeof (int));
+  tset    = malloc (ntnfa * sizeof (uint64_t));
+  treads  = calloc (regs, sizeof (int));
+  twriter = malloc (regs * sizeof (int));
+  tmoves  = malloc (9 * regs * sizeof (int));      /* refer tdfa_ops */
+  Stack * Q = stack_new (0);
+  if (!tcode || !tseen || !tpath || !tfrom || !tkey || !tval ||
+    !treg || !tset || !treads || !twriter || !tmoves) {
+    error ("rgx capture : out of memory");
+    status = RGXOOM;
+  }
+  else {
+    memset (twriter, -1, regs * sizeof (int));
+    int n = 6;
+    while ((1<<n) < ntnfa && n < 14) n++;
+    hsize = htable_size (1 << n);
+    hcount = 0;
+    htable = allocate ( hsize * sizeof (DState *) );
+    status = tdfa_tree (nfa, Q, &begin);
+  }
+  if (status >= 0) {
+    int nq = prune ? dfa_prune (Q) : Q->nentries;
+    int nsig = tdfa_signatures ((DState **) Q->stack, nq, &sig);
+    status = nsig < 0 ? nsig : dfa_minimise (Q, &dfa, nsig);
+    Q = NULL;                               /* freed by dfa_minimise */
+  }
+  if (status >= 0)
+    status = capture_create (sig, ngroups, begin, cap);
+  stack_free (Q);
+  free (sig); free (tseen); free (tpath); free (tfrom); free (tkey);
+  free (tval); free (treg);
+  free (tset); free (treads); free (twriter); free (tmoves);
+  free (tcode); free (thash);
+  tcode = thash = NULL;
+  return status;
+}
+
+int rgx_capture_compile ( char * rgx, RgxCapture ** cap ) {
+  pthread_mutex_lock (&compiling);
+  int status = capture_compile (rgx, cap);
+  pthread_mutex_unlock (&compiling);
+  return status;
+}
+
+/*
+.. Operations (refer RgxCapture) at the position "pos"
+*/
+static inline void capture_ops ( const int32_t * op, long * reg,
+  long pos )
+{
+  for (int32_t n = *op++; n--; op += 2)
+    reg [op [0]] = op [1] < 0 ? pos : reg [op [1]];
+}
+
+int rgx_capture_match ( const RgxCapture * x, const char * buf,
+  size_t len, long * sub )
+{
+  const char * base = (const char *) x;
+  const uint32_t * next = (const uint32_t *) (base + x->next),
+    * ops = (const uint32_t *) (base + x->ops);
+  const int32_t * final = (const int32_t *) (base + x->final),
+    * code = (const int32_t *) (base + x->code);
+  const uint8_t * cls = x->class;
+  uint32_t s = x->start, acc = x->accept, nc = x->nclass, r,
+    nsub = 2 * x->ngroups;
+  long local [256], * reg = x->nregs <= 256 ? local :
+    malloc (x->nregs * sizeof (long)), end = -1;
+  if (!reg) {
+    error ("rgx capture : out of memory");
+    return RGXOOM;
+  }
+  for (uint32_t i=0; i<x->nregs; ++i)
+    reg [i] = -1;
+  for (uint32_t i=0; i<nsub + 2; ++i)
+    sub [i] = -1;
+  capture_ops (code + x->begin [0], reg, 0);
+  capture_ops (code + x->begin [1], reg, 0);
+
+  /*
+  .. The groups are saved, when a run of accepting states ends (before
+  .. the operations of the transition overwrite them)
+  */
+  #define SAVE(_i_)                                                   \
+    do {                                                              \
+      const int32_t * f = code + final [s / nc] + 1;                  \
+      end = _i_;                                                      \
+      for (uint32_t k=0; k<nsub; ++k)                                 \
+        sub [2 + k] = reg [f [k]];                                    \
+    } while (0)
+
+  size_t i;
+  for (i=0; i<len; ++i) {
+    r = s + cls [(uint8_t) buf [i]];
+    if ( s >= acc && next [r] < acc )
+      SAVE (i);
+    if ( !(s = next [r]) )
+      break;
+    if ( ops [r] )
+      capture_ops (code + ops [r], reg, i + 1);
+  }
+  if (s >= acc)
+    SAVE (i);
+  #undef SAVE
+
+  if (reg != local)
+    free (reg);
+  if (end < 0) {
+    memset (sub + 2, -1, nsub * sizeof (long));
+    return 0;
+  }
+  sub [0] = 0;
+  sub [1] = end;
+  return (int) (end + 1);
+}
+
 /* ...................................................................
 .. ...................................................................
 .. ........  Algorithms related to table compression .................
@@ -713,9 +2640,9 @@ int dfa_tables (int *** tables, int ** tsize) {
   len [2] = len [3] = len [4] = m + 1;      /* can hold index : [m] */
   len [5] = n;  len [6] = 256;
 
-  int * base = allocate (m * sizeof (int)),
-    * accept = allocate (m * sizeof (int)),
-    * def = allocate (m * sizeof (int)),
+  int * base = allocate ((m+1) * sizeof (int)),
+    * accept = allocate ((m+1) * sizeof (int)),
+    * def = allocate ((m+1) * sizeof (int)),
     * meta = allocate (n * sizeof (int));
   /*
   .. Compressed tables, t[0] = check[], t[1] = next;
@@ -739,7 +2666,14 @@ int dfa_tables (int *** tables, int ** tsize) {
     "\n  no: of tokens   %3d"
     "\n  no: of eq class %3d (excluding EOF, EOL, BOL, BOL)"
     "\n  table sizes     %3d (check[], next[])"
-    "\n", nstates, num_actions, nclass - BCLASSES, len[0] ); 
+    "\n  %s %3d"
+    "\n  subset constr.  %.3f ms, %zu kB"
+    "\n", nstates, num_actions, nclass - BCLASSES, len[0],
+    positions ? "positions      " : "nfa states     ", construction.nnfa,
+    construction.ms, construction.bytes >> 10 ); 
+  if (construction.pruned)
+    printf ("  pruned states   %3d (doomed or unreachable)\n",
+      construction.pruned);
   #endif
 
   return 0;
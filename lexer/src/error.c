@@ -4,16 +4,21 @@
 #include <string.h>
 #include <limits.h>
 #include <assert.h>
+#include <pthread.h>
 
 #include "regex.h"
-#include "allocator.h"
 
 typedef struct Error {
   struct Error * next;
   char * msg;
 } Error;
 
+/*
+.. The errors are malloc'ed (and not in the pool), so that they are
+.. kept by allocator_release (), and the list is shared by the threads.
+*/
 static Error * list = NULL;
+static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
 
 void error ( const char * err, ... ) {
   char msg [256];
@@ -22,22 +27,26 @@ void error ( const char * err, ... ) {
   vsnprintf (msg, sizeof (msg), err, args);
   va_end(args);
 
-  Error * e =  allocate (sizeof (Error));
-  e->msg = allocate_str (msg);
+  Error * e =  malloc (sizeof (Error) + strlen (msg) + 1);
+  if (!e)
+    return;
+  e->msg = strcpy ((char *) (e + 1), msg);
+  pthread_mutex_lock (&lock);
   e->next = list;
-  
   list = e;
+  pthread_mutex_unlock (&lock);
 }
 
 void errors ( ) {
+  pthread_mutex_lock (&lock);
   Error * e = list, * next;
+  list = NULL;
+  pthread_mutex_unlock (&lock);
   while (e) {
     next = e->next;
     fprintf (stderr, "\n  %s", e->msg);
-    deallocate (e->msg, strlen (e->msg) + 1);
-    deallocate (e, sizeof (Error));
+    free (e);
     e = next;
   }
-  list = NULL;
   fflush (stderr);
 }
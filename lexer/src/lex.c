@@ -15,6 +15,11 @@ flex file.l*/
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <limits.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <time.h>
 
 #include "stack.h"
 #include "allocator.h"
@@ -27,6 +32,43 @@ void lxr_debug () {
   isdebug = 1;
 }
 
+static const char * cachedir = NULL;
+void lxr_cache ( const char * dir ) {
+  cachedir = dir;
+}
+
+static int maxdepth = 1;
+void lxr_depth ( int depth ) {
+  maxdepth = depth < 0 ? 0 : depth;
+  rgx_table_depth (maxdepth);
+}
+
+static int optimize = 0;
+void lxr_optimize ( int nthreads ) {
+  optimize = nthreads > 0;
+  rgx_table_optimize (nthreads);
+}
+
+static int backend = LXRAUTO;
+void lxr_backend ( int b ) {
+  backend = b;
+}
+
+static int stride = 1;
+void lxr_stride ( int n ) {
+  stride = n == 2 ? 2 : 1;
+}
+
+static const char * tablefile = NULL;
+void lxr_table_file ( const char * file ) {
+  tablefile = file;
+}
+
+static const char * sample = NULL;
+void lxr_sample ( const char * file ) {
+  sample = file;
+}
+
 static FILE * out = NULL;
 static FILE * in = NULL;
 
@@ -553,6 +595,7 @@ int _pattern (char * rgx, size_t lim) {
         int k = 0;
         c = fgetc (in);
         if (c == ',' || (c >= '0' && c <= '9')) {
+          rgx [len++] = '{';                /* quantifier x{m,n} */
           rgx [len++] = c;
           continue;
         }
@@ -777,6 +820,463 @@ int lex_read_rules ( ) {
   return 0;  
 }
 
+/* ...................................................................
+.. ...................................................................
+.. ..............  cache of the compressed tables  ...................
+.. ...................................................................
+.. .................................................................*/
+
+/*
+.. The tables depend only on the rule patterns (after the macros are
+.. expanded), the def[] depth, the optimization of the compression and
+.. the version of lxr, and not on the actions. So the compressed tables
+.. are cached in the directory set by lxr_cache (), in a file named
+.. after a hash of the "key". The key is the lxr version, the depth,
+.. the optimization, the definition macros and the rule patterns in
+.. order. The full key is also stored in the file and compared while
+.. loading, so a hash collision is never mistaken for a hit.
+..
+.. File layout : "LXRC", key length, key, eol used, 7 table lengths
+.. (-1 for an absent table) followed by the 7 tables.
+*/
+#define NTABLES 7
+
+typedef struct Key {
+  char * s;
+  size_t len, max;
+} Key;
+
+static void key_add ( Key * k, const char * s, size_t len ) {
+  if (k->len + len > k->max) {
+    size_t max = 2 * (k->len + len) + 256;
+    k->s = realloc (k->s, max);                 /* may exceed a page */
+    if (!k->s) {
+      error ("Out of memory");
+      exit (-1);
+    }
+    k->max = max;
+  }
+  memcpy (& k->s [k->len], s, len);
+  k->len += len;
+}
+
+static Key cache_key ( ) {
+  Key k = {0};
+  char version [64];
+  sprintf (version, "lxr " LXR_VERSION " depth %d optimize %d\n",
+    maxdepth, optimize);
+  key_add (&k, version, strlen (version));
+  for (int i=0; i<prime; ++i)
+    for (Macro * m = table [i]; m; m = m->next) {
+      key_add (&k, m->key, strlen (m->key) + 1);
+      key_add (&k, m->rgx, strlen (m->rgx) + 1);
+    }
+  key_add (&k, "%%\n", 3);
+  Action ** A = (Action **) actions->stack;
+  for (int i=0; i < actions->len / sizeof (void *); ++i)
+    key_add (&k, A[i]->rgx, strlen (A[i]->rgx) + 1);
+  return k;
+}
+
+static char * cache_file ( Key * k, const char * ext ) {
+  uint64_t h = 14695981039346656037ull;                 /* FNV-1a */
+  for (size_t i=0; i<k->len; ++i)
+    h = (h ^ (unsigned char) k->s[i]) * 1099511628211ull;
+  char buff [64];
+  sprintf (buff, "/%016llx%s", (unsigned long long) h, ext);
+  char * f = allocate (strlen (cachedir) + strlen (buff) + 1);
+  strcat (strcpy (f, cachedir), buff);
+  return f;
+}
+
+static int cache_load ( Key * k, int *** tables, int ** tsize,
+  int * eol )
+{
+  char * file = cache_file (k, ".lxc"), magic [4];
+  FILE * fp = fopen (file, "rb");
+  if (!fp) return 0;
+
+  #define READ(_p,_s)                                                 \
+    if (fread (_p, 1, _s, fp) != (_s)) {                              \
+      fclose (fp); return 0;                                          \
+    }
+  size_t len;
+  READ (magic, 4);
+  READ (&len, sizeof (size_t));
+  if ( memcmp (magic, "LXRC", 4) || len != k->len ) {
+    fclose (fp); return 0;
+  }
+  char * key = malloc (len);
+  if ( !key || fread (key, 1, len, fp) != len ||
+    memcmp (key, k->s, len) ) {
+    free (key); fclose (fp); return 0;
+  }
+  free (key);
+
+  int ** t = allocate ( NTABLES * sizeof (int *) );
+  int * l = allocate ( NTABLES * sizeof (int) );
+  READ (eol, sizeof (int));
+  READ (l, NTABLES * sizeof (int));
+  for (int i=0; i<NTABLES; ++i) {
+    if (l[i] < 0) { l[i] = 0; continue; }
+    t[i] = allocate ( (l[i] ? l[i] : 1) * sizeof (int) );
+    READ (t[i], l[i] * sizeof (int));
+  }
+  #undef READ
+
+  fclose (fp);
+  *tables = t; *tsize = l;
+  return 1;
+}
+
+static void cache_store ( Key * k, int ** t, int * l, int eol ) {
+  if ( mkdir (cachedir, 0755) && errno != EEXIST ) {
+    error ("warning : cannot create cache directory %s", cachedir);
+    return;
+  }
+  char * file = cache_file (k, ".lxc"), tmp [64];
+  sprintf (tmp, ".tmp%ld", (long) getpid ());
+  char * part = cache_file (k, tmp);
+  FILE * fp = fopen (part, "wb");
+  if (!fp) {
+    error ("warning : cannot write cache %s", part);
+    return;
+  }
+  int len [NTABLES], status = 1;
+  for (int i=0; i<NTABLES; ++i)
+    len [i] = t[i] ? l[i] : -1;
+  status &= fwrite ("LXRC", 1, 4, fp) == 4;
+  status &= fwrite (&k->len, sizeof (size_t), 1, fp) == 1;
+  status &= fwrite (k->s, 1, k->len, fp) == k->len;
+  status &= fwrite (&eol, sizeof (int), 1, fp) == 1;
+  status &= fwrite (len, sizeof (int), NTABLES, fp) == NTABLES;
+  for (int i=0; i<NTABLES; ++i)
+    if (t[i])
+      status &= fwrite (t[i], sizeof (int), l[i], fp) == l[i];
+  status &= !fclose (fp);
+  if ( !status || rename (part, file) ) {
+    remove (part);
+    error ("warning : cannot write cache %s", file);
+  }
+}
+
+/*
+.. Tables of a large dfa (like state numbers >= 2^15) don't fit in
+.. a short. Such tables are written as int (assumed to be 32 bits)
+*/
+static char * table_type ( int * arr, int l ) {
+  for (int j=0; arr && j<l; ++j)
+    if (arr [j] > SHRT_MAX || arr [j] < SHRT_MIN)
+      return "int";
+  return "short";
+}
+
+static size_t table_size ( const char * type ) {
+  return !strcmp (type, "int") ? sizeof (int) :
+    !strcmp (type, "short") ? sizeof (short) : 1;
+}
+
+static void table_print ( const char * type, const char * name,
+  int * arr, int l )
+{
+  char buff [256];
+  sprintf ( buff, "\n\nstatic %s lxr_%s [%d] = {\n", type, name, l );
+  echo (buff);
+  for (int j=0; j<l; ++j) {
+    sprintf ( buff, " %4d%s", arr[j], j == l-1 ? "" : ",");
+    echo (buff);
+    if (j%10 == 0)   echo ("\n");
+    if (j%100 == 0)  echo ("\n");
+  }
+  echo ("\n};");
+}
+
+/* ...................................................................
+.. ...................................................................
+.. .....................  binary table file  ..........................
+.. ...................................................................
+.. .................................................................*/
+
+/*
+.. Layout of the table file. Refer src/lxr/tables.c. The header has
+.. the magic, version, header size, TVALUES values from the word
+.. TVALUE0, and (offset, length, element size) of TTABLES tables.
+*/
+#define TVALUES         12
+#define TVALUE0          4
+#define TTABLES         14
+#define THEADER        256                     /* ≥ 4 * (16 + 3 * 14) */
+#define TALIGN          64
+
+typedef struct {
+  const char * name, * type;
+  int * arr;
+  uint64_t * wide;                                /* (bmap [] only) */
+  int len;
+} Table;
+
+/*
+.. Write the tables "t" to the table file, which is mapped by the
+.. generated lexer at run time. Only the pointers to the tables, and
+.. a macro to set them from the mapped file, are written to the lexer.
+*/
+static int tables_write ( Table * t, int * value ) {
+  int32_t head [THEADER / 4] = {0};
+  memcpy (head, "lxrtable", 8);
+  head [2] = LXR_TABLES_VERSION;
+  head [3] = THEADER;
+  memcpy (head + TVALUE0, value, TVALUES * sizeof (int32_t));
+  size_t offset = THEADER;
+  for (int i=0; i<TTABLES; ++i) {
+    if (!t [i].len) continue;
+    size_t size = t [i].wide ? sizeof (uint64_t) : table_size (t [i].type);
+    head [16 + 3*i] = (int32_t) offset;
+    head [17 + 3*i] = t [i].len;
+    head [18 + 3*i] = (int32_t) size;
+    offset += (t [i].len * size + TALIGN - 1) / TALIGN * TALIGN;
+  }
+  if (offset > INT32_MAX) {
+    error ("table file : tables larger than 2 GB");
+    return RGXERR;
+  }
+
+  char * part = allocate (strlen (tablefile) + 8);
+  sprintf (part, "%s.part", tablefile);
+  FILE * fp = fopen (part, "wb");
+  if (!fp) {
+    error ("cannot write table file %s", part);
+    return RGXERR;
+  }
+  int status = fwrite (head, 1, THEADER, fp) == THEADER;
+  for (int i=0; status && i<TTABLES; ++i) {
+    if (!t [i].len) continue;
+    size_t size = head [18 + 3*i];
+    char * b = allocate ( (t [i].len * size + TALIGN - 1) / TALIGN *
+      TALIGN );
+    for (int j=0; j<t [i].len; ++j) {
+      if (t [i].wide)
+        ((uint64_t *) b) [j] = t [i].wide [j];
+      else if (size == sizeof (int))
+        ((int *) b) [j] = t [i].arr [j];
+      else if (size == sizeof (short))
+        ((short *) b) [j] = (short) t [i].arr [j];
+      else
+        ((unsigned char *) b) [j] = (unsigned char) t [i].arr [j];
+    }
+    size_t l = (t [i].len * size + TALIGN - 1) / TALIGN * TALIGN;
+    status &= fwrite (b, 1, l, fp) == l;
+    deallocate (b, l);
+  }
+  status &= !fclose (fp);
+  if ( !status || rename (part, tablefile) ) {
+    remove (part);
+    error ("cannot write table file %s", tablefile);
+    return RGXERR;
+  }
+  printf ("\nstats : tables written to %s (%zu bytes)\n", tablefile,
+    offset);
+
+  char buff [1024];
+  sprintf ( buff,
+    "\n\n/*"
+    "\n.. The tables are mapped from the file lxr_tables_file (or the"
+    "\n.. file $LXR_TABLES) at run time. Refer lxr_tables ()."
+    "\n*/"
+    "\n#define lxr_tables_file    \"%s\""
+    "\n#define lxr_tables_version %d"
+    "\n#define lxr_ntokens        %d"
+    "\n",
+    tablefile, LXR_TABLES_VERSION, value [0] );
+  echo (buff);
+  for (int i=0; i<TTABLES; ++i) {
+    if (!t [i].len) continue;
+    sprintf (buff, "\nstatic const %s * lxr_%s;", t [i].type,
+      t [i].name);
+    echo (buff);
+  }
+  echo ("\n\nstatic const int lxr_tables_elem [] = {");
+  for (int i=0; i<TTABLES; ++i) {
+    sprintf (buff, " %d%s", head [18 + 3*i], i == TTABLES-1 ? "" : ",");
+    echo (buff);
+  }
+  echo (" };\n\n#define lxr_tables_bind(_m, _h)"
+    "                                      \\\n  do {"
+    "                                                               \\");
+  for (int i=0; i<TTABLES; ++i) {
+    if (!t [i].len) continue;
+    sprintf (buff, "\n    lxr_%s = (const %s *) ((_m) + (_h) [%d]);",
+      t [i].name, t [i].type, 16 + 3*i);
+    int l = (int) strlen (buff);
+    sprintf (buff + l, "%*s\\", l < 70 ? 70 - l : 1, "");
+    echo (buff);
+  }
+  echo ("\n  } while (0)\n");
+
+  fflush (in);
+  return 0;
+}
+
+/* ...................................................................
+.. ...................................................................
+.. ..............  choice of the encoding of the tables  ..............
+.. ...................................................................
+.. .................................................................*/
+
+/*
+.. A transition is a chain of dependent loads. For the comb encoding
+.. base[], check[], next[] and 3 more loads for each fallback to
+.. def[]. For the bitmap encoding bmap[], boff[] and target[]. Each
+.. load is assumed to cost the latency of the cache level, which can
+.. hold all the tables. On top of the loads, the comb encoding has a
+.. compare for each check[] probe, and the bitmap encoding a bit test,
+.. a mask and a popcount (a bit twiddling routine unless the lexer is
+.. compiled for a target with a popcount instruction, so POPCOUNT
+.. cycles). If the estimates are within ENCODING_TIE, the smaller
+.. tables are chosen. If a sample input is given, each encoding is
+.. also timed by walking the dfa on it, and then the fastest encoding
+.. is chosen.
+*/
+#define POPCOUNT     8
+#define ENCODING_TIE 0.1
+
+typedef struct Encoding {
+  const char * name;
+  size_t bytes;                             /* size of all the tables */
+  double loads;                       /* average loads per transition */
+  double ops;                    /* average ALU cycles per transition */
+  double cycles;                  /* estimated cycles per transition */
+  double mbs;                           /* MB/s on the sample, if any */
+} Encoding;
+
+static size_t cache_size ( int level ) {
+  long size = -1;
+  #if defined (_SC_LEVEL1_DCACHE_SIZE) && defined (_SC_LEVEL2_CACHE_SIZE)
+  size = sysconf (level == 1 ? _SC_LEVEL1_DCACHE_SIZE :
+    _SC_LEVEL2_CACHE_SIZE);
+  #endif
+  return size > 0 ? (size_t) size : (level == 1 ? 32 : 256) << 10;
+}
+
+static const char * cache_level ( Encoding * e ) {
+  size_t l1 = cache_size (1), l2 = cache_size (2);
+  e->cycles = e->ops +
+    e->loads * (e->bytes <= l1 ? 4 : e->bytes <= l2 ? 12 : 40);
+  return e->bytes <= l1 ? "L1" : e->bytes <= l2 ? "L2" : "> L2";
+}
+
+/*
+.. Time the walk of the dfa, restarting from state 1 when rejected, on
+.. (the first SAMPLEBYTES of) the sample input, for each encoding.
+*/
+#define SAMPLEBYTES (1 << 24)
+static volatile int sink;
+static void sample_time ( int ** t, int * len, uint64_t * bmap, 
+  int * boff, int * target, Encoding * e, int nenc )
+{
+  FILE * fp = fopen (sample, "rb");
+  if (!fp) {
+    error ("warning : cannot read sample input %s", sample);
+    return;
+  }
+  unsigned char * txt = malloc (SAMPLEBYTES);
+  size_t n = txt ? fread (txt, 1, SAMPLEBYTES, fp) : 0;
+  fclose (fp);
+  for (size_t i=0; i<n; ++i)
+    txt [i] = (unsigned char) t [6][txt [i]];
+
+  for (int k=0; n && k<nenc; ++k) {
+    size_t total = 0;
+    clock_t c0 = clock ();
+    while (total < SAMPLEBYTES) {
+      int s = 1, c;
+      for (size_t i=0; i<n; ++i) {
+        c = txt [i];
+        if (k == 0)
+          s = table_delta (t, len, maxdepth, s, c, NULL);
+        else
+          s = (bmap [s] >> c & 1) ? target [boff [s] +
+            __builtin_popcountll (bmap [s] & ((1ull << c) - 1))] : 0;
+        s = s ? s : 1;
+      }
+      sink = s;
+      total += n;
+    }
+    double sec = (double) (clock () - c0) / CLOCKS_PER_SEC;
+    e [k].mbs = total / 1e6 / (sec > 0 ? sec : 1e-9);
+  }
+  free (txt);
+}
+
+static int encoding_choose ( int ** t, int * len, char ** type,
+  uint64_t * bmap, int * boff, int * target, int ntarget, int forced )
+{
+  Encoding e [2] = {
+    { "comb  ", 0, 0, 0, 0, -1 }, { "bitmap", 0, 0, 0, 0, -1 }
+  };
+  int m = len [3], nc = len [5], nenc = ntarget < 0 ? 1 : 2;
+  for (int i=0; i<7; ++i)
+    e[0].bytes += len [i] * (i < 5 ? table_size (type [i]) : 1);
+  e[1].bytes = m * sizeof (uint64_t) + len [6] +
+    m * table_size (table_type (boff, m)) +
+    ntarget * table_size (table_type (target, ntarget)) +
+    m * table_size (type [3]);
+
+  /*
+  .. averaged over the live transitions, as a token is a sequence of
+  .. live transitions ending with a single DEAD transition
+  */
+  int nlive = 0;
+  for (int s=1; s<m; ++s)
+    for (int c=0; c<nc; ++c) {
+      int hops, q = table_delta (t, len, maxdepth, s, c, &hops);
+      if (!q) continue;
+      e[0].loads += 3 + 3 * hops;
+      e[0].ops += 1 + hops;
+      e[1].loads += 3;
+      e[1].ops += 2 + POPCOUNT;
+      nlive++;
+    }
+  for (int k=0; k<nenc; ++k) {
+    e[k].loads /= nlive ? nlive : 1;
+    e[k].ops /= nlive ? nlive : 1;
+  }
+
+  if (sample)
+    sample_time (t, len, bmap, boff, target, e, nenc);
+
+  int best = 0, tie = 0;
+  printf ("\nstats : encoding of the tables");
+  for (int k=0; k<nenc; ++k) {
+    const char * level = cache_level (&e[k]);
+    printf ("\n  %s %8zu bytes, %-4s %5.2f loads, %6.1f cycles",
+      e[k].name, e[k].bytes, level, e[k].loads, e[k].cycles);
+    if (e[k].mbs >= 0)
+      printf (", %8.1f MB/s", e[k].mbs);
+    if (!k) continue;
+    if (e[k].mbs >= 0) {
+      if (e[k].mbs > e[best].mbs) best = k;
+      continue;
+    }
+    double lo = e[k].cycles < e[best].cycles ? e[k].cycles :
+      e[best].cycles;
+    tie = e[k].cycles - e[best].cycles <= ENCODING_TIE * lo &&
+      e[best].cycles - e[k].cycles <= ENCODING_TIE * lo;
+    if ( tie ? e[k].bytes < e[best].bytes :
+      e[k].cycles < e[best].cycles )
+      best = k;
+  }
+  if (nenc == 1)
+    printf ("\n  bitmap : not possible, %d classes (> 64)", nc);
+  if (forced != LXRAUTO)
+    best = forced == LXRBITMAP;
+  printf ("\n  chosen : %s (%s)\n", e[best].name,
+    forced != LXRAUTO ? "-b flag" : e[best].mbs >= 0 ?
+    "fastest on the sample input" : tie ?
+    "smaller tables, estimated cycles within 10%" :
+    "lowest estimated cycles per transition");
+  return best ? LXRBITMAP : LXRCOMB;
+}
+
 /*
 .. Create DFA from regex patterns, create the compressed tables for
 .. lexical analysis and print the tables
@@ -784,22 +1284,39 @@ int lex_read_rules ( ) {
 static int lex_print_tables () {
 
   int nrgx = (int) ( actions->len / sizeof (void *) );
-  char ** rgx = allocate ( nrgx * sizeof (char *) );
-  Action ** A = (Action **) actions->stack;
-  for (int i=0; i<nrgx; ++i)
-    rgx [i] = A[i]->rgx;
-  
-  DState * dfa = NULL;
-  if (rgx_lexer_dfa (rgx, nrgx, &dfa) < 0) {       /* Minimised DFA */
-    error ("failed to create a minimal dfa");
-    return RGXERR;
+  int ** tables, * len, eol, cached = 0;
+  Key key;
+
+  if (cachedir) {
+    key = cache_key ();
+    cached = cache_load (&key, &tables, &len, &eol);
+    if (cached)
+      printf ("\nstats : tables read from cache %s\n", cachedir);
   }
 
-  int ** tables, * len;
-  if (dfa_tables (&tables, &len) < 0) {  /* comprssd tbles from DFA */
-    error ("Table size Out of memory limit");
-    return RGXOOM;
+  if (!cached) {
+    char ** rgx = allocate ( nrgx * sizeof (char *) );
+    Action ** A = (Action **) actions->stack;
+    for (int i=0; i<nrgx; ++i)
+      rgx [i] = A[i]->rgx;
+  
+    DState * dfa = NULL;
+    if (rgx_lexer_dfa (rgx, nrgx, &dfa) < 0) {     /* Minimised DFA */
+      error ("failed to create a minimal dfa");
+      return RGXERR;
+    }
+
+    if (dfa_tables (&tables, &len) < 0) {/* comprssd tbles from DFA */
+      error ("Table size Out of memory limit");
+      return RGXOOM;
+    }
+    eol = dfa_eol_used ();
+
+    if (cachedir)
+      cache_store (&key, tables, len, eol);
   }
+  if (cachedir)
+    free (key.s);
 
   char * names [] = {
     "check", "next", "base", "accept", "def", "meta", "class"
@@ -809,9 +1326,55 @@ static int lex_print_tables () {
     "short", "short", "short", "short", "short",
     "unsigned char", "unsigned char"
   };
+  for (int i=0; i<5; ++i)
+    type [i] = table_type (tables [i], len [i]);
+
+  /*
+  .. Bitmap encoding of the transitions (refer dfa_bitmap ()), which
+  .. replaces check[], next[], base[], def[] and meta[]. It's created
+  .. if asked for, or as a candidate for the automatic choice.
+  */
+  uint64_t * bmap = NULL;
+  int * boff = NULL, * target = NULL, ntarget = -1, enc = backend;
+  if ( backend == LXRBITMAP || (backend == LXRAUTO && len [5] <= 64) )
+    ntarget = dfa_bitmap (tables, len, maxdepth, &bmap, &boff, &target);
+  if (backend == LXRBITMAP && ntarget < 0) {
+    error ("failed creating bitmap tables");
+    return RGXERR;
+  }
+  if (backend != LXRCOMB)
+    enc = encoding_choose (tables, len, type, bmap, boff, target,
+      ntarget, backend);
+
+  /*
+  .. Two byte stride tables for the states of long tokens (refer
+  .. dfa_pairs ()). They are used along with either encoding.
+  */
+  int * pclass = NULL, * pidx = NULL, * pair = NULL, npair = 0,
+    npclass = 0;
+  if (stride == 2)
+    npair = dfa_pairs (tables, len, maxdepth, &pclass, &pidx, &pair,
+      &npclass);
 
   int nclass = len [5], * class = tables [6];
-  
+
+  /*
+  .. The values below are compiled in, or (with a table file) read
+  .. from its header (refer src/lxr/tables.c). So "V[i]" is either
+  .. the value or the header word.
+  */
+  int value [TVALUES] = {
+    nrgx, nclass, class ['\n'], EOB_CLASS, eol ? EOL_CLASS : 0,
+    EOF_CLASS, maxdepth, len [3], len [2] - len [3], enc == LXRBITMAP,
+    npair, npclass
+  };
+  char V [TVALUES][32];
+  for (int i=0; i<TVALUES; ++i)
+    if (tablefile)
+      sprintf (V [i], "((int) lxr_hdr [%d])", TVALUE0 + i);
+    else
+      sprintf (V [i], "%3d", value [i]);
+
   char buff [1024]; 
   sprintf ( buff, 
     "\n/*"
@@ -823,13 +1386,13 @@ static int lex_print_tables () {
     "\n.. case of BOL status. lxr_eol_class will be set to 0 in case"
     "\n.. no patterns are found with EOL requirement."
     "\n*/"
-    "\n#define lxr_nclass       %3d          /* num of eq classes */"
-    "\n#define lxr_nel_class    %3d          /* new line  '\\n'    */"
-    "\n#define lxr_eob_class    %3d          /* end of buffer     */"
-    "\n#define lxr_eol_class    %3d          /* end of line       */"
-    "\n#define lxr_eof_class    %3d          /* end of file       */",
-    nclass, class ['\n'], EOB_CLASS,
-    dfa_eol_used () ? EOL_CLASS : 0, EOF_CLASS );
+    "\n#define lxr_nclass       %s          /* num of eq classes */"
+    "\n#define lxr_nel_class    %s          /* new line  '\\n'    */"
+    "\n#define lxr_eob_class    %s          /* end of buffer     */"
+    "\n#define lxr_eol_class    %s          /* end of line       */"
+    "\n#define lxr_eof_class    %s          /* end of file       */"
+    "\n#define lxr_eol_used     %3d          /* EOL anchor used   */",
+    V [1], V [2], V [3], V [4], V [5], eol != 0 );
   echo (buff);
 
   sprintf ( buff, 
@@ -843,20 +1406,92 @@ static int lex_print_tables () {
     nrgx, nrgx + 1, nrgx + 2 );
   echo (buff);
 
+  sprintf ( buff,
+    "\n\n/*"
+    "\n.. A transition not found in the row of a state falls back to"
+    "\n.. lxr_def [state], atmost lxr_max_depth times. States starting"
+    "\n.. from lxr_template are template rows, which are indexed by the"
+    "\n.. meta class lxr_meta [class] instead of the class."
+    "\n*/"
+    "\n#define lxr_max_depth    %s          /* def[] chain depth */"
+    "\n#define lxr_template     %s          /* first template    */"
+    "\n#define lxr_ntemplates   %3d          /* num of templates  */",
+    V [6], V [7], value [8] );
+  echo (buff);
+
+  sprintf ( buff,
+    "\n\n/*"
+    "\n.. If lxr_bitmap, transitions are encoded as a bitmap of the live"
+    "\n.. classes, lxr_bmap [state], and the targets of the live classes"
+    "\n.. starting from lxr_target [lxr_boff [state]]."
+    "\n*/"
+    "\n#define lxr_bitmap       %3d          /* bitmap backend    */",
+    enc == LXRBITMAP );
+  echo (buff);
+
+  sprintf ( buff,
+    "\n\n/*"
+    "\n.. If lxr_npair, the states of long tokens (lxr_pidx [state] != 0)"
+    "\n.. read two bytes per lookup from the lxr_pair [] table, keyed on"
+    "\n.. the pair classes lxr_pclass [] of the two bytes."
+    "\n*/"
+    "\n#define lxr_npair        %3d          /* two byte stride   */"
+    "\n#define lxr_npclass      %s          /* num of pair class */",
+    npair, V [11] );
+  echo (buff);
+
   /*
-  .. write all tables, before main lexer function
+  .. The tables in the order of the table file (refer tables.c). A
+  .. table not used by the encoding has len 0.
   */
+  Table out [TTABLES] = {{0}};
   for (int i=0; i<7; ++i) {
-    int * arr = tables [i], l = len [i];
-    if (!arr) continue;
-    sprintf ( buff, "\n\nstatic %s lxr_%s [%d] = {\n",
-      type [i], names[i], l );
+    if (!tables [i]) continue;
+    if (enc == LXRBITMAP && i != 3 && i != 6) continue;
+    out [i] = (Table) { names [i], type [i], tables [i], NULL, len [i] };
+  }
+  if (enc == LXRBITMAP) {
+    out [7] = (Table) { "bmap", "unsigned long long", NULL, bmap, len [3] };
+    out [8] = (Table) { "boff", table_type (boff, len [3]), boff, NULL,
+      len [3] };
+    out [9] = (Table) { "target", table_type (target, ntarget), target,
+      NULL, ntarget ? ntarget : 1 };
+  }
+  if (npair) {
+    int l = 2 * npair * npclass * npclass;
+    out [10] = (Table) { "pclass", "unsigned char", pclass, NULL, len [5] };
+    out [11] = (Table) { "pidx", table_type (pidx, len [3]), pidx, NULL,
+      len [3] };
+    out [12] = (Table) { "pair", table_type (pair, l), pair, NULL, l };
+  }
+  if (eol) {
+    int * eacc = NULL;
+    dfa_eol_accept (tables, len, maxdepth, &eacc);
+    out [13] = (Table) { "eol_accept", type [3], eacc, NULL, len [3] };
+  }
+
+  if (tablefile)
+    return tables_write (out, value);
+
+  /*
+  .. write all tables, before main lexer function
+  */
+  int order [TTABLES] = { 7, 8, 9, 10, 11, 12, 0, 1, 2, 3, 13, 4, 5, 6 };
+  for (int k=0; k<TTABLES; ++k) {
+    Table * t = & out [order [k]];
+    if (!t->len) continue;
+    if (!t->wide) {
+      table_print (t->type, t->name, t->arr, t->len);
+      continue;
+    }
+    sprintf ( buff, "\n\nstatic %s lxr_%s [%d] = {\n", t->type, t->name,
+      t->len );
     echo (buff);
-    for (int j=0; j<l; ++j) {
-      sprintf ( buff, " %4d%s", arr[j], j == l-1 ? "" : ",");
+    for (int j=0; j<t->len; ++j) {
+      sprintf ( buff, " 0x%016llxull%s", (unsigned long long) t->wide [j],
+        j == t->len-1 ? "" : ",");
       echo (buff);
-      if (j%10 == 0)   echo ("\n");
-      if (j%100 == 0)  echo ("\n");
+      if (j%4 == 0)   echo ("\n");
     }
     echo ("\n};");
   }
@@ -948,6 +1583,18 @@ int lex_print_source () {
   }
   fclose (source);
 
+  /* table file loader, lxr_tables () */
+  if (tablefile) {
+    source = fopen("./src/lxr/tables.c", "r");
+    if (!source)
+      return RGXERR;
+    while ((n = fread(buff, 1, sizeof(buff)-1, source)) > 0) {
+      buff [n] = '\0';
+      echo (buff);
+    }
+    fclose (source);
+  }
+
   source = fopen("./src/lxr/source.c", "r");
   if (!source)
     return RGXERR;
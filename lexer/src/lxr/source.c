@@ -14,8 +14,17 @@ typedef struct lxr_buff_stack {
   struct lxr_buff_stack * next; 
 } lxr_buff_stack ;
 
+/*
+.. With a table file, the tables (and the classes) are known only
+.. after it's mapped by lxr_tables_init ().
+*/
+#ifdef lxr_tables_file
+static unsigned char lxr_dummy[3];
+#else
+#define lxr_tables_init()
 static unsigned char
   lxr_dummy[3] = {lxr_eob_class, lxr_eob_class, lxr_eob_class};
+#endif
 static unsigned char * lxr_start = lxr_dummy;
 static unsigned char * lxr_bptr  = lxr_dummy;
 static unsigned char * lxr_class_buff = NULL;
@@ -52,6 +61,7 @@ void lxr_source (const char * in) {
 void lxr_read_bytes (const char * bytes, size_t len, int eob) {
   /* fixme : in case another byte source available */
   size_t size = len < lxr_size ? len : lxr_size;
+  lxr_tables_init ();
   lxr_buff_stack * bf = malloc (sizeof (lxr_buff_stack));
   char * b = malloc (size + 2);
   if (lxr_class_buff_size < size)
@@ -129,6 +139,7 @@ void lxr_clean () {
 .. [0x00, 0xFF]. Exception EOF
 */
 int lxr_input () {
+  lxr_tables_init ();
   if (*lxr_bptr == lxr_eob_class) {
     yytext [yyleng] = lxr_hold_char;
     lxr_buffer_update ();
@@ -164,6 +175,8 @@ int lxr_unput () {
 */
 static void lxr_buffer_update () {
 
+  lxr_tables_init ();
+
   if (lxr_in == NULL) {
     lxr_in = stdin;
     lxr_infile = strdup ("<stdin>");
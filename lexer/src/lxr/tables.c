@@ -0,0 +1,93 @@
+
+/*
+.. ------------------------- Table file -------------------------------
+.. The tables are read from a binary file (created by lxr -m file),
+.. which is mapped (read only, shared) at the first use. So the pages
+.. of the tables are shared by all the processes of the lexer, and the
+.. tables can be replaced without recompiling. The file is $LXR_TABLES
+.. if set, or else lxr_tables_file. The layout is (32 bit words, in
+.. the byte order of the machine that created it)
+..   [0, 2)   : magic "lxrtable"
+..   2        : version of the layout, lxr_tables_version
+..   3        : size of the file header in bytes
+..   [4, 16)  : number of tokens, classes, class of '\n', EOB, EOL and
+..              EOF classes, def[] chain depth, first template, number
+..              of templates, bitmap encoding (0/1), number of pair
+..              tables and pair classes.
+..   [16, 58) : offset (bytes), length and element size of each of the
+..              tables check, next, base, accept, def, meta, class,
+..              bmap, boff, target, pclass, pidx, pair, eol_accept
+..              (size 0 if the table is not used).
+.. Each table starts at a multiple of 64 bytes.
+..
+.. lxr_tables ( const char * file ) : replace the tables by those of
+..     the "file". The tokens (and so the actions) and the layout of
+..     the tables (encoding, templates, pairs, EOL and element sizes)
+..     should be the same as compiled in. Returns 0, or -1 (with the
+..     older tables kept) if "file" cannot be used. Call it before
+..     reading a source, or after lxr_clean (), as the bytes already
+..     read are stored as classes.
+*/
+#include <stdint.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+static const int32_t * lxr_hdr = NULL;
+static size_t lxr_hdr_size = 0;
+static unsigned char lxr_dummy[3];
+
+int lxr_tables ( const char * file ) {
+  const char * err = NULL, * map = MAP_FAILED;
+  struct stat st;
+  int fd = open (file, O_RDONLY);
+  if ( fd < 0 || fstat (fd, &st) || st.st_size < 58 * 4 ||
+    (map = mmap (NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0))
+      == MAP_FAILED ) {
+    fprintf (stderr, "lxr_tables () : cannot map %s\n", file);
+    if (fd >= 0) close (fd);
+    return -1;
+  }
+  close (fd);
+
+  const int32_t * h = (const int32_t *) map;
+  if ( memcmp (h, "lxrtable", 8) || h [2] != lxr_tables_version )
+    err = "not a table file of this version";
+  else if ( h [4] != lxr_ntokens || h [13] != lxr_bitmap ||
+    (h [8] != 0) != lxr_eol_used || (h [12] > 0) != (lxr_ntemplates > 0)
+    || (h [14] > 0) != (lxr_npair > 0) )
+    err = "tables of another lexer (or layout). recompile the lexer";
+  for (int i=0; !err && i<14; ++i) {
+    const int32_t * t = h + 16 + 3*i;
+    if (t [2] != lxr_tables_elem [i])
+      err = "element sizes differ. recompile the lexer";
+    else if ( t [2] && ( t [0] % 64 || t [0] < h [3] ||
+      (size_t) t [0] + (size_t) t [1] * t [2] > (size_t) st.st_size ) )
+      err = "truncated or corrupted file";
+  }
+  if (err) {
+    fprintf (stderr, "lxr_tables () : %s : %s\n", file, err);
+    munmap ((void *) map, st.st_size);
+    return -1;
+  }
+
+  if (lxr_hdr)
+    munmap ((void *) lxr_hdr, lxr_hdr_size);
+  lxr_hdr = h;
+  lxr_hdr_size = st.st_size;
+  lxr_tables_bind (map, h);
+  lxr_dummy [0] = lxr_dummy [1] = lxr_dummy [2] = lxr_eob_class;
+  return 0;
+}
+
+static void lxr_tables_load () {
+  const char * file = getenv ("LXR_TABLES");
+  if ( lxr_tables (file ? file : lxr_tables_file) )
+    exit (-1);
+}
+
+#define lxr_tables_init()                                            \
+  do {                                                               \
+    if (!lxr_hdr) lxr_tables_load ();                                \
+  } while (0)
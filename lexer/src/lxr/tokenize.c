@@ -6,13 +6,15 @@
 ..     state '1' is the starting dfa.
 ..     state '2' is the starting dfa (BOL)
 .. (b) There is no zero-length tokens,
-.. (c) maximum depth of 1 for "def" (fallback) chaining.
-.. (d) Doesn't use meta class.
-.. (e) Token value '0' : rejected. No substring matched
-.. (f) accept value in [1, ntokens] for accepted tokens
+.. (c) maximum depth of lxr_max_depth for "def" (fallback) chaining.
+.. (d) states from lxr_template are templates, indexed by meta class.
+..     (or, if lxr_bitmap, there are neither fallbacks nor templates)
+.. (e) if lxr_npair, states with lxr_pidx [state] != 0 may take two
+..     bytes per lookup from lxr_pair [].
+.. (f) Token value '0' : rejected. No substring matched
+.. (g) accept value in [1, ntokens] for accepted tokens
 */
 
-#define lxr_max_depth                        1
 #define lxr_dead                             0
 #define lxr_not_rejected(s)                  (s)          /* s != 0 */
 #ifndef lxr_state_stack_size 
@@ -20,6 +22,42 @@
 #endif
 #define lxr_clear_stack()           stack_idx = lxr_state_stack_size
 
+#if lxr_bitmap
+/*
+.. Bitmap encoding. Bit 'class' of lxr_bmap [state] is set, if the
+.. transition is not DEAD. Then the target is at the rank of the bit.
+*/
+#ifndef lxr_popcount
+#define lxr_popcount(x)                      __builtin_popcountll (x)
+#endif
+#define lxr_delta(state, class)                                      \
+  ( (lxr_bmap [state] >> (class) & 1) ?                              \
+    (int) lxr_target [lxr_boff [state] +                             \
+      lxr_popcount (lxr_bmap [state] & ((1ull << (class)) - 1))] :   \
+    lxr_dead )
+#else
+/*
+.. find the transition corresponding to the class using check/next
+.. tables and if not found in [base, base + nclass), use the fallback.
+.. Note: (a) a template is indexed by the meta class. (b) assumes
+.. transition is DEAD if number of fallbacks reaches max_depth
+*/
+static inline int lxr_delta ( int state, int class ) {
+  int depth = 0, meta = class;
+  while ( lxr_not_rejected (state) && 
+    ((int) lxr_check [lxr_base [state] + meta] != state) ) {
+    state = (depth++ == lxr_max_depth) ? lxr_dead : 
+      (int) lxr_def [state];
+    #if lxr_ntemplates
+    if (state >= lxr_template)
+      meta = (int) lxr_meta [class];
+    #endif
+  }
+  return lxr_not_rejected (state) ?
+    (int) lxr_next [lxr_base[state] + meta] : lxr_dead;
+}
+#endif
+
 /*
 .. The main lexer function. Returns 0, when EOF is encountered. So,
 .. don't use return value 0 inside any action.
@@ -28,11 +66,7 @@ YYSTYPE
 {
   static int states [lxr_state_stack_size];
   unsigned char * cls;
-  int state, class, acc_token, acc_len, stack_idx,
-    depth, token,
-    #if lxr_eol_class
-    eol,
-    #endif
+  int state, class, acc_token, acc_len, stack_idx, token,
     acc_len_old, acc_token_old, state_old;
 
   #define lxr_tokenizer_init()                                       \
@@ -53,6 +87,7 @@ YYSTYPE
       lxr_clear_stack();                                             \
     } while (0) 
 
+  lxr_tables_init ();
   lxr_tokenizer_init();
   do {                  /* Loop looking the longest token until EOF */
 
@@ -62,25 +97,30 @@ YYSTYPE
     state_old = state;
     
     do {                            /* Transition loop until reject */
-      class = (int) *lxr_bptr++;
-      states [--stack_idx] = state;         /* Keep stack of states */
-
+      #if lxr_npair
       /*
-      .. find the transition corresponding to the class using check/
-      .. next tables and if not found in [base, base + nclass), use
-      .. the fallback.Note: (a) No meta class as of now. (b) assumes
-      .. transition is DEAD if number of fallbacks reaches max_depth
+      .. two bytes per lookup. Both the states are pushed to the stack.
+      .. A pair with a DEAD transition or a special class (like EOB) is
+      .. not in the table, then it falls back to a single step.
       */
-      depth = 0;
-      while ( lxr_not_rejected (state) && 
-        ((int) lxr_check [lxr_base [state] + class] != state) ) {
-        state = (depth++ == lxr_max_depth) ? lxr_dead : 
-          (int) lxr_def [state];
+      if ( lxr_pidx [state] && stack_idx > 1 &&
+        (class = (int) lxr_pclass [lxr_bptr [0]]) ) {
+        int pair = (int) lxr_pclass [lxr_bptr [1]];
+        pair = 2 * (((int) lxr_pidx [state] - 1) * lxr_npclass * 
+          lxr_npclass + class * lxr_npclass + pair);
+        if ( lxr_pair [pair + 1] ) {
+          states [--stack_idx] = state;
+          states [--stack_idx] = (int) lxr_pair [pair];
+          state = (int) lxr_pair [pair + 1];
+          lxr_bptr += 2;
+          continue;
+        }
       }
+      #endif
+      class = (int) *lxr_bptr++;
+      states [--stack_idx] = state;         /* Keep stack of states */
 
-      if ( lxr_not_rejected (state) )
-        state = (int) lxr_next [lxr_base[state] + class];
-
+      state = lxr_delta (state, class);
     } while ( lxr_not_rejected (state) && stack_idx );
 
     cls = lxr_bptr - 1;
@@ -89,32 +129,18 @@ YYSTYPE
       .. (a) "acc_token" will be the longest token
       .. (b) In case two patterns are matched for the longest token,
       .. use the first token defined in the lexer file.
-      .. (c) NOTE : in case no pattern use the EOL anchor '$', the
-      .. following optional snippet will be skipped.
+      .. (c) Before '\n' or EOF, the token is that of the state at
+      .. the end of line, lxr_eol_accept [] (i.e it may be a pattern
+      .. with the EOL anchor '$'). The table is not used, in case no
+      .. pattern use the anchor.
       */
-      #if lxr_eol_class
-      if ( *cls == lxr_eof_class || *cls == lxr_nel_class ) {
-        eol = states [stack_idx];
-        depth = 0;
-        while ( lxr_not_rejected (eol) && 
-          ((int) lxr_check [lxr_base [eol] + lxr_eol_class] != eol)) {
-          eol = (depth++ == lxr_max_depth) ? lxr_dead : 
-            (int) lxr_def [eol];
-        }
-
-        if ( lxr_not_rejected (eol) ) {
-          eol = (int) lxr_next [lxr_base[eol] + lxr_eol_class];
-          if ((token = lxr_accept [eol])
-            && token < lxr_accept [states [stack_idx]])
-          {
-            acc_len = cls - lxr_start;
-            acc_token = token;
-            break;
-          }
-        }
-      }
+      #if lxr_eol_used
+      if ( *cls == lxr_eof_class || *cls == lxr_nel_class )
+        token = lxr_eol_accept [states [stack_idx++]];
+      else
       #endif
-      if ( (token = lxr_accept [states [stack_idx++]]) ) {
+      token = lxr_accept [states [stack_idx++]];
+      if ( token ) {
         acc_len = cls - lxr_start;
         acc_token = token;
         break;
@@ -1,6 +1,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <unistd.h>
 
 #include "regex.h"
 #include "lexer.h"
@@ -8,6 +9,15 @@
 void usages ( char * pgm ) {
   const char * usage [] = {
     "-o output.c lexer.l",
+    "-j nthreads -o output.c lexer.l",
+    "-c cachedir -o output.c lexer.l",
+    "-p -o output.c lexer.l",
+    "-t depth -o output.c lexer.l",
+    "-b comb|bitmap|auto -o output.c lexer.l",
+    "-s sample -o output.c lexer.l",
+    "--optimize-tables [-j nthreads] -o output.c lexer.l",
+    "--stride 1|2 -o output.c lexer.l",
+    "-m tables.bin -o output.c lexer.l",
     "-o output.c < lexer.l",
     "lexer.l",
     "< lexer.l"
@@ -21,6 +31,7 @@ int main (int argc, char ** argv) {
 
   char * in = NULL;
   char * out = NULL;
+  int nthreads = 0, optimize = 0;
 
   for (int i=1; i<argc; ++i) {
     if (argv[i][0] == '-') {
@@ -33,6 +44,80 @@ int main (int argc, char ** argv) {
         out = argv [i];
         continue;
       }
+      if (!strcmp (argv [i], "-j")) {
+        if (argc == ++i || atoi (argv [i]) < 1) {
+          fprintf (stderr, "\nmissing/invalid number of threads");
+          usages (argv[0]);
+          exit (-1);
+        }
+        rgx_dfa_threads (nthreads = atoi (argv [i]));
+        continue;
+      }
+      if (!strcmp (argv [i], "-c")) {
+        if (argc == ++i) {
+          fprintf (stderr, "\nmissing cache directory");
+          usages (argv[0]);
+          exit (-1);
+        }
+        lxr_cache (argv [i]);
+        continue;
+      }
+      if (!strcmp (argv [i], "-t")) {
+        if (argc == ++i || argv [i][0] < '0' || argv [i][0] > '9') {
+          fprintf (stderr, "\nmissing/invalid table depth");
+          usages (argv[0]);
+          exit (-1);
+        }
+        lxr_depth (atoi (argv [i]));
+        continue;
+      }
+      if (!strcmp (argv [i], "-b")) {
+        if (argc == ++i || (strcmp (argv [i], "comb") &&
+          strcmp (argv [i], "bitmap") && strcmp (argv [i], "auto"))) {
+          fprintf (stderr, "\nmissing/invalid backend");
+          usages (argv[0]);
+          exit (-1);
+        }
+        lxr_backend (!strcmp (argv [i], "comb") ? LXRCOMB :
+          !strcmp (argv [i], "bitmap") ? LXRBITMAP : LXRAUTO);
+        continue;
+      }
+      if (!strcmp (argv [i], "-s")) {
+        if (argc == ++i) {
+          fprintf (stderr, "\nmissing sample input");
+          usages (argv[0]);
+          exit (-1);
+        }
+        lxr_sample (argv [i]);
+        continue;
+      }
+      if (!strcmp (argv [i], "--optimize-tables")) {
+        optimize = 1;
+        continue;
+      }
+      if (!strcmp (argv [i], "-m")) {
+        if (argc == ++i) {
+          fprintf (stderr, "\nmissing table file");
+          usages (argv[0]);
+          exit (-1);
+        }
+        lxr_table_file (argv [i]);
+        continue;
+      }
+      if (!strcmp (argv [i], "--stride")) {
+        if (argc == ++i || (strcmp (argv [i], "1") &&
+          strcmp (argv [i], "2"))) {
+          fprintf (stderr, "\nmissing/invalid stride");
+          usages (argv[0]);
+          exit (-1);
+        }
+        lxr_stride (atoi (argv [i]));
+        continue;
+      }
+      if (!strcmp (argv [i], "-p")) {
+        rgx_dfa_positions (1);
+        continue;
+      }
       if (!strcmp (argv [i], "-d")) {
         lxr_debug ();
         continue;
@@ -48,6 +133,14 @@ int main (int argc, char ** argv) {
     in = argv [i];
   }
 
+  /*
+  .. threads for the search of heuristics : same as -j (if given), or
+  .. the number of processors
+  */
+  if (optimize)
+    lxr_optimize (nthreads ? nthreads :
+      (int) sysconf (_SC_NPROCESSORS_ONLN));
+
   #if 0
   if (in == NULL) {
     fprintf (stdout, "\nwaiting for stdin..");
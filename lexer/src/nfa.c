@@ -7,6 +7,7 @@
 #include "nfa.h"
 #include "allocator.h"
 #include "class.h"
+#include "bits.h"
 #include "limits.h"
 
 /*
@@ -38,6 +39,13 @@ static int   nclass = 0;
 .. (a) reset nfa_counter to 0
 .. (b) given a list of rgx, it pre evaluate equivalence classes
 */
+/*
+.. Read the classes again, after a class_restore ()
+*/
+void nfa_classes ( ) {
+  class_get ( &class, &nclass );
+}
+
 void nfa_reset ( char ** rgx, int nr ) {
 
   nfa_counter = 0;
@@ -74,6 +82,12 @@ void nfa_reset ( char ** rgx, int nr ) {
         continue;
       }
       switch ( (c &= 0xFF) ) {
+        case 'q' :
+          j += 4;                  /* skip {m,n}. refer rgx_rpn () */
+          break;
+        case '(' :
+          j += 2;                       /* skip the group number, ) */
+          break;
         case '[' :  case '<' :
           ng = 0, charclass = 1;
           break;
@@ -151,44 +165,73 @@ static State * state ( int id, State * a, State * b ) {
 }
 
 /*
-.. Create a fragment, say 'f', for a character class []. The state
-.. f.state is an ε-transition NFA, which is connected to all the NFAs 
-.. corresponding to each of the characters in the [] group. The "out"
-.. transitions of all these NFAs are appended and stored in f.out
+.. Label of a character class [], with all the classes i such that
+.. classes [i] == cmp. Refer nfa.h
 */
-static Fragment state_class ( int * classes, int cmp ) {
-  int stack [256], n = 0;
+int label_set ( int * classes, int cmp, uint64_t ** set ) {
+  int n = 0, id = NFAERR;
+  *set = NULL;
+  for (int i=0; i<nclass-BCLASSES; ++i)
+    if (classes[i] == cmp && n++ == 0)
+      id = i;
+  if (n < 2)
+    return id;
+  *set = allocate ( BITBYTES (nclass) );
   for (int i=0; i<nclass-BCLASSES; ++i)
     if (classes[i] == cmp)
-      stack [n++] = i;
+      BITINSERT ((*set), i);
+  return NFASET;
+}
 
-  if (!n) 
+int labels_next ( Labels * t ) {
+  State * s;
+  for (;;) {
+    if (t->c >= 0) {              /* classes of s[n] yet to be visited */
+      uint64_t * set = STATE_SET (t->s[t->n]), b;
+      int w = t->c >> 6;
+      b = set[w] & (~(uint64_t) 0 >> (63 - (t->c & 63)));
+      while (!b && w--)
+        b = set[w];
+      if (b) {
+        int c = (w << 6) + 63 - __builtin_clzll (b);
+        t->c = c - 1;
+        return c;
+      }
+      t->c = -1;
+    }
+    if (!t->n)
+      return -1;
+    s = t->s[--t->n];
+    if (s->id == NFASET)
+      t->c = nclass - 1;
+    else if (s->id < NFAEPS)
+      return s->id;
+  }
+}
+
+/*
+.. Create a fragment, say 'f', for a character class []. The state
+.. f.state is labelled by the set of classes, unless the group has
+.. only one class. Refer label_set ()
+*/
+static Fragment state_class ( int * classes, int cmp ) {
+  uint64_t * set;
+  int id = label_set (classes, cmp, &set);
+  if (id == NFAERR)
     return (Fragment) {NULL, NULL};
 
-  State * sptr = allocate ((n+1) * sizeof (State)), *s = sptr;
-  State ** outptr = allocate ((2*n+1) * sizeof (State *)),
-    ** out = outptr;
-  
-  Dangling * d = (Dangling *) outptr;
- 
-  for (int i=0; i<n; ++i, ++s, ++out, d++) {
-    s->out = out;
-    s->ist = nfa_counter++;
-    s->id = stack[i];
-    out [n] = s;
-    d->next = d+1;          /* append all the dangling out pointers */
+  State * s;
+  if (set) {
+    SetState * ss = allocate ( sizeof (SetState) );
+    ss->set = set;
+    s = &(ss->s);
   }
-  d[-1].next = NULL;
-
-  /*
-  .. Put all the possible class transitions as output(s) of an ε-NFA
-  */
+  else
+    s = allocate ( sizeof (State) );
+  s->id  = id;
   s->ist = nfa_counter++;
-  s->id  = NFAEPS;
-  s->out = out;
-  out [n] = NULL;
-
-  return (Fragment) {s, (Dangling *) outptr};
+  s->out = allocate ( sizeof (State *) );
+  return (Fragment) {s, (Dangling *) (s->out)};
 }
 
 /*
@@ -211,6 +254,31 @@ static State * fstate ( int itoken ) {
   return s;
 }
 
+/*
+.. A tag state (refer NFATAG in nfa.h) : an ε-transition, which
+.. records the position of the input in the tag "tag".
+*/
+struct tState {
+  State s;
+  int tag;
+};
+
+static State * tstate ( int tag, State * next ) {
+  struct tState * t = allocate ( sizeof (struct tState) );
+  t->tag = tag;
+  State * s = &(t->s);
+  s->id  = NFATAG;
+  s->ist = nfa_counter++;
+  s->out = allocate ( 3 * sizeof (State *) );
+  s->out[0] = next;
+  return s;
+}
+
+int state_tag ( State * t ) {
+  assert (t->id == NFATAG);
+  return ((struct tState*) t)->tag;
+}
+
 /*
 .. Get the token id in [1, tokenmax] for an accpeting state.
 .. Note : id "0" should be reserved for error/reject.
@@ -278,12 +346,19 @@ static int rpn_backtrack (int * rpn, int qpos) {
         stack [depth++] = 2;
         break;
 
+      case ')' :                     /* group k, encoded as (, k, ) */
+        if ( qpos < 2 || rpn [qpos -= 2] != RGXOP ('(') )
+          return RGXERR;
+        stack [depth++] = 1;
+        break;
+
       case '}' :
-        lookfor = RGXOP ('q');
-        do {
-          if (!qpos) return RGXERR;
-          c = rpn [--qpos];
-        } while (c != lookfor);
+        /*
+        .. q{m,n} is encoded as q, {, m, n, }. m & n may take any
+        .. value, so we do not look for q, but skip the 4 entries
+        */
+        if ( qpos < 4 || rpn [qpos -= 4] != RGXOP ('q') )
+          return RGXERR;
       case '+' : case '*' : case '?' :
         stack [depth++] = 1;          
         break;                              /* unary operator. PUSH */
@@ -297,63 +372,57 @@ static int rpn_backtrack (int * rpn, int qpos) {
 }
 
 typedef struct Quantifier {
-  int backtrack, id, iter;
-  char * op;
+  int backtrack, id, iter, m, n;
   struct Quantifier * next;
 } Quantifier;
 
-          
 /*
-.. We create a string like xx;x;x?; which is an rpn representation of
-.. quantification x{3,4}, where x is an operand node which is located
-.. before q{m,n} in the rpn[] by backtracking ( rpn_backtrack () ).
+.. x{m,n} is read as the sequence of operations (in rpn)
+..   xx;x;..            : m copies of x, followed by
+..   xoxexe..xf;        : (x(x(x..)?)?)? with n-m copies of x, or
+..   x*;                : x* for x{m,} ( i.e n = ∞ )
+.. where each 'x' is the operand located before q{m,n} in the rpn[]
+.. by backtracking ( rpn_backtrack () ). The operations o, e, f build
+.. the nested optional (x(x(x..)?)?)? from left to right, such that
+.. each of the copy x (except the last) has an ε-edge to the exit
+.. ( o : open, e : extend, f : finalize. Refer rpn_nfa () ).
+.. Unlike x?x?x?.., the ε-closure of any state is then O(1) and not
+.. O(n-m). The operations are evaluated on the fly by quantifier_op
+.. (), so that there is no limit on m, n other than RGXREPMAX.
 */
-Quantifier * quantifier (Quantifier ** root, int * rpn, int irpn) {
-  #define PUSH(_c_) if (len == RGXSIZE) return NULL;                 \
-    op[len++] = _c_
+static Quantifier * quantifier (Quantifier ** root, int * rpn, int irpn) {
   Quantifier * Q;
   while ( (Q = *root) != NULL ) {
     if (Q->id == irpn) return Q;
     root = & Q->next;
   }
-  int b = rpn_backtrack (rpn, irpn),
-    m = rpn [irpn + 2], n = rpn [irpn + 3],
-    first = 1, len = 0;
-  char op [RGXSIZE];
-  if (b == RGXERR) return NULL;  
-  for (int i=0; i<m; ++i) {
-    PUSH ('x');
-    if (first) first = 0;
-    else { PUSH (';'); }
-  }
-  if ( n == INT_MAX ) {                                    /* x{m,} */
-    PUSH ('x'); PUSH ('*');
-    if (first) first = 0;
-    else { PUSH (';'); }
-  }
-  else {                                                  /* x{m,n} */
-    for (int i=0; i<n-m; ++i) {
-      PUSH ('x'); PUSH ('?');
-      if (first) first = 0;
-      else { PUSH (';'); }
-    }
-  }
-  PUSH ('\0');
+  int b = rpn_backtrack (rpn, irpn);
+  if (b == RGXERR) return NULL;
   *root = Q = allocate (sizeof (Quantifier));
   *Q = (Quantifier) {
     .backtrack = b,
     .id = irpn,
-    .op = allocate_str (op),
+    .m  = rpn [irpn + 2],
+    .n  = rpn [irpn + 3],
     .iter = 1
   };
-  #if 0
-  printf ("\n%s where x is (",op);
-  for(int i=b; i<irpn; ++i)
-    printf ("%c", rpn[i] & 0xFF);
-  printf (")");
-  #endif
   return Q;
-  #undef PUSH
+}
+
+static char quantifier_op ( Quantifier * Q ) {
+  int i = Q->iter++, m = Q->m, n = Q->n,
+    a = m ? 2*m - 1 : 0,                   /* length of xx;x;.. */
+    k = n - m;
+  if (i < a)
+    return (i == 0 || (i & 1)) ? 'x' : ';';
+  int j = i - a;
+  if (n == INT_MAX)                                        /* x{m,} */
+    return j == 0 ? 'x' : j == 1 ? '*' : (j == 2 && m) ? ';' : '\0';
+  if (!k)                                                   /* x{m} */
+    return '\0';
+  if (j < 2*k)                                            /* x{m,n} */
+    return (j & 1) ? (j == 1 ? 'o' : 'e') : 'x';
+  return j == 2*k ? 'f' : (j == 2*k + 1 && m) ? ';' : '\0';
 }
 
 /*
@@ -419,7 +488,7 @@ int rpn_nfa ( int * rpn, State ** start, int itoken ) {
           */
           Quantifier * Q = quantifier (&root, rpn, irpn-1);
           if (Q == NULL) return RGXERR;
-          char q = Q->op[Q->iter++];
+          char q = quantifier_op (Q);
           switch ( q ) {
             case 'x' :
               irpn = Q->backtrack;                 /* Traverse back */
@@ -429,10 +498,47 @@ int rpn_nfa ( int * rpn, State ** start, int itoken ) {
               irpn += 4;
               break;
             default :
-              quant = RGXOP(q);     /* add '?'/'*'/';' to the queue */
+              quant = RGXOP(q);  /* add '*'/';'/'o'.. to the queue */
               irpn --;
           }
           break;
+        case 'o' :
+          /*
+          .. x{m,n} : (x(x(x..)?)?)? is built using the ops o, e, f
+          .. A fragment with NULL state is pushed to hold the list of
+          .. exits ( the ε-edges skipping the rest of the copies ).
+          */
+          POP (e);
+          STT ( NFAEPS, e.state, NULL );
+          PUSH ( s, e.out );
+          PUSH ( NULL, (Dangling *) (& s->out[1]) );
+          break;
+        case 'e' :
+          POP (e); POP (e1); POP (e0);       /* copy, exits, nested */
+          STT ( NFAEPS, e.state, NULL );
+          concatenate ( e0.out, s );
+          ((Dangling *) (& s->out[1]))->next = e1.out;   /* prepend */
+          PUSH ( e0.state, e.out );
+          PUSH ( NULL, (Dangling *) (& s->out[1]) );
+          break;
+        case 'f' :
+          POP (e1); POP (e0);
+          PUSH ( e0.state, append (e0.out, e1.out) );
+          break;
+        case '(' :
+          /*
+          .. Group k (refer rgx_rpn_groups ()) : x is enclosed by the
+          .. tags 2k-2 (start of the group) and 2k-1 (end).
+          */
+          POP (e);
+          int k = rpn [irpn];
+          irpn += 2;
+          s = tstate ( 2*k - 1, NULL );
+          concatenate ( e.out, s );
+          e1.out = (Dangling *) (s->out);
+          s = tstate ( 2*k - 2, e.state );
+          PUSH ( s, e1.out );
+          break;
         case ';' :
           POP (e1); POP (e0);
           concatenate ( e0.out, e1.state );
@@ -538,19 +644,34 @@ int rgx_nfa ( char * rgx, State ** start, int itoken ) {
 /*
 .. Add all the states including "start" to the "list", that
 .. can be attained from "start" with epsilon transition.
+.. A visited state is marked either by stamping it with the global
+.. "counter", or, when a bit stack "seen" is given, by setting the
+.. bit "ist" in "seen". The latter doesn't write into the shared NFA
+.. and so it can be used concurrently by many threads.
 */
 static int counter = 0;
-int states_add ( State * start, Stack * list, State *** stack) {
+static int
+states_closure ( State * start, Stack * list, State *** stack,
+  uint64_t * seen )
+{
+  #define VISITED(_s) ( seen ? BITLOOKUP (seen, (_s)->ist) != 0 :      \
+                              (_s)->counter == stamp )
+  #define VISIT(_s)   if (seen) BITINSERT (seen, (_s)->ist);           \
+                      else (_s)->counter = stamp
+
   /*
   .. We use the "buff" stack when we go down the nfa tree
   .. and thus avoid recusrive call
   */
-  State * s; int n = 0, tk, tkold = RGXMATCH (list);
+  State * s; int n = 0, tk, tkold = RGXMATCH (list), stamp = 0;
+  if (!seen)                /* "counter" isn't read by the reentrant */
+    stamp = counter;
   stack[n++] = ( State * [] ) {start, NULL};
   while ( n ) {
-    /* Go down the tree, if the State is an "NFAEPS" i.e epsilon */
+    /* Go down the tree, if the State is an ε (NFAEPS or NFATAG) */
     while ( (s = *stack[n-1]) ) {
-      if ( s->id != NFAEPS || s->counter == counter ) break;
+      if ( (s->id != NFAEPS && s->id != NFATAG) || VISITED (s) )
+        break;
       /* PUSH() to the stack */
       if ( n < RGXSIZE ) stack[n++] = s->out;
       else return RGXOOM;
@@ -559,7 +680,7 @@ int states_add ( State * start, Stack * list, State *** stack) {
     /* POP() from the stack. Add the state to the list */
     do {
       s = *stack[n-1]++;
-      s->counter = counter;
+      VISIT (s);
       stack_push ( list, s );
       if (s->id == NFAACC) {
         tk = state_token ( s );
@@ -571,6 +692,13 @@ int states_add ( State * start, Stack * list, State *** stack) {
   RGXMATCH(list) = tkold;
 
   return 0;
+
+  #undef VISITED
+  #undef VISIT
+}
+
+int states_add ( State * start, Stack * list, State *** stack) {
+  return states_closure ( start, list, stack, NULL );
 }
 
 int states_at_start ( State * nfa, Stack * list, State *** buff ) {
@@ -583,14 +711,32 @@ int
 states_transition ( Stack * from, Stack * to,
     State *** buff, int ec )
 {
+  return states_transition_r ( from, to, buff, ec, NULL );
+}
+
+/*
+.. Reentrant version of states_transition (). "seen" is a bit stack
+.. private to the caller, large enough to hold a bit for each nfa.
+.. If "seen" is NULL, visited states are stamped with "counter".
+*/
+int
+states_transition_r ( Stack * from, Stack * to,
+    State *** buff, int ec, Stack * seen )
+{
+  uint64_t * mark = NULL;
+  if (seen) {
+    mark = (uint64_t *) seen->stack;
+    memset (mark, 0, seen->max);
+  }
+  else
+    ++counter;
   stack_reset (to);
-  ++counter;
   int status = 0;
   State ** stack = (State **) from->stack;
   for (int i = 0; i < from->nentries && !status; ++i ) {
     State * s = stack [i];
-    if ( s->id == ec )
-      status = states_add ( s->out[0], to, buff );
+    if ( LABELLED (s, ec) )
+      status = states_closure ( s->out[0], to, buff, mark );
   }
   return status;
 }
@@ -632,14 +778,3 @@ int states_bstack ( Stack * list, Stack * bits ) {
     stack_bit ( bits, s[n]->ist );
   return 1;
 }
-
-int rgx_match ( char * rgx, const char * txt ) {
-  nfa_reset (&rgx, 1);
-  State * nfa = NULL;
-  if ( rgx_nfa (rgx, &nfa, 1) < 0 ) {
-    error ("rgx match : regex error");
-    return RGXERR;
-  }
-  /* fixme :  recollect the used memory */
-  return rgx_nfa_match (nfa, txt);
-}
@@ -0,0 +1,554 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <limits.h>
+
+#include "regex.h"
+#include "stack.h"
+#include "nfa.h"
+#include "allocator.h"
+#include "class.h"
+#include "bits.h"
+#include "position.h"
+
+/*
+.. Direct construction of the DFA from the rpn, without the ε-states
+.. of the Thompson NFA. (Refer Aho, Sethi & Ullman, "Compilers", the
+.. section "From a regular expression to a DFA"). A regex "r" is
+.. augmented as (r)# and each leaf (a literal, a character group
+.. labelled by its set of classes, ^, $ or #) is a "position". For
+.. each sub expression "n" of the rpn we evaluate nullable (n),
+.. firstpos (n) & lastpos (n) and for each position p, the followpos
+.. (p).
+.. A dfa state is a set of positions, and the transition from a set S
+.. by the class c is the union of followpos (p) for all p in S with
+.. a label c. So, unlike the NFA, there is no ε-closure to be evaluated
+.. and the nfa "list" of a dfa state holds only the positions.
+*/
+
+static int   counter = 0;           /* visit stamp used for a State */
+static int   npositions = 0;                   /* ist of a position */
+static int * class = NULL;
+static int   nclass = 0;
+
+/*
+.. A fragment (a sub expression) of the rpn. The positions of the
+.. fragment are pos [p0, p1), where pos [] is the list of positions
+.. of the regex. Since the rpn is read in post order, positions of a
+.. fragment are always contiguous.
+*/
+typedef struct Fragment {
+  int p0, p1, nullable;
+  Stack * first, * last;
+} Fragment;
+
+/*
+.. Positions of the regex being read, and the followpos of each of
+.. them. followpos is stored as a stack of positions while reading the
+.. rpn.
+.. "base" is the ist of the first position of the regex.
+*/
+static Stack * pos = NULL, * follow = NULL;
+static int     base = 0;
+
+void positions_reset ( ) {
+  npositions = 0;
+  class_get ( &class, &nclass );
+  pos = stack_new (0);
+  follow = stack_new (0);
+}
+
+#define POS(_i)      ((State **) pos->stack) [_i]
+#define FOLLOW(_i)   ((Stack **) follow->stack) [_i]
+#define NPOS         ((int) (pos->len / sizeof (void *)))
+#define LEN(_s)      ((int) ((_s)->len / sizeof (void *)))
+#define FULL(_s)     ((_s)->len >= INT_MAX / 2)     /* int overflow */
+
+static State * position ( int id, uint64_t * set, Stack * f ) {
+  if ( FULL (pos) )
+    return NULL;
+  State * p;
+  if (set) {
+    SetState * ss = allocate ( sizeof (SetState) );
+    ss->set = set;
+    p = &(ss->s);
+  }
+  else
+    p = allocate ( sizeof (State) );
+  p->id  = id;
+  p->ist = npositions++;
+  stack_push (pos, p);
+  stack_push (follow, f ? f : stack_new (0));
+  return p;
+}
+
+static int single ( int id, uint64_t * set, Fragment * e ) {
+  int p0 = NPOS;
+  State * p = position (id, set, NULL);
+  if (!p) return RGXOOM;
+  *e = (Fragment) {
+    .p0 = p0, .p1 = p0 + 1, .nullable = 0,
+    .first = stack_new (0), .last = stack_new (0)
+  };
+  stack_push (e->first, p);
+  stack_push (e->last, p);
+  return 0;
+}
+
+/*
+.. Leaf fragment for a character group, with a single position
+.. labelled by the classes i, where classes [i] == cmp.
+*/
+static int leaf ( int * classes, int cmp, Fragment * e ) {
+  uint64_t * set;
+  int id = label_set (classes, cmp, &set);
+  if ( id == NFAERR )                   /* Empty character class [] */
+    return RGXERR;
+  return single (id, set, e);
+}
+
+/*
+.. followpos (p) ∪= firstpos, for each p in lastpos. Positions
+.. already in followpos (p) are skipped using the visit stamp.
+*/
+static int follow_add ( Stack * last, Stack * first ) {
+  State ** l = (State **) last->stack, ** f = (State **) first->stack;
+  Stack * fp;
+  for (int i=0; i<LEN (last); ++i) {
+    fp = FOLLOW (l[i]->ist - base);
+    ++counter;
+    State ** s = (State **) fp->stack;
+    for (int j=0; j<LEN (fp); ++j)
+      s[j]->counter = counter;
+    for (int j=0; j<LEN (first); ++j) {
+      if (f[j]->counter == counter) continue;
+      if ( FULL (fp) ) return RGXOOM;
+      f[j]->counter = counter;
+      stack_push (fp, f[j]);
+    }
+  }
+  return 0;
+}
+
+static Stack * list_union ( Stack * a, Stack * b ) {
+  if ( FULL (a) || FULL (b) )
+    return NULL;
+  State ** s = (State **) b->stack;
+  for (int i=0; i<LEN (b); ++i)
+    stack_push (a, s[i]);
+  stack_free (b);
+  return a;
+}
+
+/*
+.. x;y, x|y, x*, x+, x?
+*/
+static int cat ( Fragment a, Fragment b, Fragment * e ) {
+  if ( follow_add (a.last, b.first) ) return RGXOOM;
+  Stack * first = a.nullable ? list_union (a.first, b.first) : a.first,
+    * last = b.nullable ? list_union (b.last, a.last) : b.last;
+  if (!first || !last) return RGXOOM;
+  if (!a.nullable) stack_free (b.first);
+  if (!b.nullable) stack_free (a.last);
+  *e = (Fragment) {
+    .p0 = a.p0, .p1 = b.p1, .nullable = a.nullable && b.nullable,
+    .first = first, .last = last
+  };
+  return 0;
+}
+
+static int alt ( Fragment a, Fragment b, Fragment * e ) {
+  Stack * first = list_union (a.first, b.first),
+    * last = list_union (a.last, b.last);
+  if (!first || !last) return RGXOOM;
+  *e = (Fragment) {
+    .p0 = a.p0, .p1 = b.p1, .nullable = a.nullable || b.nullable,
+    .first = first, .last = last
+  };
+  return 0;
+}
+
+static int closure ( Fragment * e, int op ) {
+  if ( op != '?' && follow_add (e->last, e->first) )
+    return RGXOOM;
+  e->nullable |= (op != '+');
+  return 0;
+}
+
+/*
+.. Create a copy of the fragment "a" with new positions. Since "a" is
+.. the last fragment read, the copies are placed after a.p1. All
+.. the followpos of positions in "a" are with in "a", and are mapped
+.. to the corresponding new positions.
+*/
+static int clone ( Fragment a, Fragment * e ) {
+  int shift = NPOS - a.p0;
+  Stack * f;
+  for (int i=a.p0; i<a.p1; ++i) {
+    State * q = POS (i), * p = position (q->id,
+      q->id == NFASET ? STATE_SET (q) : NULL,      /* share the set */
+      stack_new (FOLLOW (i)->len));
+    if (!p) return RGXOOM;
+    p->flag = q->flag;
+  }
+  for (int i=a.p0; i<a.p1; ++i) {
+    f = FOLLOW (i + shift);
+    State ** s = (State **) FOLLOW (i)->stack;
+    for (int j=0; j<LEN (FOLLOW (i)); ++j)
+      stack_push (f, POS (s[j]->ist - base + shift));
+  }
+  Stack * list [2] = { a.first, a.last }, * copy [2];
+  for (int k=0; k<2; ++k) {
+    State ** s = (State **) list[k]->stack;
+    copy [k] = stack_new (list[k]->len);
+    for (int j=0; j<LEN (list[k]); ++j)
+      stack_push (copy[k], POS (s[j]->ist - base + shift));
+  }
+  *e = (Fragment) {
+    .p0 = a.p0 + shift, .p1 = NPOS, .nullable = a.nullable,
+    .first = copy [0], .last = copy [1]
+  };
+  return 0;
+}
+
+/*
+.. x{m,n} is replaced by m copies of x followed by the nested optional
+.. (x(x(x..)?)?)? with n-m copies of x, in case of finite n, or x* in
+.. case of x{m,}. Similar to rpn_nfa (), the copies are linked from
+.. left to right. "tail" is the set of positions that are followed by
+.. the next copy, and "exit" is the set of positions from which the
+.. rest of the optional copies can be skipped. The nested form keeps
+.. the followpos of each copy of x to a minimum ( O(1) and not O(n-m)
+.. as in x?x?x?.. ). Each copy is cloned from the previous one,
+.. before it's linked to the next copy.
+*/
+static int quantifier ( Fragment x, int m, int n, Fragment * e ) {
+  int k = m + (n == INT_MAX ? 1 : n - m), nullable = 1,
+    reach = 1;          /* copy y can be reached without consuming */
+  Stack * first = stack_new (0), * tail = stack_new (0),
+    * exit = stack_new (0);
+  Fragment y = x, z;
+
+  for (int i=1; i<=k; ++i) {
+    int op = i <= m ? ';' : n == INT_MAX ? '*' : '?';
+    if ( i < k && clone (y, &z) )                     /* next copy */
+      return RGXOOM;
+    if ( op == '*' && closure (&y, '*') )
+      return RGXOOM;
+    if ( follow_add (tail, y.first) )
+      return RGXOOM;
+    if ( reach && !(first = list_union (first, y.first)) )
+      return RGXOOM;
+    if ( !reach )
+      stack_free (y.first);
+    if ( op == '?' && !(exit = list_union (exit, stack_copy (tail))) )
+      return RGXOOM;
+    if ( y.nullable )
+      tail = list_union (tail, y.last);
+    else {
+      stack_free (tail);
+      tail = y.last;
+    }
+    if ( !tail )
+      return RGXOOM;
+    if ( op == ';' )
+      nullable &= y.nullable;
+    reach &= y.nullable;
+    y = z;
+  }
+
+  *e = (Fragment) {
+    .p0 = x.p0, .p1 = NPOS, .nullable = nullable,
+    .first = first, .last = list_union (tail, exit)
+  };
+  return e->last ? 0 : RGXOOM;
+}
+
+/*
+.. Convert the followpos stacks to NULL terminated "out" lists and
+.. create the root of the regex, whose "out" is the firstpos.
+*/
+static State * positions_finalize ( Stack * first ) {
+  for (int i=0; i<NPOS; ++i) {
+    Stack * f = FOLLOW (i);
+    State ** out = allocate ( f->len + sizeof (void *) );
+    memcpy (out, f->stack, f->len);
+    stack_free (f);
+    POS (i)->out = out;
+  }
+  State * root = allocate ( sizeof (State) );
+  root->id  = NFAEPS;
+  root->ist = npositions++;
+  root->out = allocate ( first->len + sizeof (void *) );
+  memcpy (root->out, first->stack, first->len);
+  return root;
+}
+
+/*
+.. Create positions for an rpn. Similar to rpn_nfa ().
+.. Return value : number of positions created, including the root.
+*/
+static int rpn_positions ( int * rpn, State ** root, int itoken ) {
+
+  #define  ERR(_e_)      if ( (status = (_e_)) ) return status
+  #define  POP(_e_)      if (n) _e_ = stack[--n];                    \
+                         else return RGXERR;
+  #define  PUSH(_e_)     if (n < RGXSIZE) stack[n++] = _e_;          \
+                         else return RGXOOM
+  #define  QUEUE(_c_)    if (nq == 4) return RGXOOM;                 \
+                         queue[nq++] = _c_
+  #define  UNQUEUE(_c_)  queue[--nq]
+  #define  GROUP(_c_)    classes [class[_c_]] = 1
+
+  int n = 0, op, charclass = 0, classes [256], queue [4], nq = 0,
+    status = 0, irpn = 0, start = npositions;
+  Fragment stack [RGXSIZE], e, e0, e1;
+
+  base = npositions;
+  stack_reset (pos);
+  stack_reset (follow);
+
+  while ( ( op = rpn[irpn++] ) >= 0 ) {
+    if (ISRGXOP (op)) {
+      switch ( (op &= 0XFF) ) {
+        case 'd' : case 's' : case 'S' :
+        case 'w' : case 'D' : case 'W' :
+          /* Not yet implemented */
+          return RGXERR;
+        case '^' :
+          ERR ( single (BOL_CLASS, NULL, &e) );
+          PUSH (e);
+          break;
+        case '$' :
+          ERR ( single (EOL_CLASS, NULL, &e) );
+          PUSH (e);
+          break;
+        case 'q' :
+          /*
+          .. q is followed by {m,n}. refer rgx_rpn ()
+          */
+          POP (e);
+          ERR ( quantifier (e, rpn[irpn+1], rpn[irpn+2], &e) );
+          irpn += 4;
+          PUSH (e);
+          break;
+        case ';' :
+          POP (e1); POP (e0);
+          ERR ( cat (e0, e1, &e) );
+          PUSH (e);
+          break;
+        case '|' :
+          POP (e1); POP (e0);
+          ERR ( alt (e0, e1, &e) );
+          PUSH (e);
+          break;
+        case '+' : case '*' : case '?' :
+          POP (e);
+          ERR ( closure (&e, op) );
+          PUSH (e);
+          break;
+        case '[' :
+        case '<' :
+          charclass = 1;
+          memset (classes, 0, nclass * sizeof (int));
+          nq = 0;
+          break;
+        case '>' :
+        case ']' :
+          if (nq) GROUP (UNQUEUE ());
+          if (nq) return RGXERR;
+          charclass = 0;
+          ERR ( leaf (classes, (op == '>') ? 0 : 1, &e) );
+          PUSH (e);
+          break;
+        case ',' :
+          while (nq)
+            GROUP ( UNQUEUE () );
+          break;
+        case '-' :
+          if ( nq < 2 ) return RGXERR;
+          int b = UNQUEUE (), a = UNQUEUE ();
+          for (int k=a; k<=b; ++k)
+            GROUP ( k );
+          break;
+        case '.' :
+          memset (classes, 0, nclass * sizeof (int));
+          classes [class ['\n']] = 1;  /* any character except '\n' */
+          ERR ( leaf (classes, 0, &e) );
+          PUSH (e);
+          break;
+        default:
+          error ("rgx positions : unimplemented rule");
+          return RGXERR;
+      }
+    }
+    else {
+      if ( charclass ) {
+        QUEUE ( op );
+        continue;
+      }
+      ERR ( single (class [op], NULL, &e) );
+      PUSH (e);
+    }
+  }
+
+  if ( op < EOF || n != 1 ) {
+    error ("rpn positions : wrong regex pattern ");
+    return RGXERR;
+  }
+
+  POP (e);
+  ERR ( single (NFAACC, NULL, &e1) );           /* (r)# augmented rgx */
+  POS (e1.p0)->flag = itoken;
+  ERR ( cat (e, e1, &e) );
+  *root = positions_finalize (e.first);
+  stack_free (e.first); stack_free (e.last);
+  return npositions - start;
+
+  #undef  ERR
+  #undef  PUSH
+  #undef  POP
+  #undef  QUEUE
+  #undef  UNQUEUE
+  #undef  GROUP
+}
+
+int rgx_positions ( char * rgx, State ** root, int itoken ) {
+  int rpn [RGXSIZE];
+  if ( rgx_rpn (rgx, rpn) < RGXEOE ) {
+    error ("rgx positions : cannot make rpn for rgx \"%s\"", rgx);
+    return RGXERR;
+  }
+  int status = rpn_positions ( rpn, root, itoken );
+  if (status == RGXOOM)
+    error ("rgx positions : too many positions for rgx \"%s\"", rgx);
+  return status;
+}
+
+/*
+.. Add the positions in the NULL terminated list "f" to "to", and
+.. update the preferred token of "to". Similar to states_closure (),
+.. a position is marked visited either by the stamp "counter", or by
+.. the bit stack "seen" (reentrant).
+*/
+static void positions_add ( State ** f, Stack * to, uint64_t * seen ) {
+  State * p;
+  int tk = RGXMATCH (to);
+  while ( (p = *f++) ) {
+    if ( seen ? BITLOOKUP (seen, p->ist) != 0 : p->counter == counter )
+      continue;
+    if (seen) BITINSERT (seen, p->ist);
+    else p->counter = counter;
+    stack_push (to, p);
+    if (p->id == NFAACC && (!tk || p->flag < tk))
+      tk = p->flag;
+  }
+  RGXMATCH (to) = tk;
+}
+
+/*
+.. "root" is an ε-state, whose "out" list is the roots of each regex.
+*/
+int positions_at_start ( State * root, Stack * list, State *** buff ) {
+  stack_reset (list);
+  ++counter;
+  for (State ** r = root->out; *r; ++r)
+    positions_add ( (*r)->out, list, NULL );
+  return 0;
+}
+
+int
+positions_transition_r ( Stack * from, Stack * to,
+    State *** buff, int c, Stack * seen )
+{
+  uint64_t * mark = NULL;
+  if (seen) {
+    mark = (uint64_t *) seen->stack;
+    memset (mark, 0, seen->max);
+  }
+  else
+    ++counter;
+  stack_reset (to);
+  State ** s = (State **) from->stack;
+  for (int i = 0; i < from->nentries; ++i )
+    if ( LABELLED (s[i], c) )
+      positions_add ( s[i]->out, to, mark );
+  return 0;
+}
+
+/*
+.. Bit-parallel simulation of the positions (Glushkov automaton) of a
+.. regex with at most RGXBITS positions. Bit p of a set is the
+.. position p (in the order of creation, # included). The set "d"
+.. of the positions just consumed moves by a byte b as
+..   d = follow (d) & mask [b]
+.. where follow (d), the union of the followpos of each p in d, is
+.. the OR of the tables follow [k][byte k of d]. So a byte costs one
+.. lookup per 8 positions, and not a Stack of States as in
+.. rgx_nfa_match ().
+*/
+int positions_bits ( char * rgx, RgxBits ** prog ) {
+  State * root;
+  nfa_reset (&rgx, 1);
+  positions_reset ();
+  int n = rgx_positions (rgx, &root, 1);
+  if (n < 0)
+    return n;
+  if (--n > RGXBITS)                              /* without the root */
+    return 1;
+
+  int nk = (n + 7) / 8;
+  size_t size = sizeof (RgxBits) + nk * sizeof (uint64_t [256]);
+  RgxBits * p = calloc (1, size);
+  uint64_t follow [RGXBITS], first = 0;
+  if (!p) {
+    error ("rgx bits : out of memory");
+    return RGXOOM;
+  }
+  p->size = size;
+  p->nchunks = nk;
+  for (State ** f = root->out; *f; ++f)
+    first |= 1ull << ((*f)->ist - base);
+  for (int i=0; i<n; ++i) {
+    State * q = POS (i);
+    follow [i] = 0;
+    for (State ** f = q->out; *f; ++f) {
+      follow [i] |= 1ull << ((*f)->ist - base);
+      if ((*f)->id == NFAACC)
+        p->final |= 1ull << i;
+    }
+    for (int c=0; c<256; ++c)
+      if ( LABELLED (q, class [c]) )
+        p->mask [c] |= 1ull << i;
+    if ( LABELLED (q, BOL_CLASS) )
+      p->start |= first & (1ull << i);
+  }
+
+  /* table of the union of followpos, for each byte of a set */
+  for (int k=0; k<nk; ++k)
+    for (int v=1; v<256; ++v) {
+      int j = 8 * k + __builtin_ctz (v);
+      p->follow [k][v] = p->follow [k][v & (v - 1)] |
+        (j < n ? follow [j] : 0);
+    }
+  *prog = p;
+  return 0;
+}
+
+/*
+.. Longest match from the start of "txt", after a transition by BOL
+.. (as rgx_nfa_match ()).
+*/
+int positions_bits_match ( const RgxBits * p, const char * txt ) {
+  uint64_t d = p->start, f;
+  long end = d & p->final ? 0 : -1;
+  for (size_t i=0; d && txt [i]; ) {
+    f = 0;
+    for (uint32_t k=0; k<p->nchunks; ++k)
+      f |= p->follow [k][(d >> 8 * k) & 0xFF];
+    d = f & p->mask [(uint8_t) txt [i++]];
+    if (d & p->final)
+      end = i;
+  }
+  return (int) (end + 1);
+}
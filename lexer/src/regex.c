@@ -40,6 +40,16 @@ static int rgx_input ( char ** str ) {
 static int token[3] = {0};
 static int charclass = 0;
 static int is_EOL = 0;
+static int reversed = 0;
+static int groups = 0;
+
+void rgx_rpn_reverse ( int on ) {
+  reversed = on;
+}
+
+void rgx_rpn_groups ( int on ) {
+  groups = on;
+}
 
 /*
 .. We break down the regex to tokens of
@@ -191,6 +201,11 @@ int rgx_token ( char ** str ) {
       .. {0}, {0,0}, {,0}, {n,m,}, {}, {,}, {n,m} with m<n.
       */
       ERR ( !nread || r[1] < r[0] || !r[1] );
+      if ( r[0] > RGXREPMAX || (r[1] > RGXREPMAX && r[1] != INT_MAX) ) {
+        error ("rgx : quantifier bound exceeds %d (RGXREPMAX)",
+          RGXREPMAX);
+        RTN (RGXERR);
+      }
       RTN ( RGXOP('{') );
     default :
       RTN (c);
@@ -220,6 +235,95 @@ typedef struct iStack {
   int * a, n, max;
 } iStack;
 
+/*
+.. Copy the sub expression of "rpn" ending at "end" to "out" [n..],
+.. with the operands of each concatenation swapped (and the anchors
+.. '^', '$' exchanged), i.e an rpn for the reversed strings. begin [i]
+.. is the first entry of the sub expression ending at rpn [i]. Returns
+.. the new length of "out".
+*/
+static int rpn_reversed ( int * rpn, int * begin, int end, int * out,
+  int n )
+{
+  int c = rpn [end];
+  switch (c) {
+    case RGXOP (';') :
+      n = rpn_reversed (rpn, begin, end - 1, out, n);
+      n = rpn_reversed (rpn, begin, begin [end - 1] - 1, out, n);
+      break;
+    case RGXOP ('|') :
+      n = rpn_reversed (rpn, begin, begin [end - 1] - 1, out, n);
+      n = rpn_reversed (rpn, begin, end - 1, out, n);
+      break;
+    case RGXOP ('}') :                          /* q{m,n} : 5 entries */
+      n = rpn_reversed (rpn, begin, end - 5, out, n);
+      for (int i = end - 4; i < end; ++i)
+        out [n++] = rpn [i];
+      break;
+    case RGXOP ('*') : case RGXOP ('+') : case RGXOP ('?') :
+      n = rpn_reversed (rpn, begin, end - 1, out, n);
+      break;
+    case RGXOP ('^') : case RGXOP ('$') :
+      c = RGXOP (c == RGXOP ('^') ? '$' : '^');
+      break;
+    default :                 /* literal, character group or class */
+      for (int i = begin [end]; i < end; ++i)
+        out [n++] = rpn [i];
+  }
+  out [n++] = c;
+  return n;
+}
+
+/*
+.. Reverse a valid "rpn" (terminated by RGXEOE) in place. Returns
+.. RGXEOE, RGXERR or RGXOOM.
+*/
+static int rpn_reverse ( int * rpn ) {
+  int begin [RGXSIZE], stack [RGXSIZE], out [RGXSIZE], n = 0, depth = 0;
+  while ( rpn [n] >= 0 ) {
+    int c = rpn [n];
+    switch (c) {
+      case RGXOP ('[') : case RGXOP ('<') :  /* up to closing ] or > */
+        stack [depth++] = n;
+        while ( rpn [n] >= 0 && rpn [n] != c + 2 ) ++n;
+        if ( rpn [n] < 0 ) return RGXERR;
+        begin [n] = stack [depth - 1];
+        break;
+      case RGXOP ('q') :
+        if ( !depth ) return RGXERR;
+        for (int i=0; i<4; ++i)
+          if ( rpn [++n] < 0 ) return RGXERR;
+        begin [n] = stack [depth - 1];
+        break;
+      case RGXOP ('*') : case RGXOP ('+') : case RGXOP ('?') :
+        if ( !depth ) return RGXERR;
+        begin [n] = stack [depth - 1];
+        break;
+      case RGXOP (';') : case RGXOP ('|') :
+        if ( depth < 2 ) return RGXERR;
+        begin [n] = stack [--depth - 1];
+        break;
+      default :
+        begin [n] = stack [depth++] = n;
+    }
+    ++n;
+  }
+  if ( depth != 1 ) return RGXERR;
+  /*
+  .. The optional BOL ^? added by rgx_rpn () stays in front, i.e
+  .. ^?;x is reversed as ^?;x' (^x as ^?;x'$)
+  */
+  int bol = rpn [0] == RGXOP ('^') && rpn [1] == RGXOP ('?') &&
+    rpn [n-1] == RGXOP (';') && begin [n-2] == 2;
+  if ( !bol && n + 3 > RGXSIZE ) return RGXOOM;
+  out [0] = RGXOP ('^'); out [1] = RGXOP ('?');
+  int m = rpn_reversed (rpn, begin, n - 1 - bol, out, 2);
+  out [m++] = RGXOP (';');
+  out [m] = RGXEOE;
+  memcpy (rpn, out, (m + 1) * sizeof (int));
+  return RGXEOE;
+}
+
 /*
 .. Reverse polish notation.
 .. For valid part of "rpn", it will have value >= 0, representing
@@ -247,6 +351,7 @@ int rgx_rpn ( char * s, int * rpn ) {
   char ** rgx = &s, * start = s;
   int queued[4],
       RGXOPS[RGXSIZE],
+      open[RGXSIZE], nopen = 0, ngroups = 0,      /* refer groups */
       op, last = RGXBGN;
 
   iStack ostack = STACK (RGXOPS, RGXSIZE),
@@ -256,17 +361,6 @@ int rgx_rpn ( char * s, int * rpn ) {
   token [0] = 0;                    /* Signify last token was empty */
   is_EOL = 0;
 
-  /*
-  .. If the rgx doesn't have a BOL anchor requirement, like in ^abc,
-  .. we add BOL as optional. Example for pattern abc, we modify it
-  .. as ^?abc
-  */
-  if ( s[0] != '^' ) {
-    queued [0] = RGXOP ('?');
-    queued [1] = RGXOP ('^');
-    queue.n = 2;
-  }
-
   while ((op = queue.n ? queue.a[--queue.n] : rgx_token (rgx)) >= 0) {
     if ( ISRGXOP (op) ) {
       switch ( op & 0xFF ) {
@@ -322,8 +416,11 @@ int rgx_rpn ( char * s, int * rpn ) {
             PUSH (queue, RGXOP(';'));
             break;
           }
-          if ( charclass )
+          if ( charclass ) {
             PUSH (stack, op);               /* creates a char stack */
+          }
+          else if ( op == RGXOP ('(') && nopen < RGXSIZE )
+            open [nopen++] = ++ngroups;    /* number of the group */
           OPERATOR ( op ); /* keept it until you find closing ],>,) */
           break;
 
@@ -334,8 +431,18 @@ int rgx_rpn ( char * s, int * rpn ) {
           for (int i=0; i<2 && ( TOP (ostack) != c ); ++i)
             PUSH (stack, POP (ostack));
           ERR ( POP (ostack) != c );        /* depth should be <= 2 */
-          if ( op != RGXOP (')') )
+          if ( op != RGXOP (')') ) {
             OPERATION (op);                  /* finalize char class */
+          }
+          else if ( nopen-- && groups ) {
+            /*
+            .. The group k is encoded as (, k, ). Refer rgx_rpn_groups
+            */
+            ERR ( last != RGXOPD && last != RGXOPN );    /* () */
+            OPERATION (RGXOP ('('));
+            OPERATION (open [nopen]);
+            OPERATION (RGXOP (')'));
+          }
           last = RGXOPN;
           break;
 
@@ -386,10 +493,18 @@ int rgx_rpn ( char * s, int * rpn ) {
     /*
     .. We can expect a maximum of two operators waiting in the
     .. ostack. Anything more than 2 is unexpected, because their
-    .. corresponding operand are not found in the regex pattern
+    .. corresponding operand are not found in the regex pattern. An
+    .. opening (, [ or [^ still waiting has no closing one.
     */
-    for (int i=0; i<2 && TOP (ostack); ++i)
+    for (int i=0; i<2 && TOP (ostack); ++i) {
+      op = TOP (ostack);
+      if ( op == RGXOP ('(') || op == RGXOP ('[') ||
+        op == RGXOP ('<') ) {
+        error ("rgx rpn : missing closing bracket");
+        ERR (1);
+      }
       PUSH (stack, POP(ostack));
+    }
     if (ostack.n) {
       error ("rgx rpn : missing operand");
       ERR (1);
@@ -405,11 +520,28 @@ int rgx_rpn ( char * s, int * rpn ) {
     }
     */
 
+    /*
+    .. BOL is added as optional in front of the whole rgx, i.e abc
+    .. as ^?(abc) and foo|^bar as ^?(foo|^bar), so that the BOL root
+    .. keeps the branches that don't require a BOL
+    */
+    ERR ( stack.n + 3 > stack.max );
+    memmove (stack.a + 2, stack.a, stack.n * sizeof (int));
+    stack.a [0] = RGXOP ('^');
+    stack.a [1] = RGXOP ('?');
+    stack.n += 2;
+    PUSH (stack, RGXOP (';'));
+
     /*
     .. Encode EOF as the end of RPN and return the length of
     .. characters found in the regex
     */
     PUSH (stack, RGXEOE);
+    if ( reversed && rpn_reverse (rpn) != RGXEOE ) {
+      error ("rgx rpn : cannot reverse the expression");
+      rpn [0] = RGXERR;
+      return RGXERR;
+    }
     return (int) (*rgx - start) - 1; 
   }
 
@@ -431,5 +563,6 @@ int rgx_rpn ( char * s, int * rpn ) {
 }
 
 void rgx_free () {
+  rgx_cache_free ();
   destroy ();
 }
@@ -0,0 +1,275 @@
+/*
+.. rgxgrep : print the lines of the files that match a regex. The regex
+.. is compiled once (rgx_compile ()), and the files are mapped (read
+.. only) and searched by a pool of threads, each taking the next file.
+.. Each line is searched alone by rgx_search (), so a '^' matches at
+.. the start of a line, and a match doesn't go over a '\n'. '$' isn't
+.. supported (the pattern doesn't compile). A thread writes the lines
+.. of a file in its own buffer, and the buffers are printed in the
+.. order of the files. The line numbers (-n) are counted only up to
+.. the matching lines. A space (outside a [..]) or a byte outside
+.. [32,126] ends a regex of a lexer rule, so they are escaped in the
+.. pattern. Options may come anywhere before "--". Exit status is 0 if
+.. a line matched, 1 if none, and 2 on an error.
+.. $ make rgxgrep
+.. $ ./rgxgrep -n -j 8 "ERROR.*request timed out" app.log db.log
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "regex.h"
+
+typedef struct Out {
+  char * buf;
+  size_t len, size, count;
+  int done, status;       /* status : 0 match, 1 no match, 2 error */
+} Out;
+
+static RgxProg * prog = NULL;
+static char   ** files;
+static Out     * out;
+static int       nfiles, number = 0, count = 0, names = 0, nextfile = 0,
+                 printed = 0;
+static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+
+void usages ( char * pgm ) {
+  const char * usage [] = {
+    "[-n] [-c] [-j nthreads] rgx file ..",
+  };
+  fprintf (stderr, "\nusages(s):");
+  for (int i=0; i<sizeof usage/ sizeof usage[0]; ++i)
+    fprintf (stderr, "\n  %s %s", pgm, usage [i]);
+  fprintf (stderr, "\n");
+}
+
+/*
+.. The pattern, with the bytes that end a regex escaped : a space
+.. outside a [..], and everywhere the bytes outside [32,126] (as \xHH,
+.. also if the pattern escaped them)
+*/
+#define PRINTABLE(_c) ( (_c) >= 32 && (_c) <= 126 )
+static char * pattern ( const char * p ) {
+  char * rgx = malloc (4 * strlen (p) + 1), * r = rgx;
+  int charclass = 0;
+  for ( ; rgx && *p; ++p) {
+    unsigned char c = *p;
+    if ( !PRINTABLE (c) )
+      r += sprintf (r, "\\x%02x", c);
+    else if ( c == '\\' && p[1] ) {
+      if ( PRINTABLE ((unsigned char) p[1]) ) {
+        *r++ = *p++;
+        *r++ = *p;
+      }
+    }
+    else {
+      if ( !charclass && c == ' ' ) *r++ = '\\';
+      if ( c == '[' || c == ']' ) charclass = c == '[';
+      *r++ = c;
+    }
+  }
+  if (rgx) *r = '\0';
+  return rgx;
+}
+#undef PRINTABLE
+
+static void out_put ( Out * o, const char * s, size_t n ) {
+  if ( o->len + n > o->size ) {
+    size_t size = 2 * (o->len + n) + 4096;
+    char * more = realloc (o->buf, size);
+    if (!more) {
+      o->status = 2;
+      return;
+    }
+    o->buf = more;
+    o->size = size;
+  }
+  memcpy (o->buf + o->len, s, n);
+  o->len += n;
+}
+
+/* prefix of a line, or of the count : "file:" and "number:" */
+static void out_prefix ( Out * o, const char * file, size_t line ) {
+  char num [32];
+  if (names) {
+    out_put (o, file, strlen (file));
+    out_put (o, ":", 1);
+  }
+  if (line)
+    out_put (o, num, snprintf (num, sizeof num, "%zu:", line));
+}
+
+/*
+.. The first line of buf [at, len) that matches, buf [*ls, *le). "at"
+.. is the start of a line. Returns 1 if found, 0 if not, and < 0 on an
+.. error.
+*/
+static int line_next ( const char * buf, size_t len, size_t at,
+  size_t * ls, size_t * le )
+{
+  const char * nl;
+  size_t s, e;
+  int m;
+  for ( ; at < len; at = *le + 1) {
+    nl = memchr (buf + at, '\n', len - at);
+    *ls = at;
+    *le = nl ? nl - buf : len;
+    if ( (m = rgx_search (prog, buf + at, *le - at, &s, &e)) )
+      return m;
+  }
+  return 0;
+}
+
+static void grep_file ( const char * file, Out * o ) {
+  struct stat st;
+  const char * buf = "", * nl;
+  int fd = open (file, O_RDONLY), m;
+  o->status = 1;
+  if ( fd < 0 || fstat (fd, &st) || ( st.st_size &&
+    (buf = mmap (NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0))
+      == MAP_FAILED ) ) {
+    fprintf (stderr, "rgxgrep : cannot read %s\n", file);
+    if (fd >= 0) close (fd);
+    o->status = 2;
+    return;
+  }
+  close (fd);
+  size_t len = st.st_size, at = 0, pos = 0, line = 1, ls, le;
+  if (len)
+    madvise ((void *) buf, len, MADV_SEQUENTIAL);
+
+  while ( (m = line_next (buf, len, at, &ls, &le)) > 0 ) {
+    o->count++;
+    o->status = o->status == 2 ? 2 : 0;
+    if (!count) {
+      while ( number && pos < ls &&
+        (nl = memchr (buf + pos, '\n', ls - pos)) ) {
+        pos = nl - buf + 1;
+        line++;
+      }
+      out_prefix (o, file, number ? line : 0);
+      out_put (o, buf + ls, le - ls);
+      out_put (o, "\n", 1);
+    }
+    at = le + 1;
+  }
+  if (m < 0)
+    o->status = 2;
+  if (count) {
+    char num [32];
+    out_prefix (o, file, 0);
+    out_put (o, num, snprintf (num, sizeof num, "%zu\n", o->count));
+  }
+  if (len)
+    munmap ((void *) buf, len);
+}
+
+/*
+.. Each thread takes the next file. The buffers done are printed in
+.. the order of the files, by the thread that completes the sequence.
+*/
+static void * grep_worker ( void * arg ) {
+  int f;
+  while ( (f = __atomic_fetch_add (&nextfile, 1, __ATOMIC_RELAXED))
+    < nfiles ) {
+    grep_file (files [f], &out [f]);
+    pthread_mutex_lock (&lock);
+    out [f].done = 1;
+    for ( ; printed < nfiles && out [printed].done; ++printed) {
+      fwrite (out [printed].buf, 1, out [printed].len, stdout);
+      free (out [printed].buf);
+      out [printed].buf = NULL;
+    }
+    pthread_mutex_unlock (&lock);
+  }
+  return arg;
+}
+
+int main (int argc, char ** argv) {
+
+  char * rgx = NULL;
+  int nthreads = 0, nargs = 1, i;
+
+  /* options may also follow the regex or a file, until "--" */
+  for (i=1; i<argc; ++i) {
+    if (argv [i][0] != '-' || !argv [i][1]) {
+      argv [nargs++] = argv [i];
+      continue;
+    }
+    if (!strcmp (argv [i], "--")) {
+      while (++i < argc)
+        argv [nargs++] = argv [i];
+      break;
+    }
+    if (!strcmp (argv [i], "-n")) {
+      number = 1;
+      continue;
+    }
+    if (!strcmp (argv [i], "-c")) {
+      count = 1;
+      continue;
+    }
+    if (!strcmp (argv [i], "-j")) {
+      if (argc == ++i || atoi (argv [i]) < 1) {
+        fprintf (stderr, "\nmissing/invalid number of threads");
+        usages (argv[0]);
+        exit (2);
+      }
+      nthreads = atoi (argv [i]);
+      continue;
+    }
+    fprintf (stderr, "\nunknown option %s", argv [i]);
+    usages (argv[0]);
+    exit (2);
+  }
+  if (nargs < 3) {
+    fprintf (stderr, "\nmissing regex or file");
+    usages (argv[0]);
+    exit (2);
+  }
+  rgx = pattern (argv [1]);
+  files = argv + 2;
+  nfiles = nargs - 2;
+  names = nfiles > 1;
+
+  if ( !rgx || rgx_compile (rgx, &prog) < 0 ) {
+    errors ();
+    fprintf (stderr, "\nrgxgrep : cannot compile rgx %s\n", argv [1]);
+    exit (2);
+  }
+  out = calloc (nfiles, sizeof (Out));
+  if (!nthreads)
+    nthreads = (int) sysconf (_SC_NPROCESSORS_ONLN);
+  if (nthreads > nfiles)
+    nthreads = nfiles;
+  if (nthreads < 1)
+    nthreads = 1;
+
+  pthread_t tid [nthreads];
+  int nt = 0;
+  for ( ; nt < nthreads - 1; ++nt)
+    if ( pthread_create (&tid[nt], NULL, grep_worker, NULL) )
+      break;
+  grep_worker (NULL);
+  while (nt--)
+    pthread_join (tid[nt], NULL);
+  fflush (stdout);
+
+  int status = 1;
+  for (int f=0; f<nfiles; ++f)
+    if (out [f].status == 2)
+      status = 2;
+    else if (!out [f].status && status == 1)
+      status = 0;
+  errors ();
+  free (out);
+  free (prog);
+  free (rgx);
+  rgx_free ();
+  return status;
+}
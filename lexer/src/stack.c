@@ -5,32 +5,42 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <stdint.h>
+#include <pthread.h>
 
 /*
 .. fixme : recover old memory blocks, during realloc.
+.. The pool of freed stacks is shared among threads, hence the lock.
 */
 static Stack * pool = NULL;
+static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
 struct Freelist { Stack * next; };
 
 void stack_dstr() {  /* Should be called when arena allocator is freed */
+  pthread_mutex_lock (&lock);
   pool = NULL;
+  pthread_mutex_unlock (&lock);
 }
 
 static inline void stack_realloc ( Stack * s, int max ) {
+  int oldmax = s->max;
   s->max = (max + 63) & ~(int) 63; /* nearest 64 Byte alignment. = 8 x (void *) */
-  char * old = s->stack;           /* fixme : 'old' bytes are lost. */
+  char * old = s->stack;    /* fixme : 'old' bytes are lost, if small */
   s->stack = allocate ( s->max );
   memcpy ( s->stack, old, s->len );
+  deallocate ( old, oldmax );
 }
 
 Stack * stack_new ( int len ) {
   len = len <= 0 ? 64 : len;
+  pthread_mutex_lock (&lock);
   Stack * s = pool;
   if (s && s->max >= len) {
     pool = ((struct Freelist *) s->stack)->next;
+    pthread_mutex_unlock (&lock);
     stack_clear (s);
     return s;
   }
+  pthread_mutex_unlock (&lock);
   s = allocate ( sizeof(Stack) );
   s->stack = allocate ( len );
   s->max = len;
@@ -47,8 +57,11 @@ Stack * stack_copy ( Stack * p ) {
 }
 
 void stack_free ( Stack * s ) {
+  if (!s) return;
+  pthread_mutex_lock (&lock);
   ((struct Freelist *) s->stack)->next = pool;
   pool = s;
+  pthread_mutex_unlock (&lock);
 }
 
 /*
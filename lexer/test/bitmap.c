@@ -0,0 +1,102 @@
+/*
+.. test case for the bitmap (popcount) encoding of the transitions.
+.. Every transition δ (s,c) of the bitmap tables is compared with that
+.. of the compressed check[]/next[] tables. Table sizes and the lookup
+.. throughput (MB/s) of both encodings are reported.
+.. $ make obj/bitmap.tst
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "regex.h"
+
+#define NBYTES (1 << 24)
+
+static int ** t, * len, depth;
+static uint64_t * bmap;
+static int * boff, * target;
+
+/* Refer tokenize.c */
+static inline int comb_delta ( int s, int c ) {
+  int d = 0, m = c;
+  while ( s && t[0][t[2][s] + m] != s ) {
+    s = (d++ == depth) ? 0 : t[4][s];
+    if ( s >= len [3] ) m = t[5][c];
+  }
+  return s ? t[1][t[2][s] + m] : 0;
+}
+
+static inline int bitmap_delta ( int s, int c ) {
+  return (bmap [s] >> c & 1) ? target [boff [s] +
+    __builtin_popcountll (bmap [s] & ((1ull << c) - 1))] : 0;
+}
+
+/* walk the dfa, restarting from state 1 when rejected */
+#define WALK(_delta, _txt, _sum)                                      \
+  do {                                                                \
+    int _s = 1;                                                       \
+    for (int i=0; i<NBYTES; ++i) {                                    \
+      _s = _delta (_s, _txt [i]);                                     \
+      if (!_s) _s = 1;                                                \
+      _sum += _s;                                                     \
+    }                                                                 \
+  } while (0)
+
+int main () {
+  char * rgx[] = {
+    "int", "if", "else", "while", "for", "return", "char", "void",
+    "struct", "switch", "[a-zA-Z_][a-zA-Z0-9_]*", "[0-9]+",
+    "0[xX][0-9a-fA-F]+", "[ \\t\\n]+", "[-+*/=<>!]=?", "\"[^\"\\n]*\""
+  };
+  const char chars [] = "intfelswhruc_vdx0A9 =<\"\n+";
+  int nrgx = sizeof (rgx) / sizeof (rgx[0]);
+  unsigned char * txt = malloc (NBYTES);
+
+  for (depth = 0; depth < 3; ++depth) {
+    rgx_table_depth (depth);
+    DState * dfa = NULL;
+    if ( rgx_lexer_dfa (rgx, nrgx, &dfa) < 0 ||
+      dfa_tables (&t, &len) < 0 ) {
+      errors ();
+      printf ("cannot make tables. aborting");
+      exit (-1);
+    }
+    int ntarget = dfa_bitmap (t, len, depth, &bmap, &boff, &target);
+    if (ntarget < 0) {
+      errors ();
+      printf ("cannot make bitmap tables. aborting");
+      exit (-1);
+    }
+
+    int same = 1;
+    for (int s=0; s<len [3]; ++s)
+      for (int c=0; c<len [5]; ++c)
+        same &= comb_delta (s, c) == bitmap_delta (s, c);
+    printf ("\n depth %d : check[] %4d, bitmap target[] %4d : %s",
+      depth, len [0], ntarget,
+      same ? "same transitions" : "(wrong)");
+
+    if (depth != 1) continue;            /* default depth */
+    srand (1);
+    for (int i=0; i<NBYTES; ++i)
+      txt [i] = t[6][(unsigned char)
+        chars [rand () % (sizeof (chars) - 1)]];
+    long sum [2] = {0, 0};
+    clock_t c0 = clock ();
+    WALK (comb_delta, txt, sum [0]);
+    clock_t c1 = clock ();
+    WALK (bitmap_delta, txt, sum [1]);
+    clock_t c2 = clock ();
+    printf ("\n comb   %8.1f MB/s"
+      "\n bitmap %8.1f MB/s %s",
+      NBYTES / 1e6 / ((double) (c1 - c0) / CLOCKS_PER_SEC + 1e-9),
+      NBYTES / 1e6 / ((double) (c2 - c1) / CLOCKS_PER_SEC + 1e-9),
+      sum [0] == sum [1] ? "" : "(wrong)");
+  }
+
+  free (txt);
+  /* free all memory blocks created */
+  rgx_free();
+}
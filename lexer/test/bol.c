@@ -0,0 +1,70 @@
+/*
+.. test case for the optional BOL of the lexer rules. A rule without
+.. '^' matches both at the start of a line (from the BOL root) and
+.. elsewhere (from the root), in each branch of a top level
+.. alternation. Longest match and token from both roots are compared
+.. with the expected ones.
+.. $ make obj/bol.tst
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "regex.h"
+
+/* longest match, starting from the root "s". Refer tokenize.c */
+static int table_match ( int ** t, int * len, int s, const char * txt,
+  int * token )
+{
+  int end = 0;
+  *token = 0;
+  for (int i=0; txt [i]; ++i) {
+    if ( !(s = table_delta (t, len, 1, s, t[6][(unsigned char) txt [i]],
+      NULL)) )
+      break;
+    if ( t[3][s] ) {
+      end = i + 1;
+      *token = t[3][s];
+    }
+  }
+  return end;
+}
+
+int main () {
+  char * rgx[] = {
+    "x|y", "aa|b", "a(a|b)", "^abc|c", "[a-z]"
+  };
+  /* text, then the length and token from the BOL root and the root */
+  struct { char * txt; int bol [2], root [2]; } t[] = {
+    { "x",   {1, 1}, {1, 1} },  { "y",   {1, 1}, {1, 1} },
+    { "b",   {1, 2}, {1, 2} },  { "aa",  {2, 2}, {2, 2} },
+    { "ab",  {2, 3}, {2, 3} },  { "abc", {3, 4}, {2, 3} },
+    { "c",   {1, 4}, {1, 4} },  { "z",   {1, 5}, {1, 5} }
+  };
+  int nrgx = sizeof (rgx) / sizeof (rgx[0]), fail = 0;
+
+  DState * dfa = NULL;
+  int ** tables, * len;
+  if ( rgx_lexer_dfa (rgx, nrgx, &dfa) < 0 ||
+    dfa_tables (&tables, &len) < 0 ) {
+    errors ();
+    printf ("cannot make tables. aborting");
+    exit (-1);
+  }
+
+  for (int i=0; i < sizeof (t) / sizeof (t[0]); ++i) {
+    int token [2], m [2];
+    m [0] = table_match (tables, len, 2, t[i].txt, &token [0]);
+    m [1] = table_match (tables, len, 1, t[i].txt, &token [1]);
+    int ok = m [0] == t[i].bol [0] && token [0] == t[i].bol [1] &&
+      m [1] == t[i].root [0] && token [1] == t[i].root [1];
+    printf ("\n %-4s : BOL [%d] %d, root [%d] %d%s", t[i].txt,
+      token [0], m [0], token [1], m [1], ok ? "" : " (wrong)");
+    fail += !ok;
+  }
+  printf ("\n %s\n", fail ? "failed" : "all matches as expected");
+
+  /* free all memory blocks created */
+  rgx_free();
+  return fail != 0;
+}
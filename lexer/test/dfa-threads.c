@@ -0,0 +1,62 @@
+/*
+.. test case for the multi-threaded subset construction. Each regex is
+.. compiled (rgx_compile ()) NREPEAT times with NTHREADS threads, from
+.. both the Thompson NFA and the positions, and each program is
+.. compared byte by byte with that of a single thread. The states are
+.. discovered in a different order in each run, but the programs
+.. should be the same.
+.. $ make obj/dfa-threads.tst
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "regex.h"
+
+#define NTHREADS 4
+#define NREPEAT  200
+
+int main () {
+  char * rgx[] = {
+    "(aa|[^a][^a])+|c", "[a-z]+ing|foo[0-9]+|x(ab)*y",
+    "(a|b)*a(a|b){4}", "[0-9]+(\\.[0-9]*)?([eE][-+]?[0-9]+)?",
+    "\"([^\"\\\\\\n]|\\\\.)*\"", "(auto|break|case|char|const)[ (;]"
+  };
+  int nrgx = sizeof (rgx) / sizeof (rgx[0]);
+
+  for (int pos = 0; pos < 2; ++pos) {
+    rgx_dfa_positions (pos);
+    for (int r = 0; r < nrgx; ++r) {
+      RgxProg * one = NULL, * p = NULL;
+      int differ = 0;
+      rgx_dfa_threads (1);
+      if ( rgx_compile (rgx [r], &one) < 0 ) {
+        errors ();
+        printf ("cannot compile rgx %s. aborting", rgx [r]);
+        exit (-1);
+      }
+      rgx_dfa_threads (NTHREADS);
+      for (int k = 0; k < NREPEAT; ++k) {
+        if ( rgx_compile (rgx [r], &p) < 0 ) {
+          errors ();
+          printf ("cannot compile rgx %s. aborting", rgx [r]);
+          exit (-1);
+        }
+        differ += p->size != one->size || memcmp (p, one, one->size);
+        free (p);
+      }
+      printf ("\n %s rgx %-36.36s : %4u states, %s",
+        pos ? "positions" : "nfa      ", rgx [r], one->nstates,
+        differ ? "(wrong)" : "same program");
+      if (differ)
+        printf (" %d of %d differ", differ, NREPEAT);
+      free (one);
+    }
+  }
+  printf ("\n");
+  rgx_dfa_threads (1);
+  rgx_dfa_positions (0);
+
+  /* free all memory blocks created */
+  rgx_free();
+}
@@ -0,0 +1,72 @@
+/*
+.. test case for a large dfa, whose tables doesn't fit in PAGE_SIZE.
+.. The minimal dfa of (a|b)*a(a|b){16} has 2^17 (+ EOF/EOB) states.
+.. Matches using the compressed tables are compared with the expected
+.. match, i.e the longest prefix whose 17th character from the last
+.. is 'a'.
+.. $ make obj/large-dfa.tst
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "regex.h"
+
+#define K 16
+
+/* longest match using the compressed tables. Refer tokenize.c */
+static int table_match ( int ** t, const char * txt ) {
+  int * check = t[0], * next = t[1], * base = t[2], * accept = t[3],
+    * def = t[4], * class = t[6], s = 1, c, end = 0;
+  for (int i=0; txt[i]; ++i) {
+    c = class [(unsigned char) txt[i]];
+    while ( s && check [base [s] + c] != s )
+      s = def [s];
+    if ( !s || !(s = next [base [s] + c]) )
+      break;
+    if ( accept [s] )
+      end = i + 1;
+  }
+  return end;
+}
+
+static int expected ( const char * txt ) {
+  int end = 0, n = strlen (txt);
+  for (int i=K; i<n; ++i)
+    if (txt [i-K] == 'a')
+      end = i + 1;
+  return end;
+}
+
+int main () {
+  char * rgx[] = { "(a|b)*a(a|b){16}" };
+  char txt [128];
+
+  DState * dfa = NULL;
+  if ( rgx_lexer_dfa (rgx, 1, &dfa) < 0 ) {
+    errors ();
+    printf ("cannot make DFA. aborting");
+    exit (-1);
+  }
+
+  int ** tables, * len;
+  if ( dfa_tables (&tables, &len) < 0 ) {
+    errors ();
+    printf ("cannot make tables. aborting");
+    exit (-1);
+  }
+  printf ("\n states > 64k : %s", len[2] > (1<<16) ? "yes" : "no");
+
+  srand (1);
+  for (int i=0; i<32; ++i) {
+    int n = 1 + rand () % (sizeof (txt) - 1);
+    for (int j=0; j<n; ++j)
+      txt [j] = rand () % 2 ? 'a' : 'b';
+    txt [n] = '\0';
+    int m = table_match (tables, txt), e = expected (txt);
+    printf ("\n %-3d chars : match %3d %s", n, m, m == e ? "" : "(wrong)");
+  }
+
+  /* free all memory blocks created */
+  rgx_free();
+}
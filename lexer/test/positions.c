@@ -0,0 +1,50 @@
+/*
+.. test case for dfa created directly from the positions (followpos)
+.. of the regex. Matches should be the same as that of the dfa created
+.. from the Thompson NFA.
+.. $ make obj/positions.tst
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "regex.h"
+
+int main () {
+  char * rgxlist[] = {
+    "aa|b", "a(a|b)", "bc*", "bc+", "(a|b)+0", "(a|b)*abb",
+    "a{2,4}b", "(ab|c){3}", "[0-9]{1,3}(\\.[0-9]{1,3}){1,}",
+    "l(mn){0,5}", "(ab*|c+d?){2,3}x", "[^a-c0-9]+", "(r+)+s?"
+  };
+  const char txt[] =
+    "aaccbqaabbaba01bcccdaaaabcabcabababbx12.4.567lmnmnrrrrsabbcx";
+  char buff[80];
+
+  for (int i=0; i< sizeof (rgxlist) / sizeof (rgxlist[0]); ++i) {
+
+    char * rgx = rgxlist[i];
+
+    DState * dfa = NULL, * pdfa = NULL;
+    rgx_dfa_positions (0);
+    int status = rgx_dfa ( rgx, &dfa );
+    rgx_dfa_positions (1);
+    status = status < 0 ? status : rgx_dfa ( rgx, &pdfa );
+    if (status < 0) { printf ("\n_Error %s", rgx); errors (); break; }
+
+    printf ("\n Looking for rgx pattern Regex %s", rgx);
+    const char * source = txt;
+    do {
+      int m = rgx_dfa_match (pdfa, source);
+      if (m != rgx_dfa_match (dfa, source))
+        printf ("\nRegex %s: mismatch at \"%s\"", rgx, source);
+      if (m > 0) {
+        m -= 1; buff[m] = '\0';
+        if(m) memcpy (buff, source, m);
+        printf ("\nRegex %s: found in txt \"%s\"", rgx, buff);
+      }
+    } while (*++source);
+  }
+
+  /* free all memory blocks created */
+  rgx_free();
+}
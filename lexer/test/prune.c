@@ -0,0 +1,84 @@
+/*
+.. test case for the pruning of the doomed (i.e cannot reach an
+.. accepting state) and the unreachable states. The anchors '^' and '$'
+.. in the middle of a pattern create such states. Longest match (and
+.. token) using the tables with and without pruning are compared. The
+.. EOL anchor is checked at '\n' and at the end of the text.
+.. $ make obj/prune.tst
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "regex.h"
+#include "text.h"
+
+/* longest match, starting from the BOL root. Refer tokenize.c */
+static int table_match ( int ** t, int * len, const char * txt,
+  int * token )
+{
+  int s = 2, end = 0, eol = len [5] - 3;
+  *token = 0;
+  for (int i=0; ; ++i) {
+    if ( t[3][s] && (!*token || i > end) ) {
+      end = i;
+      *token = t[3][s];
+    }
+    if ( txt [i] == '\n' || !txt [i] ) {
+      int e = table_delta (t, len, 1, s, eol, NULL);
+      if ( e && t[3][e] && (i > end || t[3][e] < *token) ) {
+        end = i;
+        *token = t[3][e];
+      }
+    }
+    if ( !txt [i] ||
+      !(s = table_delta (t, len, 1, s, t[6][(unsigned char) txt [i]],
+        NULL)) )
+      break;
+  }
+  return end;
+}
+
+int main () {
+  char * rgx[] = {
+    "q($|x)r", "u(^|v)w", "ab($|c)", "[a-z]+[0-9]", "[a-z]+",
+    "[ \\t\\n]+"
+  };
+  const char chars [] = "qxruvwabc09 \n";
+  char txt [64][16];
+  int match [64][2], nrgx = sizeof (rgx) / sizeof (rgx[0]);
+
+  srand (1);
+  for (int i=0; i<64; ++i)
+    random_text (txt [i], 1 + rand () % (sizeof (txt[0]) - 1), chars);
+
+  for (int on = 0; on < 2; ++on) {
+    rgx_dfa_prune (on);
+    DState * dfa = NULL;
+    int ** tables, * len;
+    if ( rgx_lexer_dfa (rgx, nrgx, &dfa) < 0 ||
+      dfa_tables (&tables, &len) < 0 ) {
+      errors ();
+      printf ("cannot make tables. aborting");
+      exit (-1);
+    }
+
+    int same = 1;
+    for (int i=0; i<64; ++i) {
+      int token, m = table_match (tables, len, txt [i], &token);
+      if (!on) {
+        match [i][0] = m; match [i][1] = token;
+      }
+      else if (m != match [i][0] || token != match [i][1]) {
+        printf ("\n mismatch for \"%s\"", txt [i]);
+        same = 0;
+      }
+    }
+    printf ("\n prune %d : states %d, table size %d%s\n", on, len [3],
+      len [0], on ? (same ? ", matches same as prune 0" : " (wrong)")
+      : "");
+  }
+
+  /* free all memory blocks created */
+  rgx_free();
+}
@@ -9,7 +9,7 @@ int main () {
   char * rgx[] = { 
     "a{1,2}", "w{3}", "l(mn){0,5}", 
     "[50]{4,5}", "bc((a|b)c?[0-9]{2}){,5}[wW]",
-    "a{1,}"
+    "a{1,}", "[0-9a]{2,300}"
   };
 
   int rpn [RGXSIZE];
@@ -0,0 +1,113 @@
+/*
+.. test case for the bit-parallel simulation of the positions of a
+.. small regex (refer positions_bits ()), which rgx_match () uses for
+.. the regex of at most 64 positions. Matches are compared with those
+.. of the dfa program (rgx_match_bits (0)) and of the nfa. The time
+.. of the first call (compile) and the throughput (MB/s) of each are
+.. reported.
+.. $ make obj/rgx-bits.tst
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "regex.h"
+#include "nfa.h"
+#include "text.h"
+
+#define NTXT   256
+#define NBYTES (1 << 22)
+
+static double ms ( clock_t c0, clock_t c1 ) {
+  return 1e3 * (c1 - c0) / CLOCKS_PER_SEC;
+}
+
+int main () {
+  /* the last two : just below and above the 64 positions */
+  char * rgx[] = {
+    "^ab+", "x*", "a?b?c?", "(ab|a)(bc|c)*", "[^ab\\n]+", "a{2,4}b",
+    "(a|b)*a(a|b){6}", ".*c$", "((a|b)(c|0))+", "(a|bc)*(0|9)+e?",
+    "(ab|c){1,20}", "(ab|c){1,21}"
+  };
+  const char chars [] = "abc0x9e._+ A\n";
+  char txt [NTXT][24];
+  int nrgx = sizeof (rgx) / sizeof (rgx[0]), same = 1;
+
+  srand (1);
+  for (int i=0; i<NTXT; ++i)
+    random_text (txt [i], rand () % sizeof (txt[0]), chars);
+
+  for (int r = 0; r < nrgx; ++r) {
+    State * nfa = NULL;
+    char * p = rgx [r];
+    nfa_reset (&p, 1);
+    if ( rgx_nfa (p, &nfa, 1) < 0 ) {
+      errors ();
+      printf ("cannot compile rgx %s. aborting", rgx [r]);
+      exit (-1);
+    }
+    for (int i=0; i<NTXT; ++i) {
+      int m = rgx_nfa_match (nfa, txt [i]), m2;
+      rgx_match_bits (1);
+      int m1 = rgx_match (rgx [r], txt [i]);
+      rgx_cache_free ();
+      rgx_match_bits (0);
+      m2 = rgx_match (rgx [r], txt [i]);
+      rgx_cache_free ();
+      if ( m1 != m || m2 != m ) {
+        printf ("\n mismatch : rgx %s, txt \"%s\" : nfa %d, bits %d, "
+          "dfa %d", rgx [r], txt [i], m, m1, m2);
+        same = 0;
+      }
+    }
+  }
+  printf ("\n %d regex : bits %s", nrgx,
+    same ? "same as nfa and dfa" : "(wrong)");
+
+  /* a regex, whose dfa has 2^13 states */
+  char * big = "(a|b)*a(a|b){12}";
+  for (int on = 1; on >= 0; --on) {
+    rgx_match_bits (on);
+    clock_t c0 = clock ();
+    int m = rgx_match (big, "ababbbababbabba");
+    clock_t c1 = clock ();
+    printf ("\n first call of %s, %s : %8.2f ms (match %d)", big,
+      on ? "bits" : "dfa ", ms (c0, c1), m);
+    rgx_cache_free ();
+  }
+
+  /* throughput over a long match */
+  char * text = malloc (NBYTES + 1), * id = "[a-z_][a-z0-9_]*";
+  for (int i=0; i<NBYTES; ++i)
+    text [i] = "abcdefghij_0123"[rand () % 15];
+  text [NBYTES] = '\0';
+  State * nfa = NULL;
+  char * p = id;
+  nfa_reset (&p, 1);
+  rgx_nfa (p, &nfa, 1);
+  clock_t c0 = clock ();
+  int m0 = rgx_nfa_match (nfa, text);
+  clock_t c1 = clock ();
+  rgx_match_bits (1);
+  int m1 = rgx_match (id, text);
+  clock_t c2 = clock ();
+  rgx_cache_free ();
+  rgx_match_bits (0);
+  rgx_match (id, "x");
+  clock_t c3 = clock ();
+  int m2 = rgx_match (id, text);
+  clock_t c4 = clock ();
+  printf ("\n %s over %d bytes : %s"
+    "\n   nfa  %8.1f MB/s"
+    "\n   bits %8.1f MB/s"
+    "\n   dfa  %8.1f MB/s\n", id, NBYTES,
+    m0 == m1 && m1 == m2 ? "same matches" : "(wrong)",
+    NBYTES / 1e3 / (ms (c0, c1) + 1e-6),
+    NBYTES / 1e3 / (ms (c1, c2) + 1e-6),
+    NBYTES / 1e3 / (ms (c3, c4) + 1e-6));
+
+  free (text);
+  /* free all memory blocks created */
+  rgx_free();
+}
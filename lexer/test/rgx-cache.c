@@ -0,0 +1,79 @@
+/*
+.. test case for the cache of the programs of rgx_match (). Matches
+.. of a few regex are compared with those of the nfa (rgx_nfa_match ()),
+.. the time of a first (compiled) and of a repeated (cached) call is
+.. reported, and the memory used stays bounded while matching more
+.. regex than RGXCACHE.
+.. $ make obj/rgx-cache.tst
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "regex.h"
+#include "nfa.h"
+#include "allocator.h"
+
+#define NCALLS 100000
+
+int main () {
+  char * rgx[] = {
+    "[a-zA-Z_][a-zA-Z0-9_]*", "(aa|b)|(a(a|b))|(bc*)|((a|b)+0)",
+    "[0-9]+(\\.[0-9]*)?([eE][-+]?[0-9]+)?", "^ab+", "x*"
+  };
+  char * txt[] = {
+    "abc_12 x", "aab0", "3.14e+2;", "abbbc", "12.5", "xxa", "", "bccc"
+  };
+  int nrgx = sizeof (rgx) / sizeof (rgx[0]),
+    ntxt = sizeof (txt) / sizeof (txt[0]), same = 1;
+
+  for (int r = 0; r < nrgx; ++r)
+    for (int i = 0; i < ntxt; ++i) {
+      State * nfa = NULL;
+      char * p = rgx [r];
+      nfa_reset (&p, 1);
+      if ( rgx_nfa (p, &nfa, 1) < 0 ) {
+        errors ();
+        printf ("cannot compile rgx %s. aborting", rgx [r]);
+        exit (-1);
+      }
+      int m = rgx_nfa_match (nfa, txt [i]);
+      if ( rgx_match (rgx [r], txt [i]) != m ) {
+        printf ("\n mismatch : rgx %s, txt \"%s\"", rgx [r], txt [i]);
+        same = 0;
+      }
+    }
+  printf ("\n rgx_match %s", same ? "same as rgx_nfa_match" : "(wrong)");
+
+  /* first call compiles, the others use the cache */
+  char id [32] = "[0-9]+[a-z]*";
+  clock_t c0 = clock ();
+  long sum = rgx_match (id, "123abc");
+  clock_t c1 = clock ();
+  for (int i = 1; i < NCALLS; ++i)
+    sum += rgx_match (id, "123abc");
+  clock_t c2 = clock ();
+  printf ("\n first call %8.2f us, cached call %8.3f us (sum %ld)",
+    1e6 * (c1 - c0) / CLOCKS_PER_SEC,
+    1e6 * (c2 - c1) / CLOCKS_PER_SEC / (NCALLS - 1), sum);
+
+  /* distinct regex, 8 x RGXCACHE of them */
+  size_t before = allocated (), most = before;
+  for (int i = 0; i < 8 * RGXCACHE; ++i) {
+    char r [48];
+    snprintf (r, sizeof (r), "(ab|cd)*%d[a-f]+", i);
+    if ( rgx_match (r, "abcd12ff") < 0 ) {
+      errors ();
+      exit (-1);
+    }
+    size_t n = allocated ();
+    if (n > most) most = n;
+  }
+  printf ("\n %d distinct regex : pool %zu bytes before, at most %zu "
+    "bytes after%s\n", 8 * RGXCACHE, before, most,
+    most <= before ? "" : " (grows)");
+
+  /* free all memory blocks created */
+  rgx_free();
+}
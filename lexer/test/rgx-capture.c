@@ -0,0 +1,147 @@
+/*
+.. test case for the groups of a regex (rgx_capture_compile () and
+.. rgx_capture_match ()). The groups of a few regex are compared with
+.. the expected ones. Then the fields of log lines are extracted by
+.. one pass of the tagged dfa, and compared with those found by
+.. running the program of each field (rgx_exec ()) one after the
+.. other. The throughput (MB/s) of both is reported.
+.. $ make obj/rgx-capture.tst
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "regex.h"
+
+#define NLINES (1 << 16)
+#define NFIELD 7
+
+int main () {
+  struct { char * rgx, * txt, * expect; } cases [] = {
+    { "([a-z]+)=([0-9]+)",  "key=123;", "0-7 0-3 4-7" },
+    { "(a|ab)(c|bcd)(d*)",  "abcd",     "0-4 0-1 1-4 4-4" },
+    { "(ab|a)(bc)?",        "abc",      "0-3 0-1 1-3" },
+    { "(a*)(a*)",           "aaa",      "0-3 0-3 3-3" },
+    { "(a|b)*",             "abab",     "0-4 3-4" },
+    { "((a)|b)+",           "ab",       "0-2 1-2 0-1" },
+    { "(x)?y",              "y",        "0-1 -" },
+    { "(a)|b",              "b",        "0-1 -" },
+    { "(((a)b)c)",          "abcd",     "0-3 0-3 0-2 0-1" },
+    { "([0-9]{2,3})([0-9]*)", "12345",  "0-5 0-3 3-5" },
+    { "([0-9]+)(\\.[0-9]*)?", "3.14x",  "0-4 0-1 1-4" },
+    { "(ab){2}",            "ababab",   "0-4 2-4" },
+    { "^(a)[^b]*",          "accb",     "0-3 0-1" },
+    { "(a)(b)",             "ac",       "no match" }
+  };
+  int ncases = sizeof (cases) / sizeof (cases [0]), good = 0;
+  for (int i=0; i<ncases; ++i) {
+    RgxCapture * cap = NULL;
+    if (rgx_capture_compile (cases [i].rgx, &cap) < 0) {
+      errors ();
+      printf ("cannot compile rgx %s. aborting", cases [i].rgx);
+      exit (-1);
+    }
+    long sub [2 * (RGXGROUPS + 1)];
+    char got [128] = "no match";
+    int m = rgx_capture_match (cap, cases [i].txt,
+      strlen (cases [i].txt), sub);
+    for (int k=0, n=0; m && k <= cap->ngroups; ++k)
+      n += sub [2*k] < 0 ?
+        snprintf (got + n, sizeof (got) - n, k ? " -" : "-") :
+        snprintf (got + n, sizeof (got) - n, "%s%ld-%ld", k ? " " : "",
+          sub [2*k], sub [2*k + 1]);
+    good += !strcmp (got, cases [i].expect);
+    printf ("\n rgx %-22s %-8s : %2u states, %s%s", cases [i].rgx,
+      cases [i].txt, cap->nstates, got,
+      strcmp (got, cases [i].expect) ? " (wrong)" : "");
+    free (cap);
+  }
+  printf ("\n %d of %d as expected\n", good, ncases);
+
+  /* fields of log lines : one pass, or a program per field */
+  char * field [NFIELD] = {
+    "[0-9]{4}", "[0-9]{2}", "[0-9]{2}", "[0-9:]+", "[A-Z]+", "[a-z]+",
+    "[^\\n]*"
+  };
+  const char * sep [NFIELD] = { "-", "-", " ", " ", " ", ": ", "\n" },
+    * seprgx [NFIELD] = { "-", "-", "[ ]", "[ ]", "[ ]", ":[ ]", "" };
+  const char * level [] = { "INFO", "WARN", "ERROR", "DEBUG" },
+    * unit [] = { "net", "disk", "scheduler", "auth" };
+  char rgx [256] = "";
+  for (int f=0; f<NFIELD; ++f)
+    snprintf (rgx + strlen (rgx), sizeof (rgx) - strlen (rgx),
+      "(%s)%s", field [f], seprgx [f]);
+
+  RgxCapture * cap = NULL;
+  RgxProg * prog [NFIELD];
+  if (rgx_capture_compile (rgx, &cap) < 0) {
+    errors ();
+    printf ("cannot compile rgx %s. aborting", rgx);
+    exit (-1);
+  }
+  for (int f=0; f<NFIELD; ++f)
+    if (rgx_compile (field [f], &prog [f]) < 0) {
+      errors ();
+      printf ("cannot compile rgx %s. aborting", field [f]);
+      exit (-1);
+    }
+
+  size_t size = (size_t) NLINES * 96, n = 0, * line = malloc ((NLINES + 1)
+    * sizeof (size_t));
+  char * txt = malloc (size);
+  srand (1);
+  for (int i=0; i<NLINES; ++i) {
+    line [i] = n;
+    n += snprintf (txt + n, size - n, "20%02d-%02d-%02d %02d:%02d:%02d %s "
+      "%s: request %d took %d ms\n", rand () % 30, 1 + rand () % 12,
+      1 + rand () % 28, rand () % 24, rand () % 60, rand () % 60,
+      level [rand () % 4], unit [rand () % 4], rand (), rand () % 1000);
+  }
+  line [NLINES] = n;
+
+  long sum [2] = {0, 0}, sub [2 * (NFIELD + 1)];
+  clock_t c0 = clock ();
+  for (int i=0; i<NLINES; ++i) {
+    size_t len = line [i+1] - line [i];
+    if (rgx_capture_match (cap, txt + line [i], len, sub) <= 0)
+      continue;
+    for (int k=2; k < 2 * (NFIELD + 1); ++k)
+      sum [0] = 31 * sum [0] + sub [k];
+  }
+  clock_t c1 = clock ();
+  for (int i=0; i<NLINES; ++i) {
+    size_t len = line [i+1] - line [i], at = 0, l;
+    const char * s = txt + line [i];
+    long fsub [2 * NFIELD], f;
+    for (f=0; f<NFIELD; ++f) {
+      if ( !(l = rgx_exec (prog [f], s + at, len - at)) )
+        break;
+      fsub [2*f] = at;
+      fsub [2*f + 1] = at += l - 1;
+      if ( f < NFIELD - 1 && (at + strlen (sep [f]) > len ||
+        memcmp (s + at, sep [f], strlen (sep [f]))) )
+        break;
+      at += f < NFIELD - 1 ? strlen (sep [f]) : 0;
+    }
+    for (int k=0; f == NFIELD && k < 2 * NFIELD; ++k)
+      sum [1] = 31 * sum [1] + fsub [k];
+  }
+  clock_t c2 = clock ();
+
+  printf ("\n log lines : %u states, %u registers, %s"
+    "\n   one pass (groups)   %8.1f MB/s"
+    "\n   rgx_exec per field  %8.1f MB/s\n",
+    cap->nstates, cap->nregs,
+    sum [0] == sum [1] ? "same fields" : "(wrong)",
+    n / 1e6 / ((double) (c1 - c0) / CLOCKS_PER_SEC + 1e-9),
+    n / 1e6 / ((double) (c2 - c1) / CLOCKS_PER_SEC + 1e-9));
+
+  free (cap);
+  for (int f=0; f<NFIELD; ++f)
+    free (prog [f]);
+  free (txt);
+  free (line);
+  /* free all memory blocks created */
+  rgx_free();
+}
@@ -0,0 +1,73 @@
+/*
+.. test case for the flat program of a regex (rgx_compile () and
+.. rgx_exec ()). Matches at each offset of a text are compared with
+.. rgx_dfa_match (), which follows the DState pointers. Throughput of
+.. both (MB/s) is reported. rgx_exec () also runs over NUL bytes.
+.. $ make obj/rgx-exec.tst
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "regex.h"
+#include "text.h"
+
+#define NBYTES (1 << 20)
+
+int main () {
+  char * rgx[] = {
+    "[a-zA-Z_][a-zA-Z0-9_]*", "(aa|b)|(a(a|b))|(bc*)|((a|b)+0)",
+    "[0-9]+(\\.[0-9]*)?([eE][-+]?[0-9]+)?", "\"[^\"\\n]*\"",
+    "(auto|break|case|char|const|continue|do|double|else|for|if|int|"
+    "long|return|while)[ (;]"
+  };
+  const char chars [] = "ab0c_x9.e+\"A \nfortuneslvdhwi(;";
+  char * txt = malloc (NBYTES + 1);
+  srand (1);
+  random_text (txt, NBYTES, chars);
+
+  for (int r = 0; r < sizeof (rgx) / sizeof (rgx[0]); ++r) {
+    DState * dfa = NULL;
+    RgxProg * prog = NULL;
+    if ( rgx_dfa (rgx [r], &dfa) < 0 || rgx_compile (rgx [r], &prog) < 0 ) {
+      errors ();
+      printf ("cannot compile rgx %s. aborting", rgx [r]);
+      exit (-1);
+    }
+
+    /* longest match at each offset, by both */
+    long sum [2] = {0, 0};
+    clock_t c0 = clock ();
+    for (int i=0; i<NBYTES; ++i)
+      sum [0] += rgx_dfa_match (dfa, txt + i);
+    clock_t c1 = clock ();
+    for (int i=0; i<NBYTES; ++i)
+      sum [1] += rgx_exec (prog, txt + i, NBYTES - i);
+    clock_t c2 = clock ();
+
+    printf ("\n rgx %-40.40s : %4u states, %4u bytes, %s"
+      "\n   DState walk %8.1f MB/s"
+      "\n   rgx_exec    %8.1f MB/s",
+      rgx [r], prog->nstates, prog->size,
+      sum [0] == sum [1] ? "same matches" : "(wrong)",
+      NBYTES / 1e6 / ((double) (c1 - c0) / CLOCKS_PER_SEC + 1e-9),
+      NBYTES / 1e6 / ((double) (c2 - c1) / CLOCKS_PER_SEC + 1e-9));
+    free (prog);
+  }
+
+  /* binary data : a NUL byte in the middle of the match */
+  RgxProg * prog = NULL;
+  const char bin [] = { 'a', '\0', 'b', 'c' };
+  if (rgx_compile ("a[^x]b", &prog) < 0) {
+    errors ();
+    exit (-1);
+  }
+  printf ("\n binary : rgx_exec (\"a[^x]b\", \"a\\0bc\") = %d\n",
+    rgx_exec (prog, bin, sizeof (bin)));
+  free (prog);
+
+  free (txt);
+  /* free all memory blocks created */
+  rgx_free();
+}
@@ -0,0 +1,167 @@
+/*
+.. test case for the lazy dfa (rgx_lazy_compile (), rgx_lazy_match ()).
+.. Matches are compared with those of the nfa, with a large budget and
+.. with small ones (which flush the states often). The small budget
+.. holds 4 or 5 states, fewer than the dfa of most of the regex. The
+.. throughput (MB/s) is reported for a regex, whose full dfa has 2^21
+.. states (the states are flushed too often, and the nfa is
+.. simulated), and for a typical one (against the flat dfa program of
+.. rgx_exec ()).
+.. $ make obj/rgx-lazy.tst
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "regex.h"
+#include "nfa.h"
+#include "text.h"
+
+#define NTXT   256
+#define NSMALL 896                      /* bytes : 4 or 5 states */
+#define NBYTES (1 << 22)
+#define NRUNS  (1 << 18)
+#define NBIG   (1 << 19)
+
+static double mbs ( size_t n, clock_t c0, clock_t c1 ) {
+  return n / 1e6 / ((double) (c1 - c0) / CLOCKS_PER_SEC + 1e-9);
+}
+
+int main () {
+  char * rgx[] = {
+    "(a|b)*a(a|b){2}", "(a|b)*a(a|b){4}", "(a|b)*a(a|b){6}",
+    "[ab]*(aab|bba)[ab]*c", "^(ab+|ba+)+c", "(ab|ba|a)*(bb|c)",
+    "a(b|a)*(ab|ba)(b|0)", "[0-9]+(\\.[0-9]*)?([eE][-+]?[0-9]+)?",
+    "(a|b)*a.*c$", "x*"
+  };
+  const char chars [] = "aabbabc0e.+9\n";
+  char txt [NTXT][64];
+  int nrgx = sizeof (rgx) / sizeof (rgx[0]), same = 1, nflush = 0,
+    nflushed = 0, ns;
+
+  srand (1);
+  for (int i=0; i<NTXT; ++i)
+    random_text (txt [i], rand () % sizeof (txt[0]), chars);
+
+  for (int r = 0; r < nrgx; ++r) {
+    RgxLazy * lazy [2] = { NULL, NULL };
+    State * nfa = NULL;
+    char * p = rgx [r];
+    if ( rgx_lazy_compile (rgx [r], 0, &lazy [0]) < 0 ||
+      rgx_lazy_compile (rgx [r], NSMALL, &lazy [1]) < 0 ||
+      (nfa_reset (&p, 1), rgx_nfa (p, &nfa, 1)) < 0 ) {
+      errors ();
+      printf ("cannot compile rgx %s. aborting", rgx [r]);
+      exit (-1);
+    }
+    for (int i=0; i<NTXT; ++i) {
+      int m = rgx_nfa_match (nfa, txt [i]), n = strlen (txt [i]);
+      for (int k=0; k<2; ++k)
+        if ( rgx_lazy_match (lazy [k], txt [i], n) != m ) {
+          printf ("\n mismatch : rgx %s, txt \"%s\", budget %d", rgx [r],
+            txt [i], k);
+          same = 0;
+        }
+    }
+    int f;
+    rgx_lazy_stats (lazy [1], &ns, &f);
+    nflush += f;
+    nflushed += f > 0;
+    rgx_lazy_free (lazy [0]);
+    rgx_lazy_free (lazy [1]);
+  }
+  printf ("\n %d regex : lazy dfa %s (%d flushes of the %d bytes budget,"
+    " for %d regex)", nrgx, same ? "same as nfa" : "(wrong)", nflush,
+    NSMALL, nflushed);
+
+  /*
+  .. 128 states, more than a small budget holds. Runs of a letter
+  .. stay in a few states, so the states are used before a flush.
+  */
+  char * text = malloc (NBYTES + 1), * mid = "(a|b)*a(a|b){6}";
+  for (int i=0; i<NRUNS; ) {
+    char c = "ab"[rand () % 2];
+    for (int n = 1 + rand () % 32; n-- && i<NRUNS; )
+      text [i++] = c;
+  }
+  text [NRUNS] = '\0';
+  State * nfa = NULL;
+  char * p = mid;
+  nfa_reset (&p, 1);
+  rgx_nfa (p, &nfa, 1);
+  int m0 = rgx_nfa_match (nfa, text);
+  RgxLazy * lazy;
+  for (size_t budget = 1 << 10; budget <= 1 << 13; budget <<= 1) {
+    if ( rgx_lazy_compile (mid, budget, &lazy) < 0 ) {
+      errors ();
+      exit (-1);
+    }
+    int m = rgx_lazy_match (lazy, text, NRUNS);
+    rgx_lazy_stats (lazy, &ns, &nflush);
+    printf ("\n %s, runs, budget %5zu : %s (%d flushes)", mid, budget,
+      m == m0 ? "same as nfa" : "(wrong)", nflush);
+    rgx_lazy_free (lazy);
+  }
+
+  /* random a/b : the lazy dfa meets a new state at most bytes */
+  char * big = "(a|b)*a(a|b){20}";
+  for (int i=0; i<NBIG; ++i)
+    text [i] = "ab"[rand () % 2];
+  if ( rgx_lazy_compile (big, 1 << 18, &lazy) < 0 ) {
+    errors ();
+    exit (-1);
+  }
+  clock_t c0 = clock ();
+  int m = rgx_lazy_match (lazy, text, NBIG);
+  clock_t c1 = clock ();
+  m = m == rgx_lazy_match (lazy, text, NBIG);
+  clock_t c2 = clock ();
+  rgx_lazy_stats (lazy, &ns, &nflush);
+  rgx_lazy_free (lazy);
+
+  /* the nfa, over a part of the text (no NUL in it) */
+  char c = text [NBIG / 8];
+  p = big;
+  nfa_reset (&p, 1);
+  rgx_nfa (p, &nfa, 1);
+  text [NBIG / 8] = '\0';
+  clock_t c3 = clock ();
+  rgx_nfa_match (nfa, text);
+  clock_t c4 = clock ();
+  text [NBIG / 8] = c;
+  printf ("\n %s, budget 256 kB : %s"
+    "\n   lazy, first run  %8.1f MB/s"
+    "\n   lazy, second run %8.1f MB/s (%d states, %d flushes)"
+    "\n   nfa              %8.1f MB/s", big,
+    m ? "same matches" : "(wrong)", mbs (NBIG, c0, c1),
+    mbs (NBIG, c1, c2), ns, nflush, mbs (NBIG / 8, c3, c4));
+
+  /* a typical regex, where all the states fit */
+  char * id = "[a-z_][a-z0-9_]*";
+  for (int i=0; i<NBYTES; ++i)
+    text [i] = "abcdefghij_0123"[rand () % 15];
+  text [0] = '_';
+  RgxProg * prog;
+  if ( rgx_lazy_compile (id, 0, &lazy) < 0 ||
+    rgx_compile (id, &prog) < 0 ) {
+    errors ();
+    exit (-1);
+  }
+  rgx_lazy_match (lazy, text, 64);
+  c0 = clock ();
+  m = rgx_lazy_match (lazy, text, NBYTES);
+  c1 = clock ();
+  m = m == rgx_exec (prog, text, NBYTES);
+  c2 = clock ();
+  printf ("\n %s : %s"
+    "\n   lazy dfa %8.1f MB/s"
+    "\n   rgx_exec %8.1f MB/s\n", id, m ? "same matches" : "(wrong)",
+    mbs (NBYTES, c0, c1), mbs (NBYTES, c1, c2));
+  rgx_lazy_free (lazy);
+  free (prog);
+
+  free (text);
+  /* free all memory blocks created */
+  rgx_free();
+}
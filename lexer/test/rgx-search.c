@@ -0,0 +1,136 @@
+/*
+.. test case for the unanchored search rgx_search (). All the matches
+.. (leftmost longest, one after the other) in a text are compared with
+.. those found by trying rgx_exec () at each offset. Throughput of both
+.. (MB/s) is reported. A '^' matches only at the start of the buffer.
+.. $ make obj/rgx-search.tst
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "regex.h"
+#include "text.h"
+
+#define NBYTES (1 << 20)
+
+/* leftmost longest match by trying each offset */
+static int naive ( const RgxProg * p, const char * buf, size_t len,
+  size_t * start, size_t * end )
+{
+  for (size_t i=0; i<=len; ++i) {
+    int m = rgx_exec (p, buf + i, len - i);
+    if (m) {
+      *start = i;
+      *end = i + m - 1;
+      return 1;
+    }
+  }
+  return 0;
+}
+
+/* all the matches in txt. returns a checksum and sets the count */
+static long matches ( int search, const RgxProg * p, const char * txt,
+  size_t len, long * count )
+{
+  size_t i = 0, s, e;
+  long sum = 0;
+  *count = 0;
+  while ( i <= len && (search ? rgx_search (p, txt + i, len - i, &s, &e) :
+    naive (p, txt + i, len - i, &s, &e)) == 1 ) {
+    sum = 31 * sum + 7 * (i + s) + (e - s);
+    ++*count;
+    i += e > s ? e : s + 1;
+  }
+  return sum;
+}
+
+int main () {
+  char * rgx[] = {
+    "foo[0-9]+", "ab|bcde", "[a-z]+ing", "x(ab)*y", "b*", "\"[^\"]*\"",
+    "zq"
+  };
+  const char chars [] = "abcdefgoinx09 y\"\n";
+  char * txt = malloc (NBYTES + 1);
+  srand (1);
+  random_text (txt, NBYTES, chars);
+
+  for (int r = 0; r < sizeof (rgx) / sizeof (rgx[0]); ++r) {
+    RgxProg * prog = NULL;
+    if ( rgx_compile (rgx [r], &prog) < 0 ) {
+      errors ();
+      printf ("cannot compile rgx %s. aborting", rgx [r]);
+      exit (-1);
+    }
+
+    long sum [2], count [2];
+    clock_t c0 = clock ();
+    sum [0] = matches (0, prog, txt, NBYTES, &count [0]);
+    clock_t c1 = clock ();
+    sum [1] = matches (1, prog, txt, NBYTES, &count [1]);
+    clock_t c2 = clock ();
+
+    printf ("\n rgx %-12.12s : %7ld matches, lead %3d, %u required, %s"
+      "\n   each offset %8.1f MB/s"
+      "\n   rgx_search  %8.1f MB/s",
+      rgx [r], count [1], prog->lead, prog->nreq,
+      sum [0] == sum [1] && count [0] == count [1] ? "same matches" :
+      "(wrong)",
+      NBYTES / 1e6 / ((double) (c1 - c0) / CLOCKS_PER_SEC + 1e-9),
+      NBYTES / 1e6 / ((double) (c2 - c1) / CLOCKS_PER_SEC + 1e-9));
+    free (prog);
+  }
+
+  /*
+  .. worst case of trying each offset : no match, and the runs from
+  .. all the offsets go up to the end (no required or lead byte).
+  */
+  RgxProg * prog = NULL;
+  if (rgx_compile ("[a-z]+[0-9]", &prog) < 0) {
+    errors ();
+    exit (-1);
+  }
+  memset (txt, 'a', 1 << 14);
+  long count [2];
+  clock_t c0 = clock ();
+  matches (0, prog, txt, 1 << 14, &count [0]);
+  clock_t c1 = clock ();
+  matches (1, prog, txt, 1 << 14, &count [1]);
+  clock_t c2 = clock ();
+  printf ("\n rgx [a-z]+[0-9] on 16 KB of 'a' : %ld, %ld matches"
+    "\n   each offset %8.2f MB/s"
+    "\n   rgx_search  %8.2f MB/s",
+    count [0], count [1],
+    (1 << 14) / 1e6 / ((double) (c1 - c0) / CLOCKS_PER_SEC + 1e-9),
+    (1 << 14) / 1e6 / ((double) (c2 - c1) / CLOCKS_PER_SEC + 1e-9));
+  free (prog);
+
+  /* leftmost longest : "ab" of "abcde" and not "bcde" */
+  size_t s = 0, e = 0;
+  if (rgx_compile ("ab|bcde", &prog) < 0) {
+    errors ();
+    exit (-1);
+  }
+  int found = rgx_search (prog, "xabcde", 6, &s, &e);
+  printf ("\n rgx_search (\"ab|bcde\", \"xabcde\") = %d, [%zu, %zu)",
+    found, s, e);
+  free (prog);
+
+  /* '^' only at buf [0] : "ab" of "abab", and "b" of "xab" */
+  if (rgx_compile ("^ab|b", &prog) < 0) {
+    errors ();
+    exit (-1);
+  }
+  for (int i=0; i<2; ++i) {
+    const char * t = i ? "xab" : "abab";
+    found = rgx_search (prog, t, strlen (t), &s, &e);
+    printf ("\n rgx_search (\"^ab|b\", \"%s\") = %d, [%zu, %zu)%s", t,
+      found, s, e, i ? "\n" : "");
+  }
+  free (prog);
+
+  free (txt);
+  /* free all memory blocks created */
+  rgx_free();
+}
@@ -0,0 +1,91 @@
+/*
+.. test case for the set of patterns (rgx_set_compile () and
+.. rgx_set_match ()). For each input, the patterns found by one pass
+.. of the set are compared with those found by rgx_exec () of each
+.. pattern. The time of both is reported.
+.. $ make obj/rgx-set.tst
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "regex.h"
+
+#define NPATTERNS 1000
+#define NINPUTS   2000
+
+int main () {
+  const char * tails [] = {
+    "", "[0-9]+", "(x|y)z", "a*b", "[^ ]*", "q?r", "(st)+", "[a-d]{2}"
+  };
+  const char chars [] = "abcdefgh0123xyzqrst ";
+  static char buf [NPATTERNS][32], txt [NINPUTS][24];
+  char * rgx [NPATTERNS];
+
+  srand (1);
+  for (int i=0; i<NPATTERNS; ++i) {
+    char head [4] = {0};
+    for (int j=0; j<3; ++j)
+      head [j] = "abcdefgh" [rand () % 8];
+    snprintf (buf [i], sizeof (buf [i]), "%s%s", head,
+      tails [rand () % (sizeof (tails) / sizeof (tails [0]))]);
+    rgx [i] = buf [i];
+  }
+  for (int i=0; i<NINPUTS; ++i) {
+    int n = 1 + rand () % (sizeof (txt [0]) - 1);
+    for (int j=0; j<n; ++j)
+      txt [i][j] = chars [rand () % (sizeof (chars) - 1)];
+    txt [i][n] = '\0';
+  }
+
+  RgxSet * set = NULL;
+  if ( rgx_set_compile (rgx, NPATTERNS, &set) < 0 ) {
+    errors ();
+    printf ("cannot compile the set. aborting");
+    exit (-1);
+  }
+  RgxProg ** prog = malloc (NPATTERNS * sizeof (RgxProg *));
+  for (int i=0; i<NPATTERNS; ++i)
+    if ( rgx_compile (rgx [i], &prog [i]) < 0 ) {
+      errors ();
+      printf ("cannot compile rgx %s. aborting", rgx [i]);
+      exit (-1);
+    }
+
+  uint64_t ids [(NPATTERNS + 63) / 64];
+  long sum [2] = {0, 0}, same = 1;
+  clock_t c0 = clock ();
+  for (int i=0; i<NINPUTS; ++i) {
+    sum [0] += rgx_set_match (set, txt [i], strlen (txt [i]), ids);
+    for (int k=0; k<NPATTERNS; ++k)
+      if ( ((ids [k >> 6] >> (k & 63)) & 1) !=
+        (rgx_exec (prog [k], txt [i], strlen (txt [i])) > 0) )
+        same = 0;
+  }
+  clock_t c1 = clock ();
+  for (int i=0; i<NINPUTS; ++i)
+    rgx_set_match (set, txt [i], strlen (txt [i]), ids);
+  clock_t c2 = clock ();
+  for (int i=0; i<NINPUTS; ++i)
+    for (int k=0; k<NPATTERNS; ++k)
+      sum [1] += rgx_exec (prog [k], txt [i], strlen (txt [i])) > 0;
+  clock_t c3 = clock ();
+  (void) c0;
+
+  printf ("\n %d patterns : %u dfa states, %u accept sets, %u bytes"
+    "\n %ld matches in %d inputs, %s"
+    "\n   one set      %8.2f ms"
+    "\n   per pattern  %8.2f ms\n",
+    NPATTERNS, ((RgxProg *) ((char *) set + set->prog))->nstates,
+    set->nsets, set->size, sum [0], NINPUTS,
+    same && sum [0] == sum [1] ? "same patterns as rgx_exec" : "(wrong)",
+    1e3 * (c2 - c1) / CLOCKS_PER_SEC, 1e3 * (c3 - c2) / CLOCKS_PER_SEC);
+
+  for (int i=0; i<NPATTERNS; ++i)
+    free (prog [i]);
+  free (prog);
+  free (set);
+  /* free all memory blocks created */
+  rgx_free();
+}
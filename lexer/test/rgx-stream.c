@@ -0,0 +1,106 @@
+/*
+.. test case for the match over chunked input (rgx_stream_init (),
+.. rgx_stream_feed () and rgx_stream_match ()). The match at offsets of
+.. a text, fed in chunks of random size, is compared with rgx_exec ()
+.. over the whole text. Then a match longer than the pipe buffer is
+.. read () from a pipe, and fed as it comes.
+.. $ make obj/rgx-stream.tst
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#include "regex.h"
+#include "text.h"
+
+#define NBYTES (1 << 16)
+#define NLONG  (1 << 18)
+
+static int pipefd [2];
+
+/* "<" NLONG digits ">" and some more, written in small pieces */
+static void * writer ( void * arg ) {
+  char buf [1000];
+  memset (buf, '7', sizeof (buf));
+  write (pipefd [1], "<", 1);
+  for (int n = 0; n < NLONG; n += sizeof (buf))
+    write (pipefd [1], buf, NLONG - n < sizeof (buf) ? NLONG - n :
+      sizeof (buf));
+  write (pipefd [1], "> tail", 6);
+  close (pipefd [1]);
+  return arg;
+}
+
+int main () {
+  /* matches (words, strings, lines ..) over many chunks */
+  char * rgx[] = {
+    "[a-z]+(\\ [a-z]+)*", "\"[^\"]*\"", "[^\\n]*\\n", "(ab|a)*c*",
+    "[0-9]+(\\.[0-9]*)?([eE][-+]?[0-9]+)?"
+  };
+  const char chars [] = "abcdefghxyz abcdxyz 0.9e+1\"\n";
+  char * txt = malloc (NBYTES + 1);
+  srand (1);
+  random_text (txt, NBYTES, chars);
+
+  for (int r = 0; r < sizeof (rgx) / sizeof (rgx[0]); ++r) {
+    RgxProg * prog = NULL;
+    if ( rgx_compile (rgx [r], &prog) < 0 ) {
+      errors ();
+      printf ("cannot compile rgx %s. aborting", rgx [r]);
+      exit (-1);
+    }
+    int same = 1;
+    size_t fed = 0;
+    for (int i=0; i<NBYTES; i += 7) {
+      RgxStream st;
+      size_t at = i;
+      rgx_stream_init (&st, prog);
+      while (at < NBYTES) {
+        size_t n = 1 + rand () % 8;
+        if (n > NBYTES - at) n = NBYTES - at;
+        at += n;
+        if ( !rgx_stream_feed (&st, txt + at - n, n) )
+          break;
+      }
+      fed += at - i;
+      same &= rgx_stream_match (&st) == rgx_exec (prog, txt + i,
+        NBYTES - i);
+    }
+    printf ("\n rgx %-40.40s : %s, %.1f bytes fed per match", rgx [r],
+      same ? "same matches" : "(wrong)", fed / (NBYTES / 7.0));
+    free (prog);
+  }
+
+  /* a match over many read () */
+  RgxProg * prog = NULL;
+  pthread_t tid;
+  if ( rgx_compile ("<[0-9]*>", &prog) < 0 || pipe (pipefd) ) {
+    errors ();
+    exit (-1);
+  }
+  pthread_create (&tid, NULL, writer, NULL);
+  RgxStream st;
+  char buf [4096];
+  ssize_t n;
+  int nread = 0;
+  rgx_stream_init (&st, prog);
+  while ( (n = read (pipefd [0], buf, sizeof (buf))) > 0 ) {
+    nread++;
+    if ( !rgx_stream_feed (&st, buf, n) )
+      break;
+  }
+  while ( n > 0 )                      /* drain the rest of the pipe */
+    n = read (pipefd [0], buf, sizeof (buf));
+  pthread_join (tid, NULL);
+  close (pipefd [0]);
+  printf ("\n pipe : match of %ld bytes (expected %d), over more than "
+    "one read () : %s\n", rgx_stream_match (&st) - 1, NLONG + 2,
+    nread > 1 ? "yes" : "no");
+  free (prog);
+
+  free (txt);
+  /* free all memory blocks created */
+  rgx_free();
+}
@@ -0,0 +1,112 @@
+/*
+.. test case for the thread safety of the compiled objects. A RgxProg
+.. and a RgxSet are shared by NTHREADS threads, each of which also
+.. compiles its own regex (rgx_compile (), rgx_lazy_compile ()) and
+.. calls rgx_match () with new regex, at the same time. The results
+.. of each thread are compared with those of a single thread.
+.. $ make obj/rgx-threads.tst
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <time.h>
+
+#include "regex.h"
+#include "text.h"
+
+#define NTHREADS 8
+#define NTXT     512
+#define NROUNDS  20
+
+static char * rgx[] = {
+  "[a-f]+[0-9]*", "(ab|cd)*e?", "[0-9]+(\\.[0-9]+)?", "\"[^\"\\n]*\"",
+  "x*[._+]", "(a|b)*a(a|b){3}", "f(e|d)+[ax]", "[^ \\n]+"
+};
+#define NRGX ((int) (sizeof (rgx) / sizeof (rgx[0])))
+
+static char txt [NTXT][24];
+static RgxProg * prog;
+static RgxSet  * set;
+
+/* a checksum of all the results of the thread "id" (or of none) */
+static long run ( int id ) {
+  long sum = 0;
+  char own [64];
+  snprintf (own, sizeof (own), "(ab|cd)*%d[a-f]+", id);
+  char * mine [2] = { rgx [id % NRGX], own };
+  RgxProg * p [2];
+  RgxLazy * lazy;
+  if ( rgx_compile (mine [0], &p [0]) < 0 ||
+    rgx_compile (mine [1], &p [1]) < 0 ||
+    rgx_lazy_compile (mine [0], 1 << 12, &lazy) < 0 )
+    return -1;
+
+  for (int r = 0; r < NROUNDS; ++r)
+    for (int i = 0; i < NTXT; ++i) {
+      size_t n = strlen (txt [i]), b, e;
+      uint64_t ids [1];
+      sum = 31 * sum + rgx_exec (prog, txt [i], n);
+      sum = 31 * sum + (rgx_search (prog, txt [i], n, &b, &e) ? b + e : 0);
+      sum = 31 * sum + rgx_set_match (set, txt [i], n, ids) + ids [0];
+      sum = 31 * sum + rgx_exec (p [0], txt [i], n);
+      sum = 31 * sum + rgx_exec (p [1], txt [i], n);
+      sum = 31 * sum + rgx_lazy_match (lazy, txt [i], n);
+      sum = 31 * sum + rgx_match (rgx [(i + r) % NRGX], txt [i]);
+      if (i % 64 == 0) {
+        char r2 [64];     /* new regex : a compile, with the others */
+        snprintf (r2, sizeof (r2), "[a-f]+%d(x|y)*", (id * NROUNDS + r)
+          * 8 + i / 64);
+        sum = 31 * sum + rgx_match (r2, txt [i]);
+      }
+    }
+  free (p [0]); free (p [1]);
+  rgx_lazy_free (lazy);
+  return sum;
+}
+
+static void * worker ( void * arg ) {
+  long * sum = arg;
+  *sum = run ((int) sum [1]);
+  return NULL;
+}
+
+int main () {
+  const char chars [] = "abcdef0189x._+\" \n";
+  srand (1);
+  for (int i=0; i<NTXT; ++i)
+    random_text (txt [i], rand () % sizeof (txt[0]), chars);
+  if ( rgx_compile (rgx [0], &prog) < 0 ||
+    rgx_set_compile (rgx, NRGX, &set) < 0 ) {
+    errors ();
+    printf ("cannot compile. aborting");
+    exit (-1);
+  }
+
+  long expect [NTHREADS], sums [NTHREADS][2];
+  for (int t=0; t<NTHREADS; ++t)
+    expect [t] = run (t);
+
+  pthread_t th [NTHREADS];
+  struct timespec t0, t1;
+  clock_gettime (CLOCK_MONOTONIC, &t0);
+  for (int t=0; t<NTHREADS; ++t) {
+    sums [t][1] = t;
+    pthread_create (&th [t], NULL, worker, sums [t]);
+  }
+  int same = 1;
+  for (int t=0; t<NTHREADS; ++t) {
+    pthread_join (th [t], NULL);
+    same &= sums [t][0] == expect [t] && expect [t] != -1;
+  }
+  clock_gettime (CLOCK_MONOTONIC, &t1);
+  printf ("\n %d threads : %s, %.1f ms\n", NTHREADS,
+    same ? "same results as one thread" : "(wrong)",
+    (t1.tv_sec - t0.tv_sec) * 1e3 + (t1.tv_nsec - t0.tv_nsec) / 1e6);
+  errors ();
+
+  free (prog);
+  free (set);
+  /* free all memory blocks created */
+  rgx_free();
+}
@@ -0,0 +1,126 @@
+/*
+.. test case for the two byte stride tables (refer dfa_pairs ()). The
+.. input is split into the longest tokens, once with the one byte loop
+.. and once with the two byte loop of tokenize.c. Both should find the
+.. same tokens. The throughput (MB/s) of both loops is reported.
+.. $ make obj/stride.tst
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "regex.h"
+
+#define NBYTES (1 << 24)
+#define STACK  128
+
+static int ** t, * len, * pclass, * pidx, * pair, np;
+static int states [STACK];
+
+/* Refer tokenize.c */
+static inline int delta ( int s, int c ) {
+  int d = 0, m = c;
+  while ( s && t[0][t[2][s] + m] != s ) {
+    s = (d++ == 1) ? 0 : t[4][s];
+    if ( s >= len [3] ) m = t[5][c];
+  }
+  return s ? t[1][t[2][s] + m] : 0;
+}
+
+/*
+.. longest token starting at "txt" (a class string terminated by the
+.. class "eob"). Returns the length and sets the token in "token".
+*/
+static inline int scan ( const unsigned char * txt, int stride,
+  int * token )
+{
+  const unsigned char * p = txt;
+  int s = 1, idx = STACK, p1, k;
+  do {
+    if ( stride == 2 && pidx [s] && idx > 1 &&
+      (p1 = pclass [p [0]]) ) {
+      k = 2 * ((pidx [s] - 1) * np * np + p1 * np + pclass [p [1]]);
+      if ( pair [k + 1] ) {
+        states [--idx] = s;
+        states [--idx] = pair [k];
+        s = pair [k + 1];
+        p += 2;
+        continue;
+      }
+    }
+    states [--idx] = s;
+    s = delta (s, *p++);
+  } while ( s && idx );
+
+  /* last accepting state in the stack */
+  for (int l = (int) (p - txt) - 1; idx < STACK; --l)
+    if ( (*token = t[3][states [idx++]]) )
+      return l;
+  *token = 0;
+  return 1;
+}
+
+static long tokenize ( const unsigned char * txt, int n, int stride ) {
+  long sum = 0;
+  int token;
+  for (int i = 0; i < n; ) {
+    int l = scan (txt + i, stride, &token);
+    sum = 31 * sum + 7 * l + token;
+    i += l;
+  }
+  return sum;
+}
+
+int main () {
+  char * rgx[] = {
+    "int", "if", "else", "while", "for", "return", "char", "void",
+    "struct", "switch", "[a-zA-Z_][a-zA-Z0-9_]*", "[0-9]+",
+    "0[xX][0-9a-fA-F]+", "[ \\t\\n]+", "[-+*/=<>!]=?", "\"[^\"\\n]*\""
+  };
+  const char * words [] = {
+    "identifier_of_some_length", "x", "while", "123456789", "0xdeadbeef",
+    "\"a string body with spaces\"", " ", "\n", "+=", "for", "i_2", "==",
+    "lxr_state_stack_size", "struct", "  \t"
+  };
+  int nrgx = sizeof (rgx) / sizeof (rgx[0]),
+    nwords = sizeof (words) / sizeof (words[0]);
+  unsigned char * txt = malloc (NBYTES + 2);
+
+  DState * dfa = NULL;
+  if ( rgx_lexer_dfa (rgx, nrgx, &dfa) < 0 ||
+    dfa_tables (&t, &len) < 0 ) {
+    errors ();
+    printf ("cannot make tables. aborting");
+    exit (-1);
+  }
+  int npair = dfa_pairs (t, len, 1, &pclass, &pidx, &pair, &np);
+  printf ("\n %d states with two byte stride, %d pair classes",
+    npair, np);
+
+  srand (1);
+  int n = 0;
+  while (n < NBYTES) {
+    const char * w = words [rand () % nwords];
+    for (; *w && n < NBYTES; ++w)
+      txt [n++] = t[6][(unsigned char) *w];
+  }
+  txt [n] = txt [n+1] = len [5] - 4;          /* EOB class (sentinel) */
+
+  long sum [2];
+  clock_t c0 = clock ();
+  sum [0] = tokenize (txt, n, 1);
+  clock_t c1 = clock ();
+  sum [1] = tokenize (txt, n, 2);
+  clock_t c2 = clock ();
+  printf ("\n %s"
+    "\n one byte %8.1f MB/s"
+    "\n two byte %8.1f MB/s",
+    sum [0] == sum [1] ? "same tokens" : "(wrong)",
+    n / 1e6 / ((double) (c1 - c0) / CLOCKS_PER_SEC + 1e-9),
+    n / 1e6 / ((double) (c2 - c1) / CLOCKS_PER_SEC + 1e-9));
+
+  free (txt);
+  /* free all memory blocks created */
+  rgx_free();
+}
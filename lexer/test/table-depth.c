@@ -0,0 +1,86 @@
+/*
+.. test case for the def[] chain depth of the compressed tables. For
+.. depth > 1, templates (indexed by meta class) are also created.
+.. Longest match (and token) using the tables of each depth, and of the
+.. optimized compression (depth 1), is compared with that of depth 0
+.. (no fallback).
+.. $ make obj/table-depth.tst
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "regex.h"
+#include "text.h"
+
+/* longest match using the compressed tables. Refer tokenize.c */
+static int table_match ( int ** t, int * len, int depth,
+  const char * txt, int * token )
+{
+  int * check = t[0], * next = t[1], * base = t[2], * accept = t[3],
+    * def = t[4], * meta = t[5], * class = t[6], s = 1, c, m, end = 0;
+  *token = 0;
+  for (int i=0; txt[i]; ++i) {
+    int d = 0;
+    m = c = class [(unsigned char) txt[i]];
+    while ( s && check [base [s] + m] != s ) {
+      s = (d++ == depth) ? 0 : def [s];
+      if ( s >= len [3] )                            /* a template */
+        m = meta [c];
+    }
+    if ( !s || !(s = next [base [s] + m]) )
+      break;
+    if ( accept [s] ) {
+      end = i + 1;
+      *token = accept [s];
+    }
+  }
+  return end;
+}
+
+int main () {
+  char * rgx[] = {
+    "int", "if", "else", "while", "for", "return", "char", "void",
+    "struct", "switch", "[a-zA-Z_][a-zA-Z0-9_]*", "[0-9]+",
+    "0[xX][0-9a-fA-F]+", "[ \\t\\n]+", "[-+*/=<>!]=?", "\"[^\"\\n]*\""
+  };
+  const char chars [] = "intfelswhruc_vdx0A9 =<\"";
+  char txt [32][24];
+  int match [32][2], nrgx = sizeof (rgx) / sizeof (rgx[0]);
+
+  srand (1);
+  for (int i=0; i<32; ++i)
+    random_text (txt [i], 1 + rand () % (sizeof (txt[0]) - 1), chars);
+
+  for (int run = 0; run < 6; ++run) {
+    int depth = run < 5 ? run : 1;
+    rgx_table_depth (depth);
+    rgx_table_optimize (run < 5 ? 0 : 2);
+    DState * dfa = NULL;
+    int ** tables, * len;
+    if ( rgx_lexer_dfa (rgx, nrgx, &dfa) < 0 ||
+      dfa_tables (&tables, &len) < 0 ) {
+      errors ();
+      printf ("cannot make tables. aborting");
+      exit (-1);
+    }
+
+    int same = 1;
+    for (int i=0; i<32; ++i) {
+      int token, m = table_match (tables, len, depth, txt [i], &token);
+      if (!run) {
+        match [i][0] = m; match [i][1] = token;
+      }
+      else if (m != match [i][0] || token != match [i][1]) {
+        printf ("\n depth %d : mismatch for \"%s\"", depth, txt [i]);
+        same = 0;
+      }
+    }
+    printf ("\n depth %d%s : table size %4d, templates %d, %s", depth,
+      run < 5 ? "" : " (optimized)", len [0], len [2] - len [3],
+      same ? "matches same as depth 0" : "(wrong)");
+  }
+
+  /* free all memory blocks created */
+  rgx_free();
+}
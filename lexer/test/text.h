@@ -0,0 +1,21 @@
+#ifndef _TEXT_H_
+#define _TEXT_H_
+
+  #include <stdlib.h>
+  #include <string.h>
+
+  /*
+  .. Random text of the tests : "n" bytes drawn from "chars" (by
+  .. rand (), seeded by the test), at txt [0, n), followed by a '\0'.
+  .. So "txt" should have n + 1 bytes.
+  */
+  static inline void random_text ( char * txt, size_t n,
+    const char * chars )
+  {
+    size_t nc = strlen (chars);
+    for (size_t i=0; i<n; ++i)
+      txt [i] = chars [rand () % nc];
+    txt [n] = '\0';
+  }
+
+#endif